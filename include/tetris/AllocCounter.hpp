@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tetris {
+
+// Debug counter hooked into the global operator new. Only active in programs
+// linking tetris_alloc_counter; otherwise the count stays at 0.
+bool allocationCounterEnabled();
+// Number of heap allocations since program start.
+std::uint64_t allocationCount();
+
+} // namespace tetris
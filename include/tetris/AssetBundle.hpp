@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tetris {
+
+// Read-only archive of all asset files, memory-mapped in one open. Layout
+// (all integers little endian):
+//
+//   "TPAK" version:u32 count:u32
+//   count x { nameLength:u16 name offset:u64 size:u64 }
+//   file data, each entry starting on a 16 byte boundary
+//
+// Entries are sorted by name. Lookups return views into the mapping, so
+// the bundle must outlive anything that keeps pointing at its data (an
+// sf::Font opened from memory, for example).
+class AssetBundle {
+public:
+    static constexpr std::uint32_t Version = 1;
+
+    struct View {
+        const std::uint8_t *data = nullptr;
+        std::size_t size = 0;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    AssetBundle() = default;
+    ~AssetBundle();
+    AssetBundle(const AssetBundle&) = delete;
+    AssetBundle& operator=(const AssetBundle&) = delete;
+
+    // Map a bundle file; false if it is missing or malformed.
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    // Entry by file name, e.g. "clear.wav"; an empty view if absent.
+    View find(const std::string &name) const;
+    std::size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        std::string name;
+        View view;
+    };
+    bool parse();
+
+    const std::uint8_t *m_data = nullptr;
+    std::size_t m_size = 0;
+    std::vector<Entry> m_entries;
+#ifdef _WIN32
+    void *m_file = nullptr;
+    void *m_mapping = nullptr;
+#endif
+};
+
+// Pack every regular file directly inside directory into one bundle.
+// Returns the number of files written, or -1 on error.
+int writeAssetBundle(const std::string &directory, const std::string &path);
+
+} // namespace tetris
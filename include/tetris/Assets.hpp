@@ -0,0 +1,38 @@
+#pragma once
+
+#include "AssetBundle.hpp"
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <memory>
+#include <string>
+
+namespace tetris {
+
+// Sound effects of the frontend, one optional WAV file each.
+enum class Sfx { Clear, Rotate, Drop, HardDrop, UiClick, VoiceLevelUp, Count };
+constexpr int SfxCount = static_cast<int>(Sfx::Count);
+
+// File name of an effect inside the assets directory.
+const char* sfxFileName(Sfx sfx);
+
+// Everything the frontend reads from disk. Missing files leave their slot
+// empty; the game runs without text or silently in that case.
+struct GameAssets {
+    // The font reads its data from the mapping, so the bundle must stay
+    // alive as long as the font; it is declared first to be destroyed last.
+    std::unique_ptr<AssetBundle> bundle;
+    std::unique_ptr<sf::Font> font;
+    std::array<std::unique_ptr<sf::SoundBuffer>, SfxCount> sounds;
+    int fromBundle = 0;       // assets found in the bundle
+    int fromFiles = 0;        // assets loaded from loose files
+    double loadSeconds = 0.0; // wall time spent loading
+};
+
+// Load the font and all sound effects, preferring entries of the bundle at
+// bundlePath and falling back to files in directory. Touches no window or
+// GL state, so it can run on a background thread while the first frames
+// are drawn.
+GameAssets loadGameAssets(const std::string &bundlePath = "assets.pak", const std::string &directory = "assets");
+
+} // namespace tetris
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tetris {
+
+// Delayed auto shift (DAS) and auto repeat rate (ARR) in microseconds.
+struct RepeatTiming {
+    std::uint32_t delay = 167000;   // held time before repeating starts
+    std::uint32_t interval = 33000; // time between repeats, 0 = instant
+};
+
+// Turns the held state of one key into repeat pulses on the fixed logic
+// clock. The press itself is not counted; the caller acts on it directly.
+class AutoRepeat {
+public:
+    // Pulses reported per step when the interval is 0 ("move to the wall").
+    static constexpr int Instant = 64;
+
+    explicit AutoRepeat(RepeatTiming timing = {}) : m_timing(timing) {}
+    void setTiming(RepeatTiming timing) { m_timing = timing; }
+    void press();
+    void release();
+    bool held() const { return m_held; }
+    // Advance by one logic step and return the number of repeats due in it.
+    int advance(std::uint32_t micros);
+
+private:
+    RepeatTiming m_timing;
+    bool m_held = false;
+    bool m_repeating = false;
+    std::uint32_t m_timer = 0;
+};
+
+} // namespace tetris
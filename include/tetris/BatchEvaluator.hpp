@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Board.hpp"
+#include <array>
+#include <cstdint>
+
+namespace tetris {
+
+// Instruction sets the batch evaluator can run on. Auto picks the best one
+// that is compiled in and supported by the CPU.
+enum class SimdLevel : std::uint8_t { Scalar, SSE2, AVX2, Auto };
+
+const char* simdLevelName(SimdLevel level);
+// Best level this build and this CPU support.
+SimdLevel bestSimdLevel();
+bool simdLevelSupported(SimdLevel level);
+
+// Board heuristics computed per board. Heights count from the floor.
+enum Feature : int {
+    AggregateHeight, // sum of column heights
+    MaxHeight,       // height of the tallest column
+    Holes,           // empty cells below a filled cell in the same column
+    Bumpiness,       // sum of height differences of neighboring columns
+    RowTransitions,  // filled/empty changes along each row, walls count as filled
+    WellDepth,       // empty cells above the stack between filled cells or the wall
+    CompleteLines,   // rows cleared by the placement that led to the board
+    FeatureCount
+};
+
+const char* featureName(int feature);
+
+// Linear weights over the features. The defaults are the autoplay bot's
+// (BotWeights), which leaves max height, transitions and wells unused.
+struct EvalWeights {
+    std::array<float, FeatureCount> w = {-0.510066f, 0.0f, -0.35663f, -0.184483f, 0.0f, 0.0f, 0.760666f};
+};
+
+// Up to Capacity standard boards stored as structure of arrays: row y of
+// every board is contiguous, so one SSE2 instruction works on 8 boards and
+// one AVX2 instruction on 16.
+class BoardBatch {
+public:
+    static constexpr int Capacity = 256;
+    static_assert(sizeof(Board::Row) == sizeof(std::uint16_t), "the kernels work on 16-bit row words");
+
+    void clear() { m_count = 0; }
+    // Append a board and the lines cleared by the placement that made it;
+    // false when the batch is full.
+    bool add(const Board &board, int lines) {
+        if (m_count == Capacity) return false;
+        for (int y = 0; y < BoardHeight; ++y) m_rows[y][m_count] = board.row(y);
+        m_lines[m_count++] = static_cast<std::int16_t>(lines);
+        return true;
+    }
+    int size() const { return m_count; }
+    bool full() const { return m_count == Capacity; }
+    const std::uint16_t* rows(int y) const { return m_rows[y].data(); }
+    const std::int16_t* lines() const { return m_lines.data(); }
+
+private:
+    // Zeroed so the padding lanes of a partial batch hold valid boards
+    alignas(32) std::array<std::array<std::uint16_t, Capacity>, BoardHeight> m_rows{};
+    alignas(32) std::array<std::int16_t, Capacity> m_lines{};
+    int m_count = 0;
+};
+
+// Features and scores of the boards of one batch, also structure of arrays.
+// Entries past count are scratch.
+struct BatchResult {
+    alignas(32) std::array<std::array<std::int16_t, BoardBatch::Capacity>, FeatureCount> features;
+    alignas(32) std::array<float, BoardBatch::Capacity> scores;
+    int count = 0;
+
+    int feature(int board, int f) const { return features[f][board]; }
+    float score(int board) const { return scores[board]; }
+};
+
+// Evaluates a whole batch per call. Every level gives bit-identical
+// features and scores: features are integer counts, and scores sum the
+// weighted features in the same order without fused multiply-adds.
+class BatchEvaluator {
+public:
+    explicit BatchEvaluator(const EvalWeights &weights = {}, SimdLevel level = SimdLevel::Auto);
+    void evaluate(const BoardBatch &batch, BatchResult &out) const;
+    // The level in use: the requested one, or the best supported below it.
+    SimdLevel level() const { return m_level; }
+    const EvalWeights& weights() const { return m_weights; }
+
+private:
+    EvalWeights m_weights;
+    SimdLevel m_level;
+};
+
+} // namespace tetris
@@ -1,28 +1,175 @@
 #pragma once
 
 #include "Types.hpp"
+#include "Tetromino.hpp"
 #include <array>
-#include <optional>
-#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 namespace tetris {
 
 struct Cell { int color = -1; };
 
-class Board {
+// Board sizes compiled into tetris_core. Board and Engine code exists only
+// for these, each instantiated with its own row word type and unrolled
+// loops; add a size here to support a new variant.
+#define TETRIS_BOARD_SIZES(X) \
+    X(4, 20)   /* sprint */   \
+    X(10, 20)  /* standard */ \
+    X(10, 40)  /* tall */     \
+    X(16, 20)  /* wide */     \
+    X(32, 20)                 \
+    X(64, 20)
+
+namespace detail {
+
+constexpr std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Smallest unsigned type with at least Bits bits.
+template <int Bits>
+using UIntFor = std::conditional_t<(Bits <= 8), std::uint8_t,
+                std::conditional_t<(Bits <= 16), std::uint16_t,
+                std::conditional_t<(Bits <= 32), std::uint32_t, std::uint64_t>>>;
+
+template <int W, int H>
+constexpr std::array<std::array<std::uint64_t, W>, H> buildZobristCells() {
+    std::array<std::array<std::uint64_t, W>, H> keys{};
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            keys[y][x] = splitmix64(static_cast<std::uint64_t>(y * W + x));
+    return keys;
+}
+
+template <typename F, int... I>
+constexpr void unrollImpl(F &f, std::integer_sequence<int, I...>) {
+    (f(std::integral_constant<int, I>{}), ...);
+}
+
+// Call f(std::integral_constant<int, i>) for i = 0..N-1 with no loop left.
+template <int N, typename F>
+constexpr void unroll(F &&f) {
+    unrollImpl(f, std::make_integer_sequence<int, N>{});
+}
+
+} // namespace detail
+
+// Zobrist key of each board cell; a board hash is the XOR over occupied cells.
+template <int W, int H>
+inline constexpr auto zobristCells = detail::buildZobristCells<W, H>();
+inline constexpr const auto &ZobristCells = zobristCells<BoardWidth, BoardHeight>;
+
+// Fixed-capacity list of row indices, so line clears never touch the heap.
+template <int H>
+struct BasicLineList {
+    std::array<int, H> rows{};
+    int count = 0;
+
+    void push_back(int y) { rows[count++] = y; }
+    void clear() { count = 0; }
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+    int operator[](int i) const { return rows[i]; }
+    const int* begin() const { return rows.data(); }
+    const int* end() const { return rows.data() + count; }
+};
+using LineList = BasicLineList<BoardHeight>;
+
+template <int W, int H>
+class BasicBoard {
 public:
-    Board();
+    static_assert(W >= 4 && W <= 64, "rows are stored in at most 64 bits");
+    static_assert(H >= 4 && H <= 64, "removeLines keeps a 64-bit row mask");
+    static constexpr int Width = W;
+    static constexpr int Height = H;
+
+    // One occupancy word per row, bit x set when column x is filled. The
+    // word is the narrowest that fits: 8 bits for sprint boards, 64 for the
+    // widest practice boards.
+    using Row = detail::UIntFor<W>;
+    using Lines = BasicLineList<H>;
+    static constexpr Row FullRow = [] {
+        Row full = 0;
+        for (int x = 0; x < W; ++x) full = static_cast<Row>(full | (Row{1} << x));
+        return full;
+    }();
+
+    BasicBoard();
     bool isInside(const Point &p) const;
     bool isOccupied(const Point &p) const;
     bool isValidPosition(const std::array<Point,4> &blocks, const Point &pos) const;
+    // Same test using the precomputed row masks of a shape table entry.
+    bool isValidPosition(const ShapeInfo &shape, const Point &pos) const;
     void place(const std::array<Point,4> &blocks, const Point &pos, int color);
-    // Find indices of full lines (0..BoardHeight-1). Does not remove them.
-    std::vector<int> getFullLines() const;
-    // Remove the given lines and shift above rows down.
-    void removeLines(const std::vector<int>& lines);
+    // Set a single cell; color -1 empties it.
+    void setCell(int x, int y, int color);
+    // Find indices of full lines (0..H-1). Does not remove them.
+    Lines getFullLines() const;
+    // Full lines among rows first..last only, e.g. the rows a piece just
+    // filled; a row can only become full where something was placed.
+    Lines getFullLines(int first, int last) const;
+    // Remove the given lines and shift above rows down, in place.
+    void removeLines(const Lines& lines);
+    // Push count rows up from the floor, each full except for column hole.
+    // Returns false when filled cells were pushed out over the top.
+    bool addGarbage(int count, int hole, int color);
     const Cell& at(int x, int y) const;
+    Row row(int y) const { return rows[y]; }
+    // Filled cells from the floor up to the topmost filled cell of column x
+    // (holes included); 0 for an empty column.
+    int columnHeight(int x) const { return heights[x]; }
+    // Number of filled cells in row y.
+    int rowFill(int y) const { return fill[y]; }
+    // How many rows a piece at a valid position can fall before it rests:
+    // the gap to each column's top, O(piece width). Pieces tucked under an
+    // overhang fall back to testing one row at a time.
+    int dropDistance(const ShapeInfo &shape, const Point &pos) const;
+    // Zobrist hash of the occupancy (colors are ignored), kept up to date
+    // by place, setCell, removeLines and addGarbage.
+    std::uint64_t hash() const { return zobrist; }
+    // XOR of the cell keys of row y for the given bits.
+    static std::uint64_t rowHash(int y, Row bits);
 private:
-    std::array<std::array<Cell, BoardWidth>, BoardHeight> grid;
+    // Recompute every column height from the rows.
+    void updateHeights();
+
+    std::array<Row, H> rows;
+    std::uint64_t zobrist = 0;
+    // Summaries kept up to date by place, setCell, removeLines and addGarbage
+    std::array<std::uint8_t, W> heights;
+    std::array<std::uint8_t, H> fill;
+    // Color plane, only read by the renderer.
+    std::array<std::array<Cell, W>, H> grid;
 };
 
+// The standard 10x20 board used by the game, bot and replays.
+using Board = BasicBoard<BoardWidth, BoardHeight>;
+
+#define TETRIS_EXTERN_BOARD(W, H) extern template class BasicBoard<W, H>;
+TETRIS_BOARD_SIZES(TETRIS_EXTERN_BOARD)
+#undef TETRIS_EXTERN_BOARD
+
+// Tag carrying compile-time board dimensions through the runtime bridge.
+template <int W, int H>
+struct BoardSize {
+    static constexpr int width = W;
+    static constexpr int height = H;
+};
+
+// Runtime bridge: call f(BoardSize<W, H>{}) for the compiled size matching
+// width x height, so code chosen at runtime still runs the specialized
+// board. Returns false for sizes that are not in TETRIS_BOARD_SIZES.
+template <typename F>
+bool withBoardSize(int width, int height, F &&f) {
+#define TETRIS_BOARD_SIZE_CASE(W, H) if (width == W && height == H) { f(BoardSize<W, H>{}); return true; }
+    TETRIS_BOARD_SIZES(TETRIS_BOARD_SIZE_CASE)
+#undef TETRIS_BOARD_SIZE_CASE
+    return false;
+}
+
 } // namespace tetris
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Engine.hpp"
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace tetris {
+
+// Rectangles of the HUD that are batched together with the board.
+enum class HudRect { SliderBack, SliderFill, GameOverShade, ProfilerShade, GarbageMeter, Count };
+
+// Draws the board, active piece, line clear pulse and HUD rectangles from one
+// persistent vertex buffer in a single draw call. Cell geometry is written
+// once; each frame only the vertices of cells whose color changed are touched.
+class BoardRenderer {
+public:
+    BoardRenderer();
+    // Recompute cell colors from the engine state, marking changed cells dirty.
+    // sinceStep is the wall time since the engine's last logic step; timed
+    // animations are advanced by it so they move smoothly between steps.
+    void update(const Engine &engine, float sinceStep = 0.0f);
+    // Place a HUD rectangle; an empty size hides it.
+    void setRect(HudRect rect, const sf::FloatRect &area, sf::Color color);
+    void draw(sf::RenderTarget &target);
+
+    static const std::array<sf::Color, PieceCount> colors;
+
+private:
+    static constexpr int CellCount = BoardWidth * BoardHeight;
+    static constexpr int VerticesPerQuad = 6;
+
+    void writeQuad(int quad, const sf::FloatRect &area);
+    void writeColor(int quad, sf::Color color);
+
+    std::vector<sf::Vertex> m_vertices;
+    std::array<sf::Color, CellCount> m_cellColors;
+    // GPU copy, only used when vertex buffers are supported
+    std::optional<sf::VertexBuffer> m_buffer;
+    std::size_t m_dirtyBegin = 0;
+    std::size_t m_dirtyEnd = 0;
+};
+
+} // namespace tetris
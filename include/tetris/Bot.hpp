@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Board.hpp"
+#include "MoveGen.hpp"
+#include "ThreadPool.hpp"
+#include "TranspositionTable.hpp"
+#include <chrono>
+#include <memory>
+
+namespace tetris {
+
+// Linear weights of the board heuristic used to score placements.
+struct BotWeights {
+    double aggregateHeight = -0.510066;
+    double completeLines = 0.760666;
+    double holes = -0.35663;
+    double bumpiness = -0.184483;
+};
+
+// Autoplay search over placements of the active piece and the preview piece.
+// Each first-ply placement becomes one pool task, so the two-ply search
+// spreads over all workers. The search is anytime: start() scores every
+// first-ply placement on its own before returning, and best() can be asked at
+// any moment for the best move found so far. An optional transposition
+// table caches the best reply value of boards reached more than once.
+class Bot {
+public:
+    explicit Bot(ThreadPool &pool, BotWeights weights = {}, TranspositionTable *table = nullptr);
+    ~Bot();
+
+    // Begin searching a new position. Cancels any search still running.
+    void start(const Board &board, const Tetromino &active, TetrominoType next);
+    // The two-ply choice once every placement is searched, the one-ply choice
+    // before that; false if no search was started or the piece cannot move.
+    bool best(Placement &out) const;
+    // True once every task of the current search has finished.
+    bool done() const;
+    // Wait until the search is done or the deadline passes, then report best().
+    bool think(std::chrono::steady_clock::time_point deadline, Placement &out);
+
+    // Heuristic value of a board after a placement that cleared `lines` rows.
+    static double evaluate(const Board &board, int lines, const BotWeights &weights);
+
+private:
+    struct Search;
+    ThreadPool &m_pool;
+    BotWeights m_weights;
+    TranspositionTable *m_table;
+    std::shared_ptr<Search> m_search;
+};
+
+} // namespace tetris
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Tetromino.hpp"
+#include "Board.hpp"
+#include "PieceGenerator.hpp"
+#include <cstdint>
+
+namespace tetris {
+
+// Player inputs understood by the simulation.
+enum class Action : std::uint8_t { None, Left, Right, SoftDrop, Rotate, HardDrop, Count };
+
+// Bit set of things that happened during one step() or tick() call.
+// Frontends use it to trigger sounds and effects.
+using Events = std::uint32_t;
+namespace events {
+constexpr Events None         = 0;
+constexpr Events Moved        = 1u << 0;
+constexpr Events Rotated      = 1u << 1;
+constexpr Events SoftDropped  = 1u << 2;
+constexpr Events HardDropped  = 1u << 3;
+constexpr Events Locked       = 1u << 4;
+constexpr Events LinesCleared = 1u << 5; // clear animation started
+constexpr Events LinesRemoved = 1u << 6; // animation finished, rows gone
+constexpr Events LevelUp      = 1u << 7;
+constexpr Events Spawned      = 1u << 8;
+constexpr Events GameOver     = 1u << 9;
+} // namespace events
+
+// Where new pieces appear on a board of the given width, in board
+// coordinates of the piece origin.
+constexpr Point spawnPosition(int width) { return Point{width/2 - 2, -1}; }
+constexpr Point SpawnPosition = spawnPosition(BoardWidth);
+
+// Deterministic game rules: spawn, move, rotate, gravity, lock, line clear,
+// scoring and leveling. Has no dependency on SFML or a display; the same
+// seed and the same sequence of step()/tick() calls give the same game.
+// Instantiated for every size in TETRIS_BOARD_SIZES.
+template <int W, int H>
+class BasicEngine {
+public:
+    using Board = BasicBoard<W, H>;
+    using LineList = typename Board::Lines;
+    static constexpr float LineClearDuration = 0.6f; // seconds
+
+    // Complete game state as a fixed-size, trivially copyable value: board,
+    // active and next piece, piece generator, score, timers and line clear
+    // animation. About 1.1 KB for 10x20, most of it the board with its color
+    // plane and column/row summaries (880 bytes); the generator is 88 bytes.
+    struct Snapshot {
+        Board board;
+        Tetromino active;
+        TetrominoType next;
+        PieceGenerator pieces;
+        float dropTimer;
+        double elapsed;
+        float dropInterval;
+        bool running;
+        int score;
+        int level;
+        int totalLines;
+        int piecesPlaced;
+        LineList linesToClear;
+        bool animating;
+        float lineClearTimer;
+    };
+
+    explicit BasicEngine(std::uint32_t seed = 0);
+    explicit BasicEngine(const PieceGenerator &pieces);
+    // Start a fresh game with stream 0 of seed, keeping the randomizer mode.
+    void reset(std::uint32_t seed);
+    // Start a fresh game dealing pieces from the given generator.
+    void reset(const PieceGenerator &pieces);
+    // Apply one player action. Ignored while paused by a line clear or after game over.
+    Events step(Action action);
+    // Advance gravity and the line clear animation by dt seconds.
+    Events tick(float dt);
+    // Versus: push lines of garbage with the gap in column hole under the
+    // stack and lift the falling piece clear of it. Ends the game when the
+    // stack or the piece is pushed out over the top. Does nothing while a
+    // line clear runs, as it would move the rows being cleared.
+    Events addGarbage(int lines, int hole);
+    // Save or restore the whole game; restoring then replaying the same
+    // inputs gives the same game as before.
+    void snapshot(Snapshot &out) const;
+    Snapshot snapshot() const;
+    void restore(const Snapshot &s);
+
+    const Board& board() const { return m_board; }
+    const Tetromino& active() const { return m_active; }
+    // Rows the active piece would fall on a hard drop.
+    int dropDistance() const {
+        return m_board.dropDistance(Tetromino::shape(m_active.type, m_active.rotation), m_active.position);
+    }
+    // The active piece where a hard drop would lock it.
+    Tetromino ghost() const { return Tetromino{m_active.type, m_active.rotation, m_active.position + Point{0, dropDistance()}}; }
+    TetrominoType next() const { return m_next; }
+    // Piece i places after the active one; upcoming(0) == next().
+    TetrominoType upcoming(int i) const { return i == 0 ? m_next : m_pieces.peek(i - 1); }
+    const PieceGenerator& pieces() const { return m_pieces; }
+    bool running() const { return m_running; }
+    int score() const { return m_score; }
+    int level() const { return m_level; }
+    int lines() const { return m_totalLines; }
+    int piecesPlaced() const { return m_piecesPlaced; }
+    float dropInterval() const { return m_dropInterval; }
+    // Simulated seconds passed to tick() since the last reset.
+    double elapsed() const { return m_elapsed; }
+    bool animating() const { return m_animating; }
+    const LineList& linesToClear() const { return m_linesToClear; }
+    // 0..1 progress of the running line clear animation
+    float lineClearProgress() const { return m_lineClearTimer / LineClearDuration; }
+
+    static int scoreForLines(int lines, int level);
+    // Versus: garbage rows sent to an opponent for clearing lines at once.
+    static int garbageForLines(int lines);
+    static float dropIntervalForLevel(int level);
+
+private:
+    Events spawnPiece();
+    Events lockPiece();
+    Events hardDrop();
+    Events finishLineClear();
+    bool tryMove(Point delta);
+
+    Board m_board;
+    Tetromino m_active;
+    TetrominoType m_next;
+    PieceGenerator m_pieces;
+    float m_dropTimer = 0.0f;
+    double m_elapsed = 0.0;
+    float m_dropInterval = 0.6f; // seconds
+    bool m_running = true;
+    int m_score = 0;
+    int m_level = 0;
+    int m_totalLines = 0;
+    int m_piecesPlaced = 0;
+
+    // Line clear animation state
+    LineList m_linesToClear;
+    bool m_animating = false;
+    float m_lineClearTimer = 0.0f;
+};
+
+// The standard 10x20 game.
+using Engine = BasicEngine<BoardWidth, BoardHeight>;
+
+#define TETRIS_EXTERN_ENGINE(W, H) extern template class BasicEngine<W, H>;
+TETRIS_BOARD_SIZES(TETRIS_EXTERN_ENGINE)
+#undef TETRIS_EXTERN_ENGINE
+
+} // namespace tetris
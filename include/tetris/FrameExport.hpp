@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tetris {
+
+// Convert a top-down RGBA frame to one Y4M FRAME record: the "FRAME\n" tag,
+// then BT.601 studio range Y, U and V planes (4:2:0, chroma averaged over
+// each 2x2 block, the last row/column repeated for odd sizes).
+void convertToYuv(const std::uint8_t *rgba, unsigned width, unsigned height, std::vector<std::uint8_t> &out);
+
+// A frame between readback and output.
+struct ExportFrame {
+    std::uint64_t index = 0;
+    std::vector<std::uint8_t> rgba;
+    std::vector<std::uint8_t> encoded;
+    bool ok = true; // false once reading, encoding or writing it failed
+};
+
+// Encodes frames on a thread pool and hands them back in the order they
+// were submitted. At most maxInFlight frames are queued or encoding; submit
+// blocks on the oldest one beyond that, so memory stays bounded when
+// encoding is slower than drawing. Retired frames are recycled with their
+// buffers. All calls except encode come from one thread.
+class FramePipeline {
+public:
+    // encode runs on the pool threads, write on the submitting thread in
+    // frame order, only for frames that are still ok. Either returning false
+    // marks the frame failed.
+    using Encode = std::function<bool(ExportFrame&)>;
+    using Write = std::function<bool(ExportFrame&)>;
+
+    FramePipeline(ThreadPool &pool, std::size_t maxInFlight, Encode encode, Write write);
+    // Waits for the frames still encoding; call finish() to write them.
+    ~FramePipeline();
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // A frame to fill, numbered in order, with the buffers of a retired one
+    // when there is one.
+    std::unique_ptr<ExportFrame> next();
+    // Queue a frame from next() for encoding and write out the finished
+    // frames at the front.
+    void submit(std::unique_ptr<ExportFrame> frame);
+    // Encode and write everything submitted.
+    void finish();
+
+    std::size_t inFlight() const;
+    std::uint64_t frames() const { return m_frames; }
+    bool failed() const { return m_failed; }
+    // Index of the first failed frame; only meaningful when failed().
+    std::uint64_t firstFailure() const { return m_firstFailure; }
+
+private:
+    struct Job;
+    // Write out finished frames from the front, waiting for the oldest while
+    // more than keep are in flight.
+    void retire(std::size_t keep);
+
+    ThreadPool &m_pool;
+    std::size_t m_maxInFlight;
+    Encode m_encode;
+    Write m_write;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_finished;
+    std::deque<std::unique_ptr<Job>> m_inFlight; // oldest first
+    std::vector<std::unique_ptr<ExportFrame>> m_spare;
+    std::uint64_t m_frames = 0;
+    bool m_failed = false;
+    std::uint64_t m_firstFailure = 0;
+};
+
+} // namespace tetris
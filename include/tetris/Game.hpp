@@ -1,82 +1,155 @@
 #pragma once
 
 #include "Types.hpp"
-#include "Tetromino.hpp"
-#include "Board.hpp"
+#include "Engine.hpp"
+#include "BoardRenderer.hpp"
+#include "Bot.hpp"
+#include "Replay.hpp"
+#include "AutoRepeat.hpp"
+#include "Assets.hpp"
+#include "SoundManager.hpp"
+#include "SnapshotRing.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <memory>
-#include <random>
+#include <optional>
+#include <string>
 
 namespace tetris {
 
 class Game {
 public:
-    Game(sf::RenderWindow &window);
+    // Game logic runs on a fixed clock, independent of the render rate.
+    static constexpr std::uint32_t LogicHz = 240;
+    static constexpr std::uint32_t LogicStepMicros = 1000000 / LogicHz;
+    // Longest frame fed to the accumulator, so a stall does not cause a burst of catch-up steps.
+    static constexpr std::uint32_t MaxFrameMicros = 250000;
+
+    // A non-empty recordPath saves a replay of the session there on exit.
+    // A non-empty tracePath profiles from the start and writes a Chrome trace there on exit.
+    // Assets are read from the bundle at bundlePath, with loose files in assets/ as fallback.
+    Game(sf::RenderWindow &window, const std::string &recordPath = {}, const std::string &tracePath = {},
+         const std::string &bundlePath = "assets.pak");
     void run();
+
+    // Draw one frame into target without presenting it; render() draws into
+    // the window and displays it. Used for offscreen rendering.
+    void draw(sf::RenderTarget &target, float sinceStep);
+    // Block until the loader thread is done and install its font and sounds.
+    void waitForAssets();
+    // Continue from a saved position; the rewind history restarts there.
+    // The jump is not part of a replay being recorded.
+    void restore(const Engine::Snapshot &snapshot);
+    const Engine& engine() const { return m_engine; }
 private:
     void processInput();
-    void update(float dt);
-    void render();
-    void spawnPiece();
-    void lockPiece();
-    void hardDrop();
+    void handleKey(sf::Keyboard::Key key, bool pressed);
+    // Advance the simulation by one fixed logic step.
+    void update(std::uint32_t micros);
+    // Fire DAS/ARR repeats for the held movement keys.
+    void updateRepeats(std::uint32_t micros);
+    // Start a new game with a fresh seed.
+    void restart();
+    // Practice mode: go back to the spawn of the previous piece (Backspace).
+    void rewind();
+    // sinceStep is the time since the last logic step, used to interpolate animations.
+    void render(float sinceStep);
+    // Feed an action to the engine and play the matching effects.
+    Events applyAction(Action action);
+    void playEffects(Events ev);
+    // Rebuild cached HUD strings whose values changed since the last frame.
+    void refreshHudText();
+    // Frame time percentiles and per-zone times for the profiler overlay (F3).
+    void refreshProfilerText();
+    // Let the bot pick and enter moves for the active piece.
+    void updateAutoplay();
+    // Take over the font and sounds once the loader thread is done.
+    void installAssets(GameAssets assets);
+    void setVolume(float volume);
+    // Store a key-to-photon sample once the frame showing a key press is displayed.
+    void recordLatency();
 
     sf::RenderWindow &m_window;
-    Board m_board;
-    Tetromino m_active;
-    TetrominoType m_next;
-    std::mt19937 m_rng;
-    float m_dropTimer = 0.0f;
-    float m_dropInterval = 0.6f; // seconds
-    bool m_running = true;
+    Engine m_engine;
+    std::string m_recordPath;
+    std::string m_tracePath;
+    std::unique_ptr<ReplayWriter> m_recorder;
+    BoardRenderer m_renderer;
     bool m_paused = false;
-    int m_score = 0;
-    int m_level = 0;
-    int m_totalLines = 0;
-
-    // Line clear animation state
-    std::vector<int> m_linesToClear;
-    bool m_animating = false;
-    float m_lineClearTimer = 0.0f;
-    float m_lineClearDuration = 0.6f;
-
-    // Audio
-    sf::SoundBuffer m_clearBuffer;
-    std::unique_ptr<sf::Sound> m_clearSound;
-    bool m_clearSoundLoaded = false;
-    // extra sound effects
-    sf::SoundBuffer m_rotateBuffer;
-    std::unique_ptr<sf::Sound> m_rotateSound;
-    bool m_rotateSoundLoaded = false;
-
-    sf::SoundBuffer m_dropBuffer;
-    std::unique_ptr<sf::Sound> m_dropSound;
-    bool m_dropSoundLoaded = false;
-
-    sf::SoundBuffer m_hardDropBuffer;
-    std::unique_ptr<sf::Sound> m_hardDropSound;
-    bool m_hardDropSoundLoaded = false;
-
-    float m_volume = 100.0f; // 0..100
-    bool m_muted = false;
-    // UI sounds and voice
-    sf::SoundBuffer m_uiClickBuffer;
-    std::unique_ptr<sf::Sound> m_uiClickSound;
-    bool m_uiClickLoaded = false;
-
-    sf::SoundBuffer m_voiceLevelBuffer;
-    std::unique_ptr<sf::Sound> m_voiceLevelSound;
-    bool m_voiceLevelLoaded = false;
+    std::uint32_t m_accumulator = 0; // microseconds not yet simulated
+
+    // Engine state at each of the last RewindDepth piece spawns (~1.1 MB)
+    static constexpr std::size_t RewindDepth = 1000;
+    SnapshotRing<Engine::Snapshot> m_history{RewindDepth};
+
+    // Held movement keys; the most recently pressed horizontal key repeats
+    AutoRepeat m_leftRepeat;
+    AutoRepeat m_rightRepeat;
+    AutoRepeat m_downRepeat{RepeatTiming{33000, 33000}};
+    Action m_horizontal = Action::None;
+
+    // Key-to-photon latency over the last LatencySamples key presses
+    static constexpr int LatencySamples = 256;
+    std::array<float, LatencySamples> m_latency{}; // milliseconds
+    std::uint64_t m_latencyTotal = 0; // samples taken, the ring keeps the newest
+    bool m_latencyPending = false;
+    std::chrono::steady_clock::time_point m_inputTime;
+    float m_latencyMean = 0.0f;
+    float m_latencyP95 = 0.0f;
+
+    // Autoplay (toggled with A); search threads are started on first use
+    bool m_autoplay = false;
+    std::unique_ptr<ThreadPool> m_botPool;
+    std::unique_ptr<TranspositionTable> m_botTable;
+    std::unique_ptr<Bot> m_bot;
+    std::unique_ptr<MoveGenerator> m_botPathGen;
+    std::unique_ptr<PlacementList> m_botPlacements;
+    int m_botPiece = -1; // piecesPlaced() when the running search started
+    std::chrono::steady_clock::time_point m_botDeadline;
+
+    // Font and sounds arrive from a loader thread after the first frames
+    std::future<GameAssets> m_pendingAssets;
+    std::unique_ptr<AssetBundle> m_bundle; // backs m_font, keep declared before it
+    std::unique_ptr<sf::Font> m_font;
+    SoundManager m_sounds;
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_firstFrameShown = false;
 
     // Volume slider UI
     bool m_showVolumeSlider = true;
     sf::FloatRect m_volumeSliderRect; // in pixels, updated at render
     bool m_draggingVolume = false;
-    sf::Font m_font;
-    bool m_fontLoaded = false;
 
-    static const std::array<sf::Color, static_cast<int>(TetrominoType::Count)> colors;
+    // Cached HUD drawables; strings are only rebuilt when the values change
+    std::optional<sf::Text> m_statsText;
+    std::optional<sf::Text> m_volumeText;
+    std::optional<sf::Text> m_gameOverText;
+    std::optional<sf::Text> m_allocText;
+    std::optional<sf::Text> m_latencyText;
+    std::optional<sf::Text> m_profilerText;
+    sf::CircleShape m_knob{7.f};
+    int m_shownScore = -1;
+    int m_shownLevel = -1;
+    int m_shownLines = -1;
+    int m_shownVolume = -1;
+    bool m_shownMuted = false;
+    std::uint64_t m_shownAllocations = ~std::uint64_t{0};
+    std::uint64_t m_shownLatencyTotal = 0;
+
+    // Profiler overlay: frame times of the last FrameSamples frames
+    static constexpr int FrameSamples = 240;
+    bool m_showProfiler = false;
+    std::array<float, FrameSamples> m_frameTimes{}; // milliseconds
+    std::uint64_t m_frameCount = 0;
+    std::uint64_t m_profilerRefresh = 0; // profiler::now() of the next overlay update
+    int m_traceExports = 0;
+
+    // Heap allocations made during the last frame (TETRIS_ALLOC_COUNTER builds)
+    std::uint64_t m_frameAllocations = 0;
 };
 
 } // namespace tetris
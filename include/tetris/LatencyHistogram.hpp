@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace tetris {
+
+// Log-linear histogram of durations in microseconds: four buckets per power
+// of two, so a percentile is exact below 4 us and within 25% above. One
+// thread records, any thread may read; recording is a relaxed load and
+// store, with no locks or read-modify-write.
+class LatencyHistogram {
+public:
+    static constexpr int Buckets = 128;
+    using Counts = std::array<std::uint64_t, Buckets>;
+
+    void add(std::uint64_t micros) {
+        std::atomic<std::uint64_t> &c = m_counts[bucket(micros)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Current counts; subtract an earlier copy for the counts of an interval.
+    Counts counts() const {
+        Counts out;
+        for (int i = 0; i < Buckets; ++i) out[i] = m_counts[i].load(std::memory_order_relaxed);
+        return out;
+    }
+
+    static int bucket(std::uint64_t micros) {
+        if (micros < 4) return static_cast<int>(micros);
+        int msb = 63;
+        while (!(micros >> msb)) --msb;
+        int index = (msb - 1) * 4 + static_cast<int>((micros >> (msb - 2)) & 3);
+        return index < Buckets ? index : Buckets - 1;
+    }
+
+    // Largest value that falls into bucket index.
+    static std::uint64_t upperBound(int index) {
+        if (index < 4) return static_cast<std::uint64_t>(index);
+        int msb = index / 4 + 1;
+        std::uint64_t lower = static_cast<std::uint64_t>(4 + index % 4) << (msb - 2);
+        return lower + (std::uint64_t{1} << (msb - 2)) - 1;
+    }
+
+    // p-th percentile (0..100) of counts, as a bucket upper bound; 0 when empty.
+    static std::uint64_t percentile(const Counts &counts, double p) {
+        std::uint64_t total = 0;
+        for (std::uint64_t c : counts) total += c;
+        if (total == 0) return 0;
+        auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (int i = 0; i < Buckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return upperBound(i);
+        }
+        return upperBound(Buckets - 1);
+    }
+
+    static Counts difference(const Counts &now, const Counts &before) {
+        Counts out;
+        for (int i = 0; i < Buckets; ++i) out[i] = now[i] - before[i];
+        return out;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, Buckets> m_counts{};
+};
+
+} // namespace tetris
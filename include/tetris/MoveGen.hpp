@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Tetromino.hpp"
+#include "Board.hpp"
+#include "Engine.hpp"
+#include "TranspositionTable.hpp"
+#include <array>
+#include <cstdint>
+
+namespace tetris {
+
+// A resting position the active piece can lock in.
+struct Placement {
+    TetrominoType type;
+    int rotation;
+    Point position;
+};
+
+// Upper bound on states the generator can visit for one piece.
+constexpr int MoveGenXSpan = BoardWidth + 8;
+constexpr int MoveGenYSpan = BoardHeight + 8;
+constexpr int MoveGenStates = RotationCount * MoveGenXSpan * MoveGenYSpan;
+
+struct PlacementList {
+    std::array<Placement, MoveGenStates> items;
+    int count = 0;
+
+    void clear() { count = 0; }
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+    const Placement& operator[](int i) const { return items[i]; }
+    const Placement* begin() const { return items.data(); }
+    const Placement* end() const { return items.data() + count; }
+};
+
+// Input sequence that moves a piece from its start state onto a placement.
+struct ActionPath {
+    std::array<Action, 128> actions;
+    int count = 0;
+};
+
+// Lists every distinct lock position reachable from a start state through
+// shifts, rotations and soft drops, including tucks and spins. Placements
+// that cover the same cells are reported once, by their shortest input path.
+// Scratch space is owned by the generator, so calls never allocate.
+class MoveGenerator {
+public:
+    MoveGenerator();
+    void generate(const Board &board, const Tetromino &start, PlacementList &out);
+    // Input path found by the last generate() call; false if p was not reached
+    // or the path does not fit. The path ends with a hard drop.
+    bool pathTo(const Placement &p, ActionPath &path) const;
+
+private:
+    static int stateIndex(int rotation, Point pos);
+    bool insertKey(std::uint64_t key);
+
+    std::array<std::uint32_t, MoveGenStates> m_visited; // generation stamp per state
+    std::array<std::int16_t, MoveGenStates> m_parent;
+    std::array<Action, MoveGenStates> m_via;
+    std::array<std::int16_t, MoveGenStates> m_queue;
+    // open addressing set of placed cell sets, for duplicate removal
+    static constexpr int KeySlots = 4096;
+    std::array<std::uint64_t, KeySlots> m_keys;
+    std::array<std::uint32_t, KeySlots> m_keyStamp;
+    std::uint32_t m_stamp = 0;
+    int m_startIndex = -1;
+};
+
+// Counts placement sequences of the given depth, placing queue[i] at ply i and
+// clearing full lines between plies. Depth may not exceed queueLength.
+// With a table, subtree counts of transposed positions are reused; the
+// table must only be shared between calls over the same queue.
+std::uint64_t perft(const Board &board, const TetrominoType *queue, int queueLength, int depth,
+                    TranspositionTable *table = nullptr);
+
+} // namespace tetris
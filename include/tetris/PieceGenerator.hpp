@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Types.hpp"
+#include <array>
+#include <cstdint>
+
+namespace tetris {
+
+// How the next piece is chosen.
+//   Bag7     shuffled bags of all seven pieces, as in modern guideline games
+//   Uniform  every piece independently with probability 1/7
+//   History  TGM style: reroll up to four times while the piece is among
+//            the last four dealt; the first piece is never S, Z or O
+enum class Randomizer : std::uint8_t { Bag7, Uniform, History, Count };
+
+const char* randomizerName(Randomizer mode);
+// Parses "bag7", "uniform" or "history"; returns false for anything else.
+bool parseRandomizer(const char *name, Randomizer &out);
+
+// Counter-based piece source. Draw i of a stream is a pure function of the
+// stream key and i, so the state is a few words, copying it is a fork of the
+// sequence, and any (seed, stream) pair replays without the streams before
+// it: stream k of a batch seeded with S is PieceGenerator(S, k) no matter how
+// many games ran in parallel or in which order.
+class PieceGenerator {
+public:
+    explicit PieceGenerator(std::uint64_t seed = 0, std::uint64_t stream = 0, Randomizer mode = Randomizer::Bag7);
+
+    // Independent child generator, e.g. one per player of a shared game.
+    // Children of the same parent and index are identical; different
+    // indices give unrelated sequences. The child reports its own derived
+    // seed() and stream() (= index), which recreate it.
+    PieceGenerator split(std::uint64_t index) const;
+
+    TetrominoType next();
+    // Piece that next() will return after i more calls; peek(0) is the
+    // next one. Does not advance the generator.
+    TetrominoType peek(int i) const;
+    // Write the next n pieces to out without advancing.
+    void peek(TetrominoType *out, int n) const;
+
+    std::uint64_t seed() const { return m_seed; }
+    std::uint64_t stream() const { return m_stream; }
+    Randomizer mode() const { return m_mode; }
+    // Number of pieces dealt so far.
+    std::uint64_t dealt() const { return m_dealt; }
+
+private:
+    // Uniform integer in [0, n) from the next counter value.
+    int below(int n);
+    void refillBag();
+
+    std::uint64_t m_key;
+    std::uint64_t m_counter = 0;
+    std::uint64_t m_stream;
+    std::uint64_t m_dealt = 0;
+    std::uint64_t m_seed;
+    Randomizer m_mode;
+    std::uint8_t m_bagIndex = 7;
+    std::array<TetrominoType, 7> m_bag{};
+    std::array<TetrominoType, 4> m_history{};
+};
+
+} // namespace tetris
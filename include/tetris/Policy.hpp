@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "MoveGen.hpp"
+#include "Bot.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace tetris {
+
+// Decides the inputs for the active piece of a headless game. One policy
+// object belongs to one thread; plan() is called once per new piece.
+class Policy {
+public:
+    virtual ~Policy() = default;
+    // Fill path with the actions to enter for the current active piece.
+    virtual void plan(const Engine &engine, ActionPath &path) = 0;
+    // Restart any internal randomness, so a game played with the same seed
+    // makes the same choices whichever thread runs it.
+    virtual void reseed(std::uint32_t) {}
+};
+
+// Picks a uniformly random reachable placement.
+class RandomPolicy : public Policy {
+public:
+    explicit RandomPolicy(std::uint32_t seed);
+    void plan(const Engine &engine, ActionPath &path) override;
+    void reseed(std::uint32_t seed) override { m_rng.seed(seed); }
+private:
+    std::mt19937 m_rng;
+    std::unique_ptr<MoveGenerator> m_gen;
+    std::unique_ptr<PlacementList> m_placements;
+};
+
+// Picks the placement with the best one-ply Bot::evaluate score.
+class GreedyPolicy : public Policy {
+public:
+    explicit GreedyPolicy(BotWeights weights = {});
+    void plan(const Engine &engine, ActionPath &path) override;
+private:
+    BotWeights m_weights;
+    std::unique_ptr<MoveGenerator> m_gen;
+    std::unique_ptr<PlacementList> m_placements;
+};
+
+// Replays a fixed script per piece. Letters: L R D (soft drop) U (rotate) H (hard drop).
+// A script without H gets a hard drop appended.
+class ScriptedPolicy : public Policy {
+public:
+    explicit ScriptedPolicy(const std::string &script);
+    void plan(const Engine &engine, ActionPath &path) override;
+private:
+    ActionPath m_script;
+};
+
+// "random", "greedy" or "scripted"; nullptr for unknown names.
+std::unique_ptr<Policy> makePolicy(const std::string &name, std::uint32_t seed, const std::string &script = "H");
+
+} // namespace tetris
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tetris::profiler {
+
+// One timed zone. Names are string literals and are compared by pointer.
+struct Zone {
+    const char *name;
+    std::uint64_t begin; // nanoseconds since program start
+    std::uint64_t end;
+    int thread;          // profiler thread index, 0 = first thread that recorded
+};
+
+// Total time per zone name over a time window.
+struct ZoneTotal {
+    const char *name;
+    std::uint64_t nanos;
+    std::uint32_t count;
+};
+
+// Zones kept per thread; older ones are overwritten.
+constexpr std::size_t RingCapacity = std::size_t{1} << 14;
+constexpr int MaxThreads = 64;
+
+// Recording is off by default; a disabled Scope costs one relaxed load.
+void setEnabled(bool on);
+inline std::atomic<bool> g_enabled{false};
+inline bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+std::uint64_t now();
+// Append a zone to the calling thread's ring. Lock-free, never allocates
+// after the thread's first zone.
+void record(const char *name, std::uint64_t begin, std::uint64_t end);
+// Label the calling thread in exported traces.
+void setThreadName(const char *name);
+
+// Copy all zones that ended at or after `since`, from every thread.
+void collect(std::uint64_t since, std::vector<Zone> &out);
+// Sum zone durations per name without allocating; returns the number of
+// names written to out (at most capacity).
+int summarize(std::uint64_t since, ZoneTotal *out, int capacity);
+// Write the recorded zones as Chrome/Perfetto trace JSON ("X" events).
+bool writeChromeTrace(const std::string &path);
+
+// Times the enclosing block when recording is enabled.
+class Scope {
+public:
+    explicit Scope(const char *name) : m_name(name), m_begin(enabled() ? now() : 0) {}
+    ~Scope() { if (m_begin) record(m_name, m_begin, now()); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+private:
+    const char *m_name;
+    std::uint64_t m_begin;
+};
+
+} // namespace tetris::profiler
+
+#define TETRIS_PROFILE_CONCAT2(a, b) a##b
+#define TETRIS_PROFILE_CONCAT(a, b) TETRIS_PROFILE_CONCAT2(a, b)
+#ifdef TETRIS_PROFILER
+#define TETRIS_PROFILE_SCOPE(name) ::tetris::profiler::Scope TETRIS_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define TETRIS_PROFILE_SCOPE(name) do {} while (0)
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "PieceGenerator.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tetris {
+
+// Wire format between the game server and its clients. Every message is
+//
+//   size:u8 type:u8 payload (size bytes, integers little endian)
+//
+// Client to server:
+//   Start  seed:u64 stream:u64 randomizer:u8      start or restart the session's game
+//   Input  action:u8 seq:u16                      applied as soon as it is read
+// Server to client, at most one State per session and tick:
+//   State  tick:u32 events:u32 score:u32 lines:u16 level:u8 ack:u16
+//          piece:u8 rotation:u8 x:i8 y:i8 next:u8 [rows: 20 x u16]
+//          rows are sent after the board changed (lock, line removal, start)
+//   GameOver  score:u32 lines:u16 pieces:u32
+// The server keeps standard 10x20 games only.
+namespace protocol {
+
+enum class MsgType : std::uint8_t { None, Start, Input, State, GameOver };
+
+constexpr std::size_t HeaderSize = 2;
+constexpr std::size_t MaxMessageSize = HeaderSize + 255;
+
+struct Start {
+    std::uint64_t seed = 0;
+    std::uint64_t stream = 0;
+    Randomizer randomizer = Randomizer::Bag7;
+};
+
+struct Input {
+    Action action = Action::None;
+    std::uint16_t seq = 0; // echoed back as State::ack, for round-trip timing
+};
+
+struct State {
+    std::uint32_t tick = 0;
+    Events events = events::None;
+    std::uint32_t score = 0;
+    std::uint16_t lines = 0;
+    std::uint8_t level = 0;
+    std::uint16_t ack = 0;
+    Tetromino active{TetrominoType::I, 0, Point{}};
+    TetrominoType next = TetrominoType::I;
+    bool hasRows = false;
+    std::array<std::uint16_t, BoardHeight> rows{};
+};
+
+struct GameOver {
+    std::uint32_t score = 0;
+    std::uint16_t lines = 0;
+    std::uint32_t pieces = 0;
+};
+
+// One decoded message; only the member matching type is meaningful.
+struct Message {
+    MsgType type = MsgType::None;
+    Start start;
+    Input input;
+    State state;
+    GameOver gameOver;
+};
+
+// Encoders write one message to out, which must have MaxMessageSize bytes
+// free, and return its length.
+std::size_t encode(const Start &msg, std::uint8_t *out);
+std::size_t encode(const Input &msg, std::uint8_t *out);
+std::size_t encode(const State &msg, std::uint8_t *out);
+std::size_t encode(const GameOver &msg, std::uint8_t *out);
+
+// Fill a State from an engine; rows are included when withRows is set.
+void describe(const Engine &engine, bool withRows, State &out);
+
+// Decode the message at the start of data. Returns the bytes consumed, 0 if
+// the message is not complete yet, or -1 if it is malformed. Never allocates.
+int decode(const std::uint8_t *data, std::size_t size, Message &out);
+
+} // namespace protocol
+} // namespace tetris
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "StateStream.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tetris {
+
+// Compact binary replay: the piece stream plus the exact sequence of
+// step()/tick() calls the engine saw. Layout:
+//
+//   "TRPL" version:u8 randomizer:u8 seed:varint stream:varint
+//   records... End
+//   final score, lines, level, pieces (varints) and board hash (u64 LE)
+//
+// Records are one opcode byte, optionally followed by a varint:
+//   1..5  step(Action)          0x10 us   tick(us microseconds)
+//   0x11 n  n more ticks of the previous length
+//   0x12 seed  reset(seed)      0x00  End
+//
+// Version 1 files predate PieceGenerator; their mt19937 piece sequence can
+// no longer be reproduced, so they are rejected.
+namespace replay {
+constexpr std::uint8_t Version = 2;
+constexpr std::uint8_t OpEnd = 0x00;
+constexpr std::uint8_t OpTick = 0x10;
+constexpr std::uint8_t OpRepeat = 0x11;
+constexpr std::uint8_t OpReset = 0x12;
+
+// The one conversion from recorded ticks to engine time, shared by recorder
+// and player so both feed bit-identical floats to Engine::tick.
+inline float tickSeconds(std::uint32_t micros) { return static_cast<float>(micros) * 1e-6f; }
+} // namespace replay
+
+class ReplayWriter {
+public:
+    // Same arguments as the PieceGenerator the recorded engine started with.
+    explicit ReplayWriter(std::uint64_t seed, std::uint64_t stream = 0, Randomizer mode = Randomizer::Bag7);
+    void action(Action action);
+    void tick(std::uint32_t micros);
+    void reset(std::uint32_t seed);
+    // Close the record stream and append the engine's final state.
+    void finish(const Engine &engine);
+    const std::vector<std::uint8_t>& bytes() const { return m_bytes; }
+    bool save(const std::string &path) const;
+
+private:
+    void flushRepeats();
+    void putVarint(std::uint64_t v);
+
+    std::vector<std::uint8_t> m_bytes;
+    std::uint32_t m_lastTick = 0;
+    bool m_haveTick = false;
+    std::uint64_t m_repeats = 0;
+    bool m_finished = false;
+};
+
+struct ReplayResult {
+    bool valid = false;   // file parsed completely
+    bool matches = false; // final state equals the recorded one
+    std::string error;
+    int score = 0, lines = 0, level = 0, pieces = 0;
+    std::uint64_t boardHash = 0;
+    int expectedScore = 0, expectedLines = 0, expectedLevel = 0, expectedPieces = 0;
+    std::uint64_t expectedBoardHash = 0;
+    std::uint64_t ticks = 0, actions = 0;
+};
+
+// Called after every replayed tick with the engine and the tick's length.
+using ReplayObserver = std::function<void(const Engine &engine, std::uint32_t micros)>;
+
+// Re-simulate a replay as fast as the engine runs, with no window or clock.
+// With a stream writer, every tick is also recorded as a state stream.
+ReplayResult playReplay(const std::uint8_t *data, std::size_t size, StateStreamWriter *states = nullptr);
+ReplayResult playReplay(const std::uint8_t *data, std::size_t size, const ReplayObserver &observer);
+bool loadReplayFile(const std::string &path, std::vector<std::uint8_t> &out);
+
+} // namespace tetris
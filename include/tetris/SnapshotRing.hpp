@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace tetris {
+
+// Bounded stack of the last N values in one arena allocated up front.
+// Pushing onto a full ring drops the oldest entry, so push and pop are a
+// plain copy of one T and never allocate. Used for rewind in practice mode
+// and by searchers that try a move and step back.
+template <typename T>
+class SnapshotRing {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "entries are copied as plain memory");
+
+    explicit SnapshotRing(std::size_t capacity)
+        : m_slots(std::make_unique<T[]>(capacity ? capacity : 1)), m_capacity(capacity ? capacity : 1) {}
+
+    // Slot for a new newest entry, to be filled in place.
+    T& push() {
+        m_top = (m_top + 1) % m_capacity;
+        if (m_size < m_capacity) ++m_size;
+        return m_slots[m_top];
+    }
+    void push(const T &value) { push() = value; }
+    // Newest entry; the ring must not be empty.
+    const T& top() const { return m_slots[m_top]; }
+    // Drop the newest entry and return a reference that stays valid until
+    // the next push.
+    const T& pop() {
+        const T &value = m_slots[m_top];
+        m_top = (m_top + m_capacity - 1) % m_capacity;
+        --m_size;
+        return value;
+    }
+    void clear() { m_size = 0; }
+    bool empty() const { return m_size == 0; }
+    std::size_t size() const { return m_size; }
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t bytes() const { return m_capacity * sizeof(T); }
+
+private:
+    std::unique_ptr<T[]> m_slots;
+    std::size_t m_capacity;
+    std::size_t m_size = 0;
+    std::size_t m_top = 0;
+};
+
+} // namespace tetris
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Assets.hpp"
+#include <SFML/Audio.hpp>
+#include <array>
+#include <memory>
+#include <optional>
+
+namespace tetris {
+
+// Plays sound effects from a fixed pool of voices per effect, so a quick
+// second rotation or drop overlaps the first instead of cutting it off.
+// Volume and mute apply to every voice at once.
+class SoundManager {
+public:
+    static constexpr int VoicesPerEffect = 4;
+
+    // Take over a loaded effect; an empty buffer leaves the effect silent.
+    void setBuffer(Sfx sfx, std::unique_ptr<sf::SoundBuffer> buffer);
+    bool loaded(Sfx sfx) const { return m_effects[static_cast<int>(sfx)].buffer != nullptr; }
+    // Start the effect on an idle voice, or restart the oldest one when all are busy.
+    void play(Sfx sfx);
+
+    // 0..100
+    void setVolume(float volume);
+    float volume() const { return m_volume; }
+    void setMuted(bool muted);
+    bool muted() const { return m_muted; }
+
+private:
+    struct Effect {
+        std::unique_ptr<sf::SoundBuffer> buffer;
+        std::array<std::optional<sf::Sound>, VoicesPerEffect> voices;
+        int next = 0; // voice started longest ago
+    };
+
+    void applyVolume();
+
+    std::array<Effect, SfxCount> m_effects;
+    float m_volume = 100.0f;
+    bool m_muted = false;
+};
+
+} // namespace tetris
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace tetris {
+
+// Bounded lock-free queue between exactly one producer thread and one
+// consumer thread. push fails when the queue is full instead of waiting.
+// Each side keeps a cached copy of the other's index, so the shared
+// counters are only read when the cache says full or empty.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "entries are copied as plain memory");
+
+    // Producer thread only.
+    bool push(const T &value) {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) return false;
+        }
+        m_slots[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only.
+    bool pop(T &out) {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) return false;
+        }
+        out = m_slots[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Exact only when neither side is running.
+    std::size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    // Producer and consumer state on separate cache lines
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail = 0;
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_cachedHead = 0;
+    alignas(64) std::array<T, Capacity> m_slots{};
+};
+
+} // namespace tetris
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Engine.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tetris {
+
+// Game state as seen by a spectator: what a StateStreamReader reproduces.
+struct StreamState {
+    Board board;
+    Tetromino active{TetrominoType::I, 0, Point{}};
+    TetrominoType next = TetrominoType::I;
+    int score = 0;
+    int lines = 0;
+    int level = 0;
+    bool running = true;
+};
+
+// Delta-compressed stream of the visible game state, one record per tick.
+// Layout:
+//
+//   "TSST" version:u8 width:u8 height:u8
+//   records...  End
+//   [index: count:u32 count x { tick:u32 offset:u32 } indexOffset:u32 "TSIX"]
+//
+// A tick is a list of ops closed by TickEnd; a run of ticks where nothing
+// changed is a single Idle op. Ops (varints are LEB128):
+//
+//   TickEnd                     Idle n:varint        n unchanged ticks
+//   Keyframe tick:varint        full state: 4-bit cell colors, piece, next,
+//                               score, lines, level, running
+//   Lock                        place the active piece (color = its type)
+//   Place type rotation x:i8 y:i8   place another piece (several hard
+//                               drops between two ticks)
+//   Clear                       remove the board's full rows
+//   Cells n:u8 {cell:u8 color:u8}   set single cells (color + 1, 0 = empty)
+//   Left, Right, Down           move the active piece by one cell
+//   Piece mask:u8 [type] [rotation] [x:i8] [y:i8]   changed piece fields
+//   Next type:u8   Score, Lines, Level v:varint   Running b:u8
+//
+// Board ops come first and Lock refers to the piece before this tick's
+// piece ops, matching the order the engine locks, clears and spawns in.
+//
+// A keyframe is written every keyframeInterval ticks and whenever most of
+// the board changes at once (a new game), so readers can seek. Only the
+// standard 10x20 board is supported.
+namespace stream {
+constexpr std::uint8_t Version = 1;
+constexpr int HeaderSize = 7;
+} // namespace stream
+
+class StateStreamWriter {
+public:
+    explicit StateStreamWriter(std::uint32_t keyframeInterval = 600);
+    // Record the engine's state after one more tick.
+    void tick(const Engine &engine);
+    // Close the record stream and append the keyframe index.
+    void finish();
+    const std::vector<std::uint8_t>& bytes() const { return m_bytes; }
+    std::uint32_t ticks() const { return m_tick; }
+    std::size_t keyframes() const { return m_index.size(); }
+
+private:
+    struct KeyframeEntry { std::uint32_t tick, offset; };
+
+    void keyframe(const Engine &engine);
+    void flushIdle();
+    // Write board ops turning m_sent.board into board; false if a keyframe is cheaper.
+    bool boardDelta(const Board &board);
+    void putVarint(std::uint64_t v);
+
+    std::vector<std::uint8_t> m_bytes;
+    std::vector<KeyframeEntry> m_index;
+    StreamState m_sent; // what a reader has after the records so far
+    std::uint32_t m_interval;
+    std::uint32_t m_tick = 0;
+    std::uint64_t m_idle = 0;
+    bool m_finished = false;
+};
+
+// Decodes a stream in place; never allocates, so a spectator can follow a
+// live buffer every frame.
+class StateStreamReader {
+public:
+    // Check the header and read the keyframe index, if the stream has one.
+    bool open(const std::uint8_t *data, std::size_t size);
+    // Advance to the next tick; false at the end of the stream or on an
+    // error (see error()).
+    bool next();
+    // Jump to the given tick through the nearest keyframe at or before it.
+    bool seek(std::uint32_t tick);
+
+    const StreamState& state() const { return m_state; }
+    // Tick of state(); valid after the first successful next().
+    std::uint32_t tick() const { return m_tick; }
+    const char* error() const { return m_error; }
+
+private:
+    bool fail(const char *message);
+    bool keyframe();
+    void rewindTo(std::size_t offset);
+
+    const std::uint8_t *m_data = nullptr;
+    const std::uint8_t *m_end = nullptr;  // end of the record stream
+    const std::uint8_t *m_p = nullptr;
+    const std::uint8_t *m_index = nullptr;
+    std::uint32_t m_indexCount = 0;
+    StreamState m_state;
+    std::uint32_t m_tick = 0;
+    std::uint64_t m_idle = 0; // unchanged ticks still to hand out
+    bool m_started = false;
+    const char *m_error = nullptr;
+};
+
+} // namespace tetris
@@ -6,12 +6,112 @@
 
 namespace tetris {
 
+constexpr int PieceCount = static_cast<int>(TetrominoType::Count);
+// Cell color of versus garbage rows, after the piece colors.
+constexpr int GarbageColor = PieceCount;
+constexpr int RotationCount = 4;
+
+// Everything collision and rendering need for one (type, rotation) pair.
+struct ShapeInfo {
+    std::array<Point,4> blocks;    // offsets from the piece origin
+    int minX, maxX, minY, maxY;    // bounding box of blocks
+    int width, height;
+    // rowMasks[r] covers local row minY + r, bit i is column minX + i
+    std::array<RowBits,4> rowMasks;
+    // columnBottom[c]: lowest block y in local column minX + c
+    std::array<int,4> columnBottom;
+};
+
+// Offsets tried in order when rotating; the first free one wins.
+struct KickList {
+    int count;
+    std::array<Point,5> offsets;
+};
+
+namespace detail {
+
+// Base shapes (rotation 0) as 4 block coordinates relative to an origin.
+constexpr std::array<std::array<Point,4>,PieceCount> baseShapes = {{
+    {{ Point{0,1}, Point{1,1}, Point{2,1}, Point{3,1} }}, // I
+    {{ Point{1,0}, Point{2,0}, Point{1,1}, Point{2,1} }}, // O
+    {{ Point{1,0}, Point{0,1}, Point{1,1}, Point{2,1} }}, // T
+    {{ Point{0,0}, Point{0,1}, Point{1,1}, Point{2,1} }}, // J
+    {{ Point{2,0}, Point{0,1}, Point{1,1}, Point{2,1} }}, // L
+    {{ Point{1,0}, Point{2,0}, Point{0,1}, Point{1,1} }}, // S
+    {{ Point{0,0}, Point{1,0}, Point{1,1}, Point{2,1} }}  // Z
+}};
+
+// rotation: 0..3, rotate around (1,1) center for typical tetris shapes
+constexpr Point rotatePoint(Point p, int rotation) {
+    int x = p.x - 1, y = p.y - 1;
+    for (int i = 0; i < (rotation & 3); ++i) {
+        int t = x; x = -y; y = t;
+    }
+    return Point{x + 1, y + 1};
+}
+
+constexpr ShapeInfo makeShape(const std::array<Point,4> &base, int rotation) {
+    ShapeInfo s{};
+    for (int i = 0; i < 4; ++i) s.blocks[i] = rotatePoint(base[i], rotation);
+    s.minX = s.maxX = s.blocks[0].x;
+    s.minY = s.maxY = s.blocks[0].y;
+    for (const auto &b : s.blocks) {
+        s.minX = b.x < s.minX ? b.x : s.minX;
+        s.maxX = b.x > s.maxX ? b.x : s.maxX;
+        s.minY = b.y < s.minY ? b.y : s.minY;
+        s.maxY = b.y > s.maxY ? b.y : s.maxY;
+    }
+    s.width = s.maxX - s.minX + 1;
+    s.height = s.maxY - s.minY + 1;
+    for (const auto &b : s.blocks) s.rowMasks[b.y - s.minY] |= RowBits{1} << (b.x - s.minX);
+    for (auto &bottom : s.columnBottom) bottom = s.minY - 1;
+    for (const auto &b : s.blocks) {
+        int &bottom = s.columnBottom[b.x - s.minX];
+        bottom = b.y > bottom ? b.y : bottom;
+    }
+    return s;
+}
+
+constexpr std::array<std::array<ShapeInfo,RotationCount>,PieceCount> buildShapeTable() {
+    std::array<std::array<ShapeInfo,RotationCount>,PieceCount> table{};
+    for (int t = 0; t < PieceCount; ++t)
+        for (int r = 0; r < RotationCount; ++r)
+            table[t][r] = makeShape(baseShapes[t], r);
+    return table;
+}
+
+constexpr std::array<std::array<KickList,RotationCount>,PieceCount> buildKickTable() {
+    // No wall kicks yet: every rotation only tries its own position.
+    std::array<std::array<KickList,RotationCount>,PieceCount> table{};
+    for (auto &piece : table)
+        for (auto &kicks : piece) kicks = KickList{1, {}};
+    return table;
+}
+
+} // namespace detail
+
+inline constexpr auto ShapeTable = detail::buildShapeTable();
+// KickTable[type][from] lists offsets for rotating from -> from + 1.
+inline constexpr auto KickTable = detail::buildKickTable();
+
 struct Tetromino {
     TetrominoType type;
     int rotation = 0; // 0..3
     Point position; // board coordinates of origin
 
-    static std::array<std::array<Point,4>,4> getShape(TetrominoType type, int rotation);
+    static constexpr const ShapeInfo& shape(TetrominoType type, int rotation) {
+        return ShapeTable[static_cast<int>(type)][rotation & 3];
+    }
+    static constexpr const std::array<Point,4>& getShape(TetrominoType type, int rotation) {
+        return shape(type, rotation).blocks;
+    }
+    static constexpr const KickList& kicks(TetrominoType type, int fromRotation) {
+        return KickTable[static_cast<int>(type)][fromRotation & 3];
+    }
 };
 
+static_assert(Tetromino::shape(TetrominoType::I, 1).width == 1, "I piece must stand upright after one rotation");
+static_assert(Tetromino::shape(TetrominoType::O, 0).rowMasks[0] == 0b11, "O piece row mask");
+static_assert(Tetromino::shape(TetrominoType::T, 0).columnBottom[1] == 1, "T piece stem bottom");
+
 } // namespace tetris
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+// Fixed set of worker threads with one task deque each. Workers take their
+// own newest task first and steal the oldest task of another worker when
+// they run dry, which keeps all cores busy on uneven search trees.
+class ThreadPool {
+public:
+    // 0 threads means one per hardware thread.
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task. Called from a worker it goes to that worker's own deque.
+    void submit(std::function<void()> task);
+    unsigned size() const { return static_cast<unsigned>(m_threads.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, std::function<void()> &task);
+    bool steal(unsigned thief, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_pending{0};
+    std::atomic<unsigned> m_nextQueue{0};
+    bool m_stop = false;
+};
+
+} // namespace tetris
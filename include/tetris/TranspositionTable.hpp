@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tetris {
+
+// Fixed-size hash table shared by concurrent searchers without locks. Each
+// slot holds two 64-bit words, (key ^ data) and data, written with relaxed
+// atomics. A torn write from two racing stores leaves a slot whose words no
+// longer XOR to the probed key, so it reads as a miss instead of wrong data.
+// Always-replace policy: a store overwrites whatever the slot held.
+class TranspositionTable {
+public:
+    struct Stats {
+        std::uint64_t probes = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t collisions = 0; // probe found a slot owned by another key
+        std::uint64_t stores = 0;
+        std::uint64_t overwrites = 0; // store evicted another key
+
+        double hitRate() const { return probes ? static_cast<double>(hits) / probes : 0.0; }
+    };
+
+    // Uses the largest power-of-two slot count that fits in `bytes`.
+    explicit TranspositionTable(std::size_t bytes);
+
+    // Key for a board position with the given active and preview pieces;
+    // TetrominoType::Count stands for "none".
+    static std::uint64_t key(std::uint64_t boardHash, TetrominoType active, TetrominoType preview);
+
+    bool probe(std::uint64_t key, std::uint64_t &data);
+    void store(std::uint64_t key, std::uint64_t data);
+    void clear();
+
+    Stats stats() const;
+    std::size_t slots() const { return m_mask + 1; }
+    std::size_t bytes() const { return slots() * sizeof(Slot); }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check{0}; // key ^ data
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    // Statistics counted per thread on its own cache line, so searchers
+    // sharing the table do not contend on the counters; stats() sums them.
+    static constexpr unsigned CounterShards = 16;
+    struct alignas(64) Counters {
+        std::atomic<std::uint64_t> probes{0};
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> collisions{0};
+        std::atomic<std::uint64_t> stores{0};
+        std::atomic<std::uint64_t> overwrites{0};
+    };
+    // The calling thread's shard.
+    Counters& counters();
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_mask = 0;
+    std::unique_ptr<Counters[]> m_counters;
+};
+
+} // namespace tetris
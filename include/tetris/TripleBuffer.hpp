@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+namespace tetris {
+
+// Hands the newest value from one writer thread to one reader thread
+// without locks or waiting. Writer and reader each own one of three slots;
+// the third is the latest published value, swapped atomically. A reader
+// never sees a half-written value, and a slow reader only skips versions.
+template <typename T>
+class TripleBuffer {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "slots are filled in place and read as plain memory");
+
+    // Writer thread: fill back(), then publish() it.
+    T& back() { return m_slots[m_back]; }
+    void publish() { m_back = m_middle.exchange(m_back | Fresh, std::memory_order_acq_rel) & Index; }
+
+    // Reader thread: take the newest published value, if any is newer than
+    // front(). Returns whether front() changed.
+    bool update() {
+        if (!(m_middle.load(std::memory_order_relaxed) & Fresh)) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & Index;
+        return true;
+    }
+    const T& front() const { return m_slots[m_front]; }
+
+private:
+    static constexpr unsigned Index = 3;
+    static constexpr unsigned Fresh = 4; // set by publish, cleared by update
+
+    std::array<T, 3> m_slots{T(), T(), T()};
+    alignas(64) std::atomic<unsigned> m_middle{1};
+    alignas(64) unsigned m_back = 0; // writer's slot
+    alignas(64) unsigned m_front = 2; // reader's slot
+};
+
+} // namespace tetris
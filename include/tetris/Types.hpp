@@ -1,16 +1,31 @@
 #pragma once
 
 #include <array>
-#include <SFML/System/Vector2.hpp>
+#include <cstdint>
 
 namespace tetris {
 
-using Point = sf::Vector2i;
+// Integer board coordinate. Kept free of SFML so the rules build headless.
+struct Point {
+    int x = 0;
+    int y = 0;
+    constexpr Point() = default;
+    constexpr Point(int x_, int y_) : x(x_), y(y_) {}
+};
+
+constexpr Point operator+(Point a, Point b) { return Point{a.x + b.x, a.y + b.y}; }
+constexpr Point operator-(Point a, Point b) { return Point{a.x - b.x, a.y - b.y}; }
+constexpr Point& operator+=(Point &a, Point b) { a.x += b.x; a.y += b.y; return a; }
+constexpr bool operator==(Point a, Point b) { return a.x == b.x && a.y == b.y; }
+constexpr bool operator!=(Point a, Point b) { return !(a == b); }
 
 constexpr int BoardWidth = 10;
 constexpr int BoardHeight = 20;
 constexpr int CellSize = 30; // pixels
 
+// Occupancy bits of one board row, bit x set when column x is filled.
+using RowBits = std::uint32_t;
+
 enum class TetrominoType { I, O, T, J, L, S, Z, Count };
 
 } // namespace tetris
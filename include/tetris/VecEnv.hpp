@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "ThreadPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tetris {
+
+// Observation buffers of a VecEnv, owned by the caller (e.g. numpy arrays)
+// and written in place on every step. Each is environment-major and
+// contiguous; a null pointer skips that observation.
+struct VecEnvBuffers {
+    std::uint8_t *boards = nullptr; // [envs][Planes][BoardHeight][BoardWidth], 0 or 1, top row first
+    std::int32_t *pieces = nullptr; // [envs][PieceFields]
+    float *rewards = nullptr;       // [envs] score gained by the last step
+    std::uint8_t *dones = nullptr;  // [envs] 1 when the last step ended the game
+};
+
+// Many independent standard games stepped in lockstep, for reinforcement
+// learning. One step() applies one action per game and then advances it by
+// one frame, as a player holding no key would see it. A game that ends is
+// reset right away: its done flag is set, and the observation already shows
+// the new game.
+//
+// Game g of environment i (counting from 0 at construction) deals pieces
+// from stream (g << 32) | i of the seed, so results do not depend on the
+// thread count.
+class VecEnv {
+public:
+    // Plane 0 holds the locked cells, plane 1 the falling piece.
+    static constexpr int Planes = 2;
+    static constexpr std::size_t BoardSize = std::size_t(Planes) * BoardWidth * BoardHeight;
+    // Active type, rotation, x, y (piece origin, may be negative), next type.
+    static constexpr int PieceFields = 5;
+
+    // 0 threads means one per hardware thread; small batches use fewer.
+    VecEnv(int envs, std::uint64_t seed, unsigned threads = 1, float frameSeconds = 1.0f / 60.0f,
+           Randomizer mode = Randomizer::Bag7);
+
+    void setBuffers(const VecEnvBuffers &buffers) { m_buffers = buffers; }
+    // Start the next game everywhere and write the observations; rewards
+    // and dones are cleared.
+    void reset();
+    // One action per environment (values of Action, anything out of range
+    // counts as None). Returns the number of games that ended.
+    int step(const std::uint8_t *actions);
+
+    int size() const { return static_cast<int>(m_engines.size()); }
+    const Engine& engine(int env) const { return m_engines[env]; }
+    // Games started by environment env, including the one running.
+    std::uint32_t games(int env) const { return m_games[env]; }
+    unsigned threads() const { return m_pool ? m_pool->size() + 1 : 1; }
+
+private:
+    // Work on environments [first, last); returns the games that ended.
+    int stepRange(int first, int last);
+    void resetRange(int first, int last);
+    // Start game m_games[env] and count it.
+    void startGame(int env);
+    void observe(int env);
+    template <typename F>
+    int runChunks(F work);
+
+    std::vector<Engine> m_engines;
+    // Per-environment bookkeeping, one array per field
+    std::vector<std::int32_t> m_lastScore;
+    std::vector<std::uint32_t> m_games;
+
+    std::uint64_t m_seed;
+    Randomizer m_mode;
+    float m_frameSeconds;
+    VecEnvBuffers m_buffers;
+    const std::uint8_t *m_actions = nullptr;
+    // Environments are split into equal chunks; the caller runs the last one.
+    std::unique_ptr<ThreadPool> m_pool;
+    int m_chunks = 1;
+};
+
+} // namespace tetris
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "SpscQueue.hpp"
+#include "TripleBuffer.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+// What the render thread sees of one versus player.
+struct VersusPlayerState {
+    Engine::Snapshot engine;
+    int pendingGarbage = 0; // rows received and not yet risen
+    int sentGarbage = 0;    // rows sent over the whole match
+    int place = 0;          // 0 while playing, 1 for the winner, 2.. in order of topping out
+    std::uint64_t ticks = 0; // logic steps simulated
+};
+
+// Local versus match of 2..MaxPlayers players. Everyone deals from the same
+// piece sequence. Clearing 2, 3 or 4 lines at once sends 1, 2 or 4 garbage
+// rows to the next opponent still playing; received rows first cancel
+// against the receiver's own clears, and rise under its stack when it locks
+// a piece without clearing. The last player standing wins.
+//
+// With start(), every player runs on its own thread at the fixed logic
+// rate and no thread ever waits for another: inputs arrive through an SPSC
+// queue per player, garbage through an SPSC queue per ordered pair of
+// players, and each player publishes its state after every step through a
+// triple buffer the render thread reads without locks. Without start(),
+// step() advances players one at a time on the calling thread, which gives
+// the same match for the same inputs.
+class Versus {
+public:
+    static constexpr int MaxPlayers = 8;
+    static constexpr std::uint32_t LogicHz = 240;
+    static constexpr std::uint32_t LogicStepMicros = 1000000 / LogicHz;
+    // Bots enter one input every this many logic steps (20 per second).
+    static constexpr int BotStepInterval = 12;
+    // Most garbage rows risen at one lock; the rest waits for the next.
+    static constexpr int MaxGarbagePerLock = 8;
+
+    // players is clamped to 2..MaxPlayers.
+    Versus(int players, std::uint64_t seed);
+    ~Versus();
+    Versus(const Versus&) = delete;
+    Versus& operator=(const Versus&) = delete;
+
+    int players() const { return m_count; }
+    // Let the greedy bot play for a player; call before start().
+    void setBot(int player, bool bot);
+    bool isBot(int player) const;
+
+    // Launch one simulation thread per player; stop() joins them.
+    void start();
+    void stop();
+    bool started() const { return !m_threads.empty(); }
+    // One logic step of one player on the calling thread; only without start().
+    void step(int player);
+
+    // From one input thread: queue an action for a player. False when the
+    // queue is full.
+    bool input(int player, Action action);
+    // From one render thread: the newest published state, never blocking.
+    const VersusPlayerState& state(int player);
+    // Players still playing; the match is over at one.
+    int alive() const { return m_alive.load(std::memory_order_acquire); }
+
+private:
+    struct Player;
+    // Garbage rows on their way from one player to another.
+    using GarbageQueue = SpscQueue<std::int32_t, 64>;
+
+    void run(int player);
+    // Send rows to the next opponent after player that is still playing.
+    void sendGarbage(int player, int rows);
+    // Bookkeeping after one step() or tick() call of the player's engine.
+    void afterEvents(Player &p, Events ev);
+
+    int m_count;
+    std::array<std::unique_ptr<Player>, MaxPlayers> m_players;
+    // m_garbage[from][to]; the diagonal stays empty
+    std::array<std::array<std::unique_ptr<GarbageQueue>, MaxPlayers>, MaxPlayers> m_garbage;
+    std::atomic<int> m_alive;
+    std::atomic<bool> m_stop{false};
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace tetris
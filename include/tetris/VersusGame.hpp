@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Engine.hpp"
+#include "BoardRenderer.hpp"
+#include "Assets.hpp"
+#include "Versus.hpp"
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace tetris {
+
+// Split-screen frontend of a local Versus match in one window. The
+// simulation runs on the match's own threads; this class only forwards key
+// presses and draws the newest published state of every player, so the
+// frame rate does not depend on the number of players or on their logic.
+class VersusGame {
+public:
+    // Players 0..humans-1 play from the keyboard, the rest are bots.
+    static constexpr int MaxHumans = 2;
+    // Boards per row of the split screen.
+    static constexpr int GridColumns = 4;
+    // Width of one player's panel: the board plus the HUD column.
+    static constexpr int PanelWidth = BoardWidth * CellSize + 120;
+    static constexpr int PanelHeight = BoardHeight * CellSize;
+
+    VersusGame(sf::RenderWindow &window, int players, int humans, std::uint64_t seed,
+               const std::string &bundlePath = "assets.pak");
+    void run();
+
+    // Window size in pixels that shows every panel at scale 1.
+    static sf::Vector2u windowSize(int players);
+
+private:
+    struct Panel {
+        Engine engine; // the player's published state, restored each frame
+        BoardRenderer renderer;
+        sf::View view;
+        std::optional<sf::Text> text;
+        int shownScore = -1, shownLines = -1, shownPending = -1, shownPlace = -1;
+    };
+
+    void processInput();
+    void handleKey(sf::Keyboard::Key key);
+    void render();
+    // Rebuild a panel's HUD string when its values changed.
+    void refreshText(Panel &panel, int player, const VersusPlayerState &state);
+    void installAssets(GameAssets assets);
+
+    sf::RenderWindow &m_window;
+    Versus m_versus;
+    int m_humans;
+    std::array<std::unique_ptr<Panel>, Versus::MaxPlayers> m_panels;
+
+    std::future<GameAssets> m_pendingAssets;
+    std::unique_ptr<AssetBundle> m_bundle; // backs m_font, keep declared before it
+    std::unique_ptr<sf::Font> m_font;
+    std::optional<sf::Text> m_resultText;
+};
+
+} // namespace tetris
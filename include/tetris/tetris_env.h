@@ -0,0 +1,65 @@
+/* Plain C interface to tetris::VecEnv, for Python through ctypes and other
+ * foreign function interfaces. Built as the shared library tetris_env.
+ *
+ * The caller allocates the observation buffers once (e.g. numpy arrays) and
+ * registers them with tetris_env_set_buffers; every reset and step writes
+ * into them in place. All buffers are contiguous and environment-major:
+ *
+ *   boards   uint8  [envs][planes][height][width]  locked cells, falling piece
+ *   pieces   int32  [envs][piece_fields]           type, rotation, x, y, next type
+ *   rewards  float  [envs]                         score gained by the last step
+ *   dones    uint8  [envs]                         1 when the last step ended a game
+ *
+ * A finished game is reset during the same step, so after a done the
+ * observation already shows the next game. Actions are 0 none, 1 left,
+ * 2 right, 3 soft drop, 4 rotate, 5 hard drop.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(TETRIS_ENV_BUILD)
+#define TETRIS_ENV_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define TETRIS_ENV_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define TETRIS_ENV_API __attribute__((visibility("default")))
+#else
+#define TETRIS_ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tetris_env tetris_env;
+
+/* Sizes of the observation buffers per environment and the action count. */
+typedef struct tetris_env_shape {
+    int planes, height, width;
+    int piece_fields;
+    int actions;
+} tetris_env_shape;
+
+TETRIS_ENV_API void tetris_env_get_shape(tetris_env_shape *shape);
+
+/* num_envs games dealing pieces from seed; threads 0 means one per hardware
+ * thread; frame_seconds is the time simulated per step (1/60 is typical).
+ * Returns NULL for invalid arguments or when out of memory. */
+TETRIS_ENV_API tetris_env *tetris_env_create(int num_envs, uint64_t seed, int threads, float frame_seconds);
+TETRIS_ENV_API void tetris_env_destroy(tetris_env *env);
+TETRIS_ENV_API int tetris_env_num_envs(const tetris_env *env);
+TETRIS_ENV_API int tetris_env_num_threads(const tetris_env *env);
+
+/* Any buffer may be NULL to skip that observation. */
+TETRIS_ENV_API void tetris_env_set_buffers(tetris_env *env, uint8_t *boards, int32_t *pieces, float *rewards,
+                                           uint8_t *dones);
+/* Start a new game in every environment and write the observations. */
+TETRIS_ENV_API void tetris_env_reset(tetris_env *env);
+/* Apply actions[num_envs] and advance one frame; returns the number of
+ * games that ended, or -1 for a NULL env. */
+TETRIS_ENV_API int tetris_env_step(tetris_env *env, const uint8_t *actions);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,260 @@
+// Renders a recorded game to PNG frames or a raw video, without a window.
+//
+//   export_replay [--fps n] [--threads n] [--bundle file] replay.trpl out
+//
+// out ending in .y4m is written as one YUV 4:2:0 video (playable by mpv,
+// convertible with "ffmpeg -i out.y4m out.mp4"); any other out is a
+// directory that receives frame_000000.png, frame_000001.png, ...
+//
+// Frames are drawn by Game::draw, the code behind the game window, into a
+// RenderTexture. The hidden window only provides the GL context, so this
+// also runs on machines without a display through Xvfb and Mesa's software
+// renderer:
+//
+//   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a export_replay game.trpl game.y4m
+//
+// The main thread only simulates, draws and starts readbacks; frames come
+// back through a ring of pixel buffer objects a few frames later, and PNG
+// compression or YUV conversion runs on a thread pool.
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include "tetris/FrameExport.hpp"
+#include "tetris/Game.hpp"
+#include "tetris/Replay.hpp"
+#include "tetris/ThreadPool.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+using namespace tetris;
+
+namespace {
+
+// Readback of the frames drawn into a RenderTexture, oldest first. With
+// pixel buffer objects (OpenGL 2.1) glReadPixels only queues the copy and
+// returns; the buffer is mapped Depth frames later, when the copy has long
+// finished. Without them every frame is copied synchronously. GL entry
+// points are looked up through SFML, so nothing links against libGL.
+class FrameReader {
+public:
+    static constexpr unsigned Depth = 3;
+
+    explicit FrameReader(sf::RenderTexture &target) : m_target(target), m_size(target.getSize()) {
+        if (!m_target.setActive(true)) return;
+        genBuffers = reinterpret_cast<GenBuffersFn>(sf::Context::getFunction("glGenBuffers"));
+        deleteBuffers = reinterpret_cast<DeleteBuffersFn>(sf::Context::getFunction("glDeleteBuffers"));
+        bindBuffer = reinterpret_cast<BindBufferFn>(sf::Context::getFunction("glBindBuffer"));
+        bufferData = reinterpret_cast<BufferDataFn>(sf::Context::getFunction("glBufferData"));
+        mapBuffer = reinterpret_cast<MapBufferFn>(sf::Context::getFunction("glMapBuffer"));
+        unmapBuffer = reinterpret_cast<UnmapBufferFn>(sf::Context::getFunction("glUnmapBuffer"));
+        readPixels = reinterpret_cast<ReadPixelsFn>(sf::Context::getFunction("glReadPixels"));
+        pixelStore = reinterpret_cast<PixelStoreFn>(sf::Context::getFunction("glPixelStorei"));
+        if (!genBuffers || !deleteBuffers || !bindBuffer || !bufferData || !mapBuffer || !unmapBuffer || !readPixels || !pixelStore
+            || !sf::Context::isExtensionAvailable("GL_ARB_pixel_buffer_object"))
+            return;
+        genBuffers(static_cast<GLsizei>(Depth), m_buffers);
+        for (GLuint buffer : m_buffers) {
+            bindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            bufferData(GL_PIXEL_PACK_BUFFER, static_cast<std::ptrdiff_t>(frameBytes()), nullptr, GL_STREAM_READ);
+        }
+        bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_pipelined = true;
+    }
+
+    ~FrameReader() {
+        if (m_pipelined && m_target.setActive(true)) deleteBuffers(static_cast<GLsizei>(Depth), m_buffers);
+    }
+
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    bool pipelined() const { return m_pipelined; }
+    std::size_t frameBytes() const { return std::size_t(m_size.x) * m_size.y * 4; }
+    // Frames queued and not yet taken.
+    unsigned queued() const { return m_queued - m_taken; }
+    // Room for another queue() without taking a frame first.
+    bool hasRoom() const { return queued() < (m_pipelined ? Depth : 1u); }
+
+    // Start reading back the frame just drawn and displayed. Needs hasRoom().
+    void queue() {
+        if (!m_pipelined) {
+            m_image = m_target.getTexture().copyToImage();
+            ++m_queued;
+            return;
+        }
+        if (!m_target.setActive(true)) return;
+        bindBuffer(GL_PIXEL_PACK_BUFFER, m_buffers[m_queued % Depth]);
+        pixelStore(GL_PACK_ALIGNMENT, 1);
+        readPixels(0, 0, static_cast<GLsizei>(m_size.x), static_cast<GLsizei>(m_size.y), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        ++m_queued;
+    }
+
+    // Copy the oldest queued frame into rgba, top row first as in sf::Image.
+    bool take(std::vector<std::uint8_t> &rgba) {
+        if (!queued()) return false;
+        rgba.resize(frameBytes());
+        ++m_taken;
+        if (!m_pipelined) {
+            std::memcpy(rgba.data(), m_image.getPixelsPtr(), rgba.size());
+            return true;
+        }
+        if (!m_target.setActive(true)) return false;
+        bindBuffer(GL_PIXEL_PACK_BUFFER, m_buffers[(m_taken - 1) % Depth]);
+        const auto *pixels = static_cast<const std::uint8_t*>(mapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+        if (pixels) {
+            // GL rows run bottom to top
+            std::size_t stride = std::size_t(m_size.x) * 4;
+            for (unsigned y = 0; y < m_size.y; ++y)
+                std::memcpy(rgba.data() + y * stride, pixels + (m_size.y - 1 - y) * stride, stride);
+            unmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return pixels != nullptr;
+    }
+
+private:
+    using GenBuffersFn = void (APIENTRY *)(GLsizei, GLuint*);
+    using DeleteBuffersFn = void (APIENTRY *)(GLsizei, const GLuint*);
+    using BindBufferFn = void (APIENTRY *)(GLenum, GLuint);
+    using BufferDataFn = void (APIENTRY *)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    using MapBufferFn = void* (APIENTRY *)(GLenum, GLenum);
+    using UnmapBufferFn = GLboolean (APIENTRY *)(GLenum);
+    using ReadPixelsFn = void (APIENTRY *)(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*);
+    using PixelStoreFn = void (APIENTRY *)(GLenum, GLint);
+
+    GenBuffersFn genBuffers = nullptr;
+    DeleteBuffersFn deleteBuffers = nullptr;
+    BindBufferFn bindBuffer = nullptr;
+    BufferDataFn bufferData = nullptr;
+    MapBufferFn mapBuffer = nullptr;
+    UnmapBufferFn unmapBuffer = nullptr;
+    ReadPixelsFn readPixels = nullptr;
+    PixelStoreFn pixelStore = nullptr;
+
+    sf::RenderTexture &m_target;
+    sf::Vector2u m_size;
+    GLuint m_buffers[Depth] = {};
+    bool m_pipelined = false;
+    unsigned m_queued = 0, m_taken = 0;
+    sf::Image m_image; // the frame in flight without pixel buffers
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    unsigned fps = 60, threads = 0;
+    std::string bundlePath = (std::filesystem::path(argv[0]).parent_path() / "assets.pak").string();
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) fps = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--bundle") == 0 && i + 1 < argc) bundlePath = argv[++i];
+        else args.emplace_back(argv[i]);
+    }
+    if (args.size() != 2 || fps == 0) {
+        std::fprintf(stderr, "usage: export_replay [--fps n] [--threads n] [--bundle file] replay.trpl out.y4m|outdir\n");
+        return 2;
+    }
+    std::vector<std::uint8_t> data;
+    if (!loadReplayFile(args[0], data)) {
+        std::fprintf(stderr, "cannot read %s\n", args[0].c_str());
+        return 1;
+    }
+    const std::filesystem::path out = args[1];
+    const bool video = out.extension() == ".y4m";
+
+    const sf::Vector2u size(BoardWidth * CellSize + 200, BoardHeight * CellSize);
+    // Game needs a window for input; it stays hidden and is never drawn to
+    sf::RenderWindow window(sf::VideoMode(size), "export_replay");
+    window.setVisible(false);
+    sf::RenderTexture target(size);
+    Game game(window, {}, {}, bundlePath);
+    game.waitForAssets();
+    FrameReader reader(target);
+
+    std::FILE *file = nullptr;
+    if (video) {
+        file = std::fopen(out.string().c_str(), "wb");
+        if (file) std::fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", size.x, size.y, fps);
+    } else {
+        std::error_code ec;
+        std::filesystem::create_directories(out, ec);
+    }
+    if (video && !file) {
+        std::fprintf(stderr, "cannot write %s\n", out.string().c_str());
+        return 1;
+    }
+
+    // PNGs are written by the encoder threads; Y4M frames are appended here
+    // in order. Frames in flight are bounded so memory stays flat when
+    // encoding is slower than drawing.
+    ThreadPool pool(threads);
+    FramePipeline pipeline(pool, 2 * pool.size() + FrameReader::Depth,
+        [&](ExportFrame &frame) {
+            if (video) {
+                convertToYuv(frame.rgba.data(), size.x, size.y, frame.encoded);
+                return true;
+            }
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%06llu.png", static_cast<unsigned long long>(frame.index));
+            return sf::Image(size, frame.rgba.data()).saveToFile(out / name);
+        },
+        [&](ExportFrame &frame) {
+            return !file || std::fwrite(frame.encoded.data(), 1, frame.encoded.size(), file) == frame.encoded.size();
+        });
+    auto encodeOldest = [&] {
+        std::unique_ptr<ExportFrame> frame = pipeline.next();
+        frame->ok = reader.take(frame->rgba);
+        pipeline.submit(std::move(frame));
+    };
+
+    // Frame k shows the game as of the first tick at or after k / fps seconds
+    const std::uint64_t frameMicros = 1000000 / fps;
+    std::uint64_t replayMicros = 0, nextFrame = 0;
+    auto start = std::chrono::steady_clock::now();
+    ReplayResult r = playReplay(data.data(), data.size(), [&](const Engine &engine, std::uint32_t micros) {
+        replayMicros += micros;
+        if (replayMicros < nextFrame) return;
+        game.restore(engine.snapshot());
+        while (nextFrame <= replayMicros) {
+            game.draw(target, 0.0f);
+            target.display();
+            if (!reader.hasRoom()) encodeOldest();
+            reader.queue();
+            nextFrame += frameMicros;
+        }
+    });
+    while (reader.queued()) encodeOldest();
+    pipeline.finish();
+    bool failed = pipeline.failed();
+    if (failed) std::fprintf(stderr, "cannot write frame %llu\n", static_cast<unsigned long long>(pipeline.firstFailure()));
+    if (file && std::fclose(file) != 0) failed = true;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!r.valid) std::fprintf(stderr, "%s: %s (exported up to there)\n", args[0].c_str(), r.error.c_str());
+    else if (!r.matches) std::fprintf(stderr, "%s: final state differs from the recording\n", args[0].c_str());
+    double length = static_cast<double>(replayMicros) * 1e-6;
+    std::printf("%llu frames (%.1f s of play at %u fps) in %.2f s: %.0f frames/s, %.1fx real time, %s readback, %u encoder threads\n",
+                static_cast<unsigned long long>(pipeline.frames()), length, fps, seconds, seconds > 0 ? pipeline.frames() / seconds : 0.0,
+                seconds > 0 ? length / seconds : 0.0, reader.pipelined() ? "pipelined" : "synchronous", pool.size());
+    return failed || !r.valid ? 1 : 0;
+}
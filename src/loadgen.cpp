@@ -0,0 +1,277 @@
+// Drives many bot sessions against a running server, for load and soak tests.
+//
+//   loadgen [--host H] [--port P | --unix path] [--sessions N] [--threads T]
+//           [--seconds S] [--rate A] [--seed S]
+//
+// Each bot plays random inputs (--rate per second, hard drop about one in
+// ten) and starts a new game on game over. Input-to-State round trips are
+// timed through the ack field. Exits with 1 if not every session connected
+// or any session was dropped.
+#include "net_common.hpp"
+#include "tetris/LatencyHistogram.hpp"
+#include "tetris/Protocol.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <sys/epoll.h>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    net::Endpoint endpoint;
+    int sessions = 1000;
+    unsigned threads = 0;
+    double seconds = 10.0;
+    double rate = 5.0; // inputs per second per bot
+    std::uint64_t seed = 1;
+};
+
+struct Bot {
+    int fd = -1;
+    std::uint64_t stream = 0;
+    bool connected = false;
+    bool closed = false;
+    Clock::time_point nextInput;
+    std::uint16_t seq = 0;
+    std::uint16_t timed = 0; // last seq whose round trip was recorded
+    std::array<Clock::time_point, 16> sentAt; // by seq & 15
+    std::uint64_t rng = 0;
+    std::size_t inLength = 0;
+    std::array<std::uint8_t, 4096> in;
+};
+
+// Written by one worker, summed by the main thread.
+struct alignas(64) WorkerStats {
+    std::atomic<std::uint64_t> connected{0};
+    std::atomic<std::uint64_t> failed{0};   // connect errors and dropped sessions
+    std::atomic<std::uint64_t> inputs{0};
+    std::atomic<std::uint64_t> states{0};
+    std::atomic<std::uint64_t> games{0};
+    std::atomic<std::uint64_t> bytesIn{0};
+    LatencyHistogram roundTrip;
+};
+
+template <typename T>
+void bump(std::atomic<T> &counter, T by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+Action pickAction(std::uint64_t &rng) {
+    rng = detail::splitmix64(rng);
+    int r = static_cast<int>(rng % 20);
+    if (r < 2) return Action::HardDrop;
+    if (r < 5) return Action::SoftDrop;
+    if (r < 10) return Action::Rotate;
+    return r < 15 ? Action::Left : Action::Right;
+}
+
+bool sendAll(int fd, const std::uint8_t *data, std::size_t size) {
+    // messages are tiny; a full socket buffer means the server stopped reading
+    return ::send(fd, data, size, MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+}
+
+void startGame(Bot &bot, const Options &opt, WorkerStats &stats) {
+    std::uint8_t buf[protocol::MaxMessageSize];
+    protocol::Start start{opt.seed, bot.stream, Randomizer::Bag7};
+    if (!sendAll(bot.fd, buf, protocol::encode(start, buf))) bot.closed = true;
+    bump(stats.games, std::uint64_t{1});
+}
+
+void worker(const Options &opt, int first, int count, const std::atomic<bool> &stop, WorkerStats &stats) {
+    int ep = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<std::unique_ptr<Bot>> bots;
+    sockaddr_storage addr;
+    socklen_t addrLen = net::address(opt.endpoint, addr);
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / opt.rate));
+    std::uint8_t buf[protocol::MaxMessageSize];
+    std::array<epoll_event, 256> ready;
+    int opened = 0;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        // connect in small batches so the listen queue does not overflow
+        for (int batch = 0; batch < 64 && opened < count; ++batch, ++opened) {
+            auto bot = std::make_unique<Bot>();
+            bot->stream = static_cast<std::uint64_t>(first + opened);
+            bot->rng = detail::splitmix64(opt.seed ^ bot->stream);
+            bot->fd = net::openSocket(opt.endpoint);
+            if (bot->fd < 0 || (::connect(bot->fd, reinterpret_cast<sockaddr*>(&addr), addrLen) != 0 && errno != EINPROGRESS)) {
+                if (bot->fd >= 0) ::close(bot->fd);
+                bump(stats.failed, std::uint64_t{1});
+                continue;
+            }
+            if (opt.endpoint.unixPath.empty()) net::setNoDelay(bot->fd);
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+            ev.data.ptr = bot.get();
+            ::epoll_ctl(ep, EPOLL_CTL_ADD, bot->fd, &ev);
+            bots.push_back(std::move(bot));
+        }
+
+        int n = ::epoll_wait(ep, ready.data(), static_cast<int>(ready.size()), 5);
+        for (int i = 0; i < n; ++i) {
+            Bot &bot = *static_cast<Bot*>(ready[i].data.ptr);
+            if (bot.closed) continue;
+            if (ready[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+                bot.closed = true;
+                bump(stats.failed, std::uint64_t{1});
+                continue;
+            }
+            if (!bot.connected && (ready[i].events & EPOLLOUT)) {
+                bot.connected = true;
+                bump(stats.connected, std::uint64_t{1});
+                epoll_event ev{};
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.ptr = &bot;
+                ::epoll_ctl(ep, EPOLL_CTL_MOD, bot.fd, &ev);
+                // spread the bots' inputs over the interval
+                bot.nextInput = Clock::now() + interval * static_cast<int>(bot.rng % 1000) / 1000;
+                startGame(bot, opt, stats);
+            }
+            if (!(ready[i].events & EPOLLIN)) continue;
+            ssize_t got;
+            while ((got = ::recv(bot.fd, bot.in.data() + bot.inLength, bot.in.size() - bot.inLength, 0)) > 0) {
+                bump(stats.bytesIn, static_cast<std::uint64_t>(got));
+                bot.inLength += static_cast<std::size_t>(got);
+                std::size_t pos = 0;
+                protocol::Message msg;
+                int used;
+                while ((used = protocol::decode(bot.in.data() + pos, bot.inLength - pos, msg)) > 0) {
+                    pos += static_cast<std::size_t>(used);
+                    if (msg.type == protocol::MsgType::State) {
+                        bump(stats.states, std::uint64_t{1});
+                        // later States repeat the ack; only the first one answers the input
+                        if (msg.state.ack == bot.seq && bot.seq != bot.timed) {
+                            bot.timed = bot.seq;
+                            auto rtt = Clock::now() - bot.sentAt[bot.seq & 15];
+                            stats.roundTrip.add(static_cast<std::uint64_t>(
+                                std::chrono::duration_cast<std::chrono::microseconds>(rtt).count()));
+                        }
+                    } else if (msg.type == protocol::MsgType::GameOver) {
+                        bot.stream += static_cast<std::uint64_t>(opt.sessions); // next game, new stream
+                        startGame(bot, opt, stats);
+                    }
+                }
+                if (used < 0) { bot.closed = true; bump(stats.failed, std::uint64_t{1}); break; }
+                std::memmove(bot.in.data(), bot.in.data() + pos, bot.inLength - pos);
+                bot.inLength -= pos;
+            }
+            if (got == 0) { bot.closed = true; bump(stats.failed, std::uint64_t{1}); }
+        }
+
+        const auto now = Clock::now();
+        for (auto &ptr : bots) {
+            Bot &bot = *ptr;
+            if (!bot.connected || bot.closed || now < bot.nextInput) continue;
+            bot.nextInput += interval;
+            if (bot.nextInput < now) bot.nextInput = now + interval;
+            protocol::Input input{pickAction(bot.rng), ++bot.seq};
+            if (bot.seq == 0) input.seq = ++bot.seq;
+            bot.sentAt[input.seq & 15] = now;
+            if (!sendAll(bot.fd, buf, protocol::encode(input, buf))) {
+                bot.closed = true;
+                bump(stats.failed, std::uint64_t{1});
+                continue;
+            }
+            bump(stats.inputs, std::uint64_t{1});
+        }
+    }
+    for (auto &bot : bots) ::close(bot->fd);
+    ::close(ep);
+}
+
+bool parseArgs(int argc, char **argv, Options &opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (arg == "--host") opt.endpoint.host = value;
+        else if (arg == "--port") opt.endpoint.port = std::atoi(value);
+        else if (arg == "--unix") opt.endpoint.unixPath = value;
+        else if (arg == "--sessions") opt.sessions = std::atoi(value);
+        else if (arg == "--threads") opt.threads = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--seconds") opt.seconds = std::atof(value);
+        else if (arg == "--rate") opt.rate = std::atof(value);
+        else if (arg == "--seed") opt.seed = std::strtoull(value, nullptr, 10);
+        else return false;
+        ++i;
+    }
+    sockaddr_storage addr;
+    return opt.sessions > 0 && opt.seconds > 0 && opt.rate > 0 && net::address(opt.endpoint, addr) != 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: loadgen [--host H] [--port P | --unix path] [--sessions N] [--threads T]\n"
+                             "               [--seconds S] [--rate A] [--seed S]\n");
+        return 2;
+    }
+    long files = net::raiseFileLimit();
+    if (files > 0 && files < opt.sessions + 64)
+        std::fprintf(stderr, "loadgen: file limit %ld is too low for %d sessions\n", files, opt.sessions);
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency() / 2);
+    threads = std::min(threads, static_cast<unsigned>(opt.sessions));
+
+    std::atomic<bool> stop{false};
+    std::vector<std::unique_ptr<WorkerStats>> stats;
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        int first = static_cast<int>(static_cast<long long>(opt.sessions) * t / threads);
+        int last = static_cast<int>(static_cast<long long>(opt.sessions) * (t + 1) / threads);
+        stats.push_back(std::make_unique<WorkerStats>());
+        pool.emplace_back(worker, std::cref(opt), first, last - first, std::cref(stop), std::ref(*stats[t]));
+    }
+
+    auto sum = [&](std::atomic<std::uint64_t> WorkerStats::*field) {
+        std::uint64_t total = 0;
+        for (auto &s : stats) total += ((*s).*field).load(std::memory_order_relaxed);
+        return total;
+    };
+    const auto start = Clock::now();
+    std::uint64_t lastInputs = 0, lastStates = 0;
+    LatencyHistogram::Counts lastRtt{};
+    for (int second = 1; second <= static_cast<int>(opt.seconds + 0.999); ++second) {
+        std::this_thread::sleep_until(start + std::chrono::seconds(second));
+        LatencyHistogram::Counts rtt{};
+        for (auto &s : stats) {
+            auto c = s->roundTrip.counts();
+            for (int b = 0; b < LatencyHistogram::Buckets; ++b) rtt[b] += c[b];
+        }
+        auto interval = LatencyHistogram::difference(rtt, lastRtt);
+        std::uint64_t inputs = sum(&WorkerStats::inputs), states = sum(&WorkerStats::states);
+        std::printf("[%4d s] %6llu connected %4llu failed  %7llu inputs/s %7llu states/s  rtt p50 %5llu us p99 %6llu us\n",
+                    second, static_cast<unsigned long long>(sum(&WorkerStats::connected)),
+                    static_cast<unsigned long long>(sum(&WorkerStats::failed)),
+                    static_cast<unsigned long long>(inputs - lastInputs), static_cast<unsigned long long>(states - lastStates),
+                    static_cast<unsigned long long>(LatencyHistogram::percentile(interval, 50)),
+                    static_cast<unsigned long long>(LatencyHistogram::percentile(interval, 99)));
+        std::fflush(stdout);
+        lastInputs = inputs;
+        lastStates = states;
+        lastRtt = rtt;
+    }
+    stop.store(true);
+    for (auto &t : pool) t.join();
+
+    std::uint64_t connected = sum(&WorkerStats::connected), failed = sum(&WorkerStats::failed);
+    std::printf("%llu of %d sessions connected, %llu failed, %llu games, %llu inputs, %llu states, %.1f MB received; "
+                "rtt p50 %llu us p99 %llu us max %llu us\n",
+                static_cast<unsigned long long>(connected), opt.sessions, static_cast<unsigned long long>(failed),
+                static_cast<unsigned long long>(sum(&WorkerStats::games)), static_cast<unsigned long long>(sum(&WorkerStats::inputs)),
+                static_cast<unsigned long long>(sum(&WorkerStats::states)),
+                static_cast<double>(sum(&WorkerStats::bytesIn)) / (1024.0 * 1024.0),
+                static_cast<unsigned long long>(LatencyHistogram::percentile(lastRtt, 50)),
+                static_cast<unsigned long long>(LatencyHistogram::percentile(lastRtt, 99)),
+                static_cast<unsigned long long>(LatencyHistogram::percentile(lastRtt, 100)));
+    return connected == static_cast<std::uint64_t>(opt.sessions) && failed == 0 ? 0 : 1;
+}
@@ -1,15 +1,53 @@
 #include <SFML/Graphics.hpp>
 #include "tetris/Game.hpp"
+#include "tetris/VersusGame.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+
+int main(int argc, char **argv) {
+    // --record <file> saves a replay of the session
+    // --fps <n> caps the render rate instead of waiting for vsync (0 = uncapped)
+    // --trace <file> profiles the whole session and writes a Chrome trace on exit
+    // --bundle <file> reads assets from that bundle (default: assets.pak next to the executable)
+    // --versus <n> plays a split-screen match of 2..8 players, --humans <h> of them from the keyboard (default 1)
+    std::string recordPath;
+    std::string tracePath;
+    std::string bundlePath = (std::filesystem::path(argv[0]).parent_path() / "assets.pak").string();
+    int fps = -1;
+    int versus = 0;
+    int humans = 1;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+        if (std::strcmp(argv[i], "--fps") == 0) fps = std::atoi(argv[i + 1]);
+        if (std::strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+        if (std::strcmp(argv[i], "--bundle") == 0) bundlePath = argv[i + 1];
+        if (std::strcmp(argv[i], "--versus") == 0) versus = std::atoi(argv[i + 1]);
+        if (std::strcmp(argv[i], "--humans") == 0) humans = std::atoi(argv[i + 1]);
+    }
+
+    if (versus > 0) {
+        sf::RenderWindow window(sf::VideoMode(tetris::VersusGame::windowSize(versus)), "Tetris - versus");
+        if (fps < 0) window.setVerticalSyncEnabled(true);
+        else window.setFramerateLimit(static_cast<unsigned>(fps));
+        tetris::VersusGame game(window, versus, humans, std::random_device{}(), bundlePath);
+        game.run();
+        return 0;
+    }
 
-int main() {
     // Window sized to fit the board plus UI area
     int width = tetris::BoardWidth * tetris::CellSize + 200;
     int height = tetris::BoardHeight * tetris::CellSize;
     sf::VideoMode vm(sf::Vector2u((unsigned)width, (unsigned)height));
     sf::RenderWindow window(vm, "Tetris - test8");
-    window.setFramerateLimit(60);
+    // Logic runs at a fixed rate inside Game, so the render rate only affects
+    // latency and smoothness. Vsync avoids the coarse sleep of a frame cap.
+    if (fps < 0) window.setVerticalSyncEnabled(true);
+    else window.setFramerateLimit(static_cast<unsigned>(fps));
 
-    tetris::Game game(window);
+    tetris::Game game(window, recordPath, tracePath, bundlePath);
     game.run();
 
     return 0;
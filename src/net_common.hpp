@@ -0,0 +1,65 @@
+// Socket helpers shared by the game server and the load generator (POSIX).
+#pragma once
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace net {
+
+// Where to listen or connect: a Unix socket path if set, TCP otherwise.
+struct Endpoint {
+    std::string host = "127.0.0.1";
+    int port = 7777;
+    std::string unixPath;
+};
+
+// Fill addr for the endpoint; returns its length, or 0 for a bad address.
+inline socklen_t address(const Endpoint &ep, sockaddr_storage &addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    if (!ep.unixPath.empty()) {
+        auto *un = reinterpret_cast<sockaddr_un*>(&addr);
+        if (ep.unixPath.size() >= sizeof(un->sun_path)) return 0;
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, ep.unixPath.c_str(), ep.unixPath.size() + 1);
+        return sizeof(sockaddr_un);
+    }
+    auto *in = reinterpret_cast<sockaddr_in*>(&addr);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(static_cast<std::uint16_t>(ep.port));
+    if (inet_pton(AF_INET, ep.host.c_str(), &in->sin_addr) != 1) return 0;
+    return sizeof(sockaddr_in);
+}
+
+// Non-blocking stream socket for the endpoint's address family.
+inline int openSocket(const Endpoint &ep) {
+    return ::socket(ep.unixPath.empty() ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+}
+
+// Send small messages right away instead of waiting to coalesce them.
+inline void setNoDelay(int fd) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// Raise the open file limit to the hard limit; thousands of sessions need
+// more descriptors than the usual default of 1024. Returns the new limit.
+inline long raiseFileLimit() {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) return -1;
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    return static_cast<long>(limit.rlim_cur);
+}
+
+} // namespace net
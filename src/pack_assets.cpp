@@ -0,0 +1,24 @@
+// Packs an asset directory into one memory-mappable bundle.
+//
+//   pack_assets <directory> <bundle>
+//
+// Run by the build (target asset_bundle); the game maps the bundle at
+// startup and falls back to the loose files for anything missing.
+#include "tetris/AssetBundle.hpp"
+#include <cstdio>
+
+using namespace tetris;
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: pack_assets <directory> <bundle>\n");
+        return 2;
+    }
+    int files = writeAssetBundle(argv[1], argv[2]);
+    if (files < 0) {
+        std::fprintf(stderr, "pack_assets: could not pack %s into %s\n", argv[1], argv[2]);
+        return 1;
+    }
+    std::printf("packed %d files into %s\n", files, argv[2]);
+    return 0;
+}
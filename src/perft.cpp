@@ -0,0 +1,87 @@
+// Counts placement sequences for a board and piece queue, like chess perft.
+//
+//   perft [--hash MB] [depth] [queue] [board-file]
+//
+// queue is a string of piece letters (default TIOLJSZ). The optional board
+// file holds rows of '.' (empty) and any other character (filled), aligned to
+// the bottom of the board. --hash shares subtree counts of transposed
+// positions through a transposition table of the given size.
+#include "tetris/MoveGen.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace tetris;
+
+static bool parseQueue(const std::string &text, std::vector<TetrominoType> &queue) {
+    static const char letters[] = "IOTJLSZ";
+    for (char ch : text) {
+        int t = 0;
+        while (t < PieceCount && letters[t] != ch) ++t;
+        if (t == PieceCount) return false;
+        queue.push_back(static_cast<TetrominoType>(t));
+    }
+    return true;
+}
+
+static bool loadBoard(const char *path, Board &board) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+        if (!line.empty()) lines.push_back(line);
+    int y = BoardHeight - static_cast<int>(lines.size());
+    for (const auto &line : lines) {
+        for (int x = 0; x < BoardWidth && x < static_cast<int>(line.size()); ++x)
+            if (line[x] != '.' && line[x] != ' ') board.setCell(x, y, 0);
+        ++y;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    std::vector<const char*> args;
+    std::unique_ptr<TranspositionTable> table;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--hash" && i + 1 < argc) {
+            table = std::make_unique<TranspositionTable>(static_cast<std::size_t>(std::atoi(argv[++i])) << 20);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    int depth = args.size() > 0 ? std::atoi(args[0]) : 3;
+    std::vector<TetrominoType> queue;
+    if (!parseQueue(args.size() > 1 ? args[1] : "TIOLJSZ", queue)) {
+        std::fprintf(stderr, "queue may only contain the letters IOTJLSZ\n");
+        return 1;
+    }
+    Board board;
+    if (args.size() > 2 && !loadBoard(args[2], board)) {
+        std::fprintf(stderr, "cannot read board file %s\n", args[2]);
+        return 1;
+    }
+    if (depth < 1 || depth > static_cast<int>(queue.size())) {
+        std::fprintf(stderr, "depth must be between 1 and the queue length (%zu)\n", queue.size());
+        return 1;
+    }
+
+    std::printf("%5s %16s %10s %14s\n", "depth", "nodes", "ms", "nodes/s");
+    for (int d = 1; d <= depth; ++d) {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t nodes = perft(board, queue.data(), static_cast<int>(queue.size()), d, table.get());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%5d %16llu %10.1f %14.0f\n", d, static_cast<unsigned long long>(nodes), seconds * 1000.0,
+                    seconds > 0 ? nodes / seconds : 0.0);
+    }
+    if (table) {
+        TranspositionTable::Stats s = table->stats();
+        std::printf("hash: %zu MB, %llu probes, %.1f%% hits, %llu collisions, %llu overwrites\n",
+                    table->bytes() >> 20, static_cast<unsigned long long>(s.probes), s.hitRate() * 100.0,
+                    static_cast<unsigned long long>(s.collisions), static_cast<unsigned long long>(s.overwrites));
+    }
+    return 0;
+}
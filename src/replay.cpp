@@ -0,0 +1,82 @@
+// Re-simulates recorded sessions headless and checks their final state.
+//
+//   replay [-q] [--stream] file...
+//
+// Files are verified in parallel on all cores. Prints one line per file
+// (only mismatches with -q) and a summary; exits with 1 if any file fails.
+// --stream also writes each game's state stream to <file>.tsst.
+#include "tetris/Replay.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+int main(int argc, char **argv) {
+    bool quiet = false, exportStream = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-q") == 0) quiet = true;
+        else if (std::strcmp(argv[i], "--stream") == 0) exportStream = true;
+        else files.emplace_back(argv[i]);
+    }
+    if (files.empty()) {
+        std::fprintf(stderr, "usage: replay [-q] [--stream] file...\n");
+        return 2;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<int> failures{0};
+    std::atomic<std::uint64_t> ticks{0};
+    std::mutex printMutex;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&] {
+        std::vector<std::uint8_t> data;
+        for (std::size_t i = next++; i < files.size(); i = next++) {
+            ReplayResult r;
+            StateStreamWriter stream;
+            if (!loadReplayFile(files[i], data)) r.error = "cannot read file";
+            else r = playReplay(data.data(), data.size(), exportStream ? &stream : nullptr);
+            if (exportStream && r.valid) {
+                std::ofstream out(files[i] + ".tsst", std::ios::binary);
+                out.write(reinterpret_cast<const char*>(stream.bytes().data()), static_cast<std::streamsize>(stream.bytes().size()));
+                if (!out) {
+                    ++failures;
+                    std::fprintf(stderr, "cannot write %s.tsst\n", files[i].c_str());
+                }
+            }
+            ticks += r.ticks;
+            if (!r.matches) ++failures;
+            if (r.matches && quiet) continue;
+            std::lock_guard<std::mutex> lock(printMutex);
+            if (r.matches) {
+                std::printf("OK       %s  score %d lines %d level %d pieces %d\n", files[i].c_str(), r.score, r.lines, r.level, r.pieces);
+            } else if (!r.valid) {
+                std::printf("INVALID  %s  %s\n", files[i].c_str(), r.error.c_str());
+            } else {
+                std::printf("MISMATCH %s  score %d/%d lines %d/%d level %d/%d pieces %d/%d board %016llx/%016llx\n",
+                            files[i].c_str(), r.score, r.expectedScore, r.lines, r.expectedLines, r.level, r.expectedLevel,
+                            r.pieces, r.expectedPieces, static_cast<unsigned long long>(r.boardHash),
+                            static_cast<unsigned long long>(r.expectedBoardHash));
+            }
+        }
+    };
+
+    unsigned threads = std::max(1u, std::min(std::thread::hardware_concurrency(), static_cast<unsigned>(files.size())));
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for (auto &t : pool) t.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu replays, %d failed, %llu ticks in %.3f s (%.0f ticks/s)\n", files.size(), failures.load(),
+                static_cast<unsigned long long>(ticks.load()), seconds, seconds > 0 ? ticks.load() / seconds : 0.0);
+    return failures.load() ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// Plays many headless games in parallel and reports per-game and aggregate
+// statistics, for tuning scoring and gravity on large samples.
+//
+//   selfplay [--games N] [--threads T] [--seed S] [--policy random|greedy|scripted]
+//            [--script LLUH] [--max-pieces P] [--fps F] [--format csv|json] [--out file]
+//            [--randomizer bag7|uniform|history] [--stream K]
+//
+// Game i deals pieces from stream i of the master seed, so any single game of
+// a batch can be rerun on its own with --stream i and the same seed. Policies
+// enter one action per simulated frame, so gravity acts on them as it does on
+// a human player.
+#include "tetris/Policy.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+
+struct Options {
+    int games = 1000;
+    unsigned threads = 0;
+    std::uint64_t seed = 1;
+    std::string policy = "greedy";
+    std::string script = "H";
+    int maxPieces = 10000;
+    float fps = 60.0f;
+    bool json = false;
+    std::string out;
+    Randomizer randomizer = Randomizer::Bag7;
+    bool single = false; // play only game index `stream`
+    std::uint64_t stream = 0;
+};
+
+struct GameStats {
+    std::uint64_t index = 0;
+    int score = 0;
+    int lines = 0;
+    int level = 0;
+    int pieces = 0;
+    double gameTime = 0.0; // simulated seconds until game over or the piece cap
+    bool toppedOut = false;
+    double wallSeconds = 0.0;
+};
+
+bool parseArgs(int argc, char **argv, Options &opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (arg == "--games") opt.games = std::atoi(value);
+        else if (arg == "--threads") opt.threads = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--seed") opt.seed = std::strtoull(value, nullptr, 10);
+        else if (arg == "--policy") opt.policy = value;
+        else if (arg == "--script") opt.script = value;
+        else if (arg == "--max-pieces") opt.maxPieces = std::atoi(value);
+        else if (arg == "--fps") opt.fps = static_cast<float>(std::atof(value));
+        else if (arg == "--format") {
+            if (std::strcmp(value, "csv") != 0 && std::strcmp(value, "json") != 0) {
+                std::fprintf(stderr, "unknown format: %s\n", value);
+                return false;
+            }
+            opt.json = std::strcmp(value, "json") == 0;
+        }
+        else if (arg == "--out") opt.out = value;
+        else if (arg == "--randomizer") { if (!parseRandomizer(value, opt.randomizer)) return false; }
+        else if (arg == "--stream") {
+            char *end = nullptr;
+            errno = 0;
+            opt.stream = std::strtoull(value, &end, 10);
+            if (*value < '0' || *value > '9' || *end != '\0' || errno == ERANGE) return false;
+            opt.single = true;
+        }
+        else return false;
+        ++i;
+    }
+    return opt.games > 0 && opt.fps > 0.0f;
+}
+
+GameStats playOne(Policy &policy, std::uint64_t index, const Options &opt) {
+    auto start = std::chrono::steady_clock::now();
+    const float frame = 1.0f / opt.fps;
+    Engine engine(PieceGenerator(opt.seed, index, opt.randomizer));
+    policy.reseed(static_cast<std::uint32_t>(detail::splitmix64(opt.seed * 0x100000001B3ull + index)));
+    ActionPath path;
+    int planned = -1, cursor = 0;
+    while (engine.running() && engine.piecesPlaced() < opt.maxPieces) {
+        if (!engine.animating()) {
+            if (planned != engine.piecesPlaced()) {
+                policy.plan(engine, path);
+                planned = engine.piecesPlaced();
+                cursor = 0;
+            }
+            if (cursor < path.count) engine.step(path.actions[cursor++]);
+        }
+        engine.tick(frame);
+    }
+    GameStats s;
+    s.index = index;
+    s.score = engine.score();
+    s.lines = engine.lines();
+    s.level = engine.level();
+    s.pieces = engine.piecesPlaced();
+    s.gameTime = engine.elapsed();
+    s.toppedOut = !engine.running();
+    s.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return s;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt) || !makePolicy(opt.policy, 0, opt.script)) {
+        std::fprintf(stderr, "usage: selfplay [--games N] [--threads T] [--seed S] [--policy random|greedy|scripted]\n"
+                             "                [--script LLUH] [--max-pieces P] [--fps F] [--format csv|json] [--out file]\n"
+                             "                [--randomizer bag7|uniform|history] [--stream K]\n");
+        return 2;
+    }
+    if (opt.single) opt.games = 1;
+    const std::uint64_t firstIndex = opt.single ? opt.stream : 0;
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, static_cast<unsigned>(opt.games));
+
+    std::vector<GameStats> results(static_cast<std::size_t>(opt.games));
+    std::atomic<int> next{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            auto policy = makePolicy(opt.policy, 0, opt.script);
+            for (int i = next++; i < opt.games; i = next++)
+                results[static_cast<std::size_t>(i)] = playOne(*policy, firstIndex + static_cast<std::uint64_t>(i), opt);
+        });
+    }
+    for (auto &w : workers) w.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long totalScore = 0, totalLines = 0, totalLevel = 0, totalPieces = 0;
+    int maxScore = 0, toppedOut = 0;
+    double totalGameTime = 0.0;
+    for (const auto &r : results) {
+        totalScore += r.score;
+        totalLines += r.lines;
+        totalLevel += r.level;
+        totalPieces += r.pieces;
+        totalGameTime += r.gameTime;
+        maxScore = std::max(maxScore, r.score);
+        toppedOut += r.toppedOut;
+    }
+    const double n = static_cast<double>(opt.games);
+    const double gamesPerSecond = wall > 0 ? n / wall : 0.0;
+    const double piecesPerSecond = wall > 0 ? totalPieces / wall : 0.0;
+
+    FILE *out = opt.out.empty() ? stdout : std::fopen(opt.out.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", opt.out.c_str());
+        return 1;
+    }
+    if (opt.json) {
+        std::fprintf(out, "{\n  \"policy\": \"%s\", \"randomizer\": \"%s\", \"games\": %d, \"threads\": %u, \"seed\": %llu,\n",
+                     opt.policy.c_str(), randomizerName(opt.randomizer), opt.games, threads,
+                     static_cast<unsigned long long>(opt.seed));
+        std::fprintf(out, "  \"wall_seconds\": %.6f, \"games_per_second\": %.3f, \"pieces_per_second\": %.1f,\n",
+                     wall, gamesPerSecond, piecesPerSecond);
+        std::fprintf(out, "  \"mean_score\": %.2f, \"max_score\": %d, \"mean_lines\": %.2f, \"mean_level\": %.3f,\n",
+                     totalScore / n, maxScore, totalLines / n, totalLevel / n);
+        std::fprintf(out, "  \"mean_pieces\": %.2f, \"mean_game_time\": %.3f, \"topped_out\": %d,\n",
+                     totalPieces / n, totalGameTime / n, toppedOut);
+        std::fprintf(out, "  \"per_game\": [\n");
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto &r = results[i];
+            std::fprintf(out, "    {\"index\": %llu, \"score\": %d, \"lines\": %d, \"level\": %d, \"pieces\": %d, "
+                              "\"game_time\": %.3f, \"topped_out\": %s, \"wall_seconds\": %.6f}%s\n",
+                         static_cast<unsigned long long>(r.index), r.score, r.lines, r.level, r.pieces, r.gameTime, r.toppedOut ? "true" : "false",
+                         r.wallSeconds, i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    } else {
+        std::fprintf(out, "index,score,lines,level,pieces,game_time,topped_out,wall_seconds\n");
+        for (const auto &r : results) {
+            std::fprintf(out, "%llu,%d,%d,%d,%d,%.3f,%d,%.6f\n", static_cast<unsigned long long>(r.index), r.score, r.lines, r.level, r.pieces,
+                         r.gameTime, r.toppedOut ? 1 : 0, r.wallSeconds);
+        }
+    }
+    if (out != stdout) std::fclose(out);
+
+    std::fprintf(stderr, "%s: %d games on %u threads in %.3f s: %.1f games/s, %.0f pieces/s, mean score %.0f, mean lines %.1f\n",
+                 opt.policy.c_str(), opt.games, threads, wall, gamesPerSecond, piecesPerSecond, totalScore / n, totalLines / n);
+    return 0;
+}
@@ -0,0 +1,465 @@
+// Hosts many independent games in one process over TCP or a Unix socket.
+//
+//   server [--port P | --unix path] [--shards N] [--hz H] [--stats seconds] [--max-sessions N]
+//
+// Each shard is one thread with its own epoll loop, tick timer and sessions.
+// All shards wait on the listening socket with EPOLLEXCLUSIVE, so the kernel
+// hands every new connection to one of them; after that a session is only
+// ever touched by its shard and nothing is locked. Inputs (see Protocol.hpp)
+// are applied as soon as they are read, games advance on the shard's fixed
+// tick, and every session whose game changed gets one State per tick.
+// Sessions per shard and tick-latency percentiles are printed periodically.
+#include "net_common.hpp"
+#include "tetris/LatencyHistogram.hpp"
+#include "tetris/Protocol.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <memory>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    net::Endpoint endpoint;
+    unsigned shards = 0;
+    int hz = 60;
+    double statsSeconds = 5.0;
+    std::size_t maxSessions = 100000;
+};
+
+std::atomic<bool> g_stop{false};
+
+void onSignal(int) { g_stop.store(true); }
+
+struct Session {
+    int fd = -1;
+    std::size_t index = 0; // position in Shard::sessions
+    Engine engine;
+    bool started = false;
+    bool dirty = false;     // send a State at the end of this tick
+    bool rowsDirty = false; // include the board rows
+    bool writing = false;   // EPOLLOUT is armed
+    bool closing = false;
+    Events events = events::None;
+    std::uint16_t ack = 0;
+    std::size_t inLength = 0;
+    std::array<std::uint8_t, 512> in;
+    std::size_t outBegin = 0, outEnd = 0;
+    std::array<std::uint8_t, 4096> out; // a client this far behind is dropped
+};
+
+// Written by one shard, read by the reporting thread.
+struct alignas(64) ShardStats {
+    std::atomic<std::uint32_t> sessions{0};
+    std::atomic<std::uint64_t> accepted{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> ticks{0};
+    std::atomic<std::uint64_t> missedTicks{0};
+    std::atomic<std::uint64_t> inputs{0};
+    std::atomic<std::uint64_t> states{0};
+    std::atomic<std::uint64_t> bytesOut{0};
+    LatencyHistogram tickMicros; // time to advance and send all sessions of one tick
+    LatencyHistogram lateMicros; // how late the tick started
+};
+
+template <typename T>
+void bump(std::atomic<T> &counter, T by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+class Shard {
+public:
+    Shard(int listenFd, bool tcp, const Options &opt, std::size_t maxSessions, ShardStats &stats)
+        : m_listenFd(listenFd), m_tcp(tcp), m_opt(opt), m_maxSessions(maxSessions), m_stats(stats) {}
+
+    void run();
+
+private:
+    void acceptAll();
+    void readFrom(Session &s);
+    void handle(Session &s, const protocol::Message &msg);
+    void tick(std::uint64_t expirations);
+    void queue(Session &s, const std::uint8_t *data, std::size_t size);
+    void flush(Session &s);
+    void close(Session &s);
+    void reap();
+    void setWriting(Session &s, bool on);
+
+    int m_listenFd;
+    bool m_tcp;
+    const Options &m_opt;
+    std::size_t m_maxSessions;
+    ShardStats &m_stats;
+    int m_epoll = -1;
+    int m_timer = -1;
+    std::uint32_t m_tick = 0;
+    Clock::time_point m_due;
+    std::vector<std::unique_ptr<Session>> m_sessions;
+    std::vector<Session*> m_closed;
+};
+
+// epoll user data for the two descriptors that are not sessions
+char g_listenTag, g_timerTag;
+
+void Shard::run() {
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    m_timer = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    const long periodNs = 1000000000L / m_opt.hz;
+    itimerspec spec{};
+    spec.it_interval.tv_nsec = periodNs;
+    spec.it_value.tv_nsec = periodNs;
+    ::timerfd_settime(m_timer, 0, &spec, nullptr);
+    m_due = Clock::now() + std::chrono::nanoseconds(periodNs);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.ptr = &g_listenTag;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listenFd, &ev);
+    ev.events = EPOLLIN;
+    ev.data.ptr = &g_timerTag;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_timer, &ev);
+
+    std::array<epoll_event, 256> ready;
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        int n = ::epoll_wait(m_epoll, ready.data(), static_cast<int>(ready.size()), 200);
+        for (int i = 0; i < n; ++i) {
+            void *tag = ready[i].data.ptr;
+            if (tag == &g_listenTag) {
+                acceptAll();
+            } else if (tag == &g_timerTag) {
+                std::uint64_t expirations = 0;
+                if (::read(m_timer, &expirations, sizeof(expirations)) == sizeof(expirations)) tick(expirations);
+            } else {
+                Session &s = *static_cast<Session*>(tag);
+                if (s.closing) continue;
+                if (ready[i].events & (EPOLLERR | EPOLLHUP)) { close(s); continue; }
+                if (ready[i].events & EPOLLIN) readFrom(s);
+                if (!s.closing && (ready[i].events & EPOLLOUT)) flush(s);
+            }
+        }
+        reap();
+    }
+    for (auto &s : m_sessions) ::close(s->fd);
+    ::close(m_timer);
+    ::close(m_epoll);
+}
+
+void Shard::acceptAll() {
+    for (;;) {
+        int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN: another shard took it, or the queue is empty
+        if (m_sessions.size() >= m_maxSessions) {
+            ::close(fd);
+            bump(m_stats.dropped, std::uint64_t{1});
+            continue;
+        }
+        if (m_tcp) net::setNoDelay(fd);
+        auto session = std::make_unique<Session>();
+        session->fd = fd;
+        session->index = m_sessions.size();
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = session.get();
+        if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        m_sessions.push_back(std::move(session));
+        bump(m_stats.accepted, std::uint64_t{1});
+        m_stats.sessions.store(static_cast<std::uint32_t>(m_sessions.size()), std::memory_order_relaxed);
+    }
+}
+
+void Shard::readFrom(Session &s) {
+    for (;;) {
+        ssize_t got = ::recv(s.fd, s.in.data() + s.inLength, s.in.size() - s.inLength, 0);
+        if (got == 0) { close(s); return; }
+        if (got < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) close(s);
+            return;
+        }
+        s.inLength += static_cast<std::size_t>(got);
+        std::size_t pos = 0;
+        protocol::Message msg;
+        for (;;) {
+            int used = protocol::decode(s.in.data() + pos, s.inLength - pos, msg);
+            if (used < 0) { close(s); return; }
+            if (used == 0) break;
+            handle(s, msg);
+            pos += static_cast<std::size_t>(used);
+        }
+        std::memmove(s.in.data(), s.in.data() + pos, s.inLength - pos);
+        s.inLength -= pos;
+    }
+}
+
+void Shard::handle(Session &s, const protocol::Message &msg) {
+    if (msg.type == protocol::MsgType::Start) {
+        s.engine.reset(PieceGenerator(msg.start.seed, msg.start.stream, msg.start.randomizer));
+        s.started = true;
+        s.dirty = s.rowsDirty = true;
+        s.events |= events::Spawned;
+    } else if (msg.type == protocol::MsgType::Input && s.started) {
+        Events ev = s.engine.step(msg.input.action);
+        s.ack = msg.input.seq;
+        s.events |= ev;
+        s.dirty = true;
+        if (ev & (events::Locked | events::LinesRemoved)) s.rowsDirty = true;
+        bump(m_stats.inputs, std::uint64_t{1});
+    }
+}
+
+void Shard::tick(std::uint64_t expirations) {
+    const auto start = Clock::now();
+    m_stats.lateMicros.add(static_cast<std::uint64_t>(
+        std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(start - m_due).count())));
+    const auto period = std::chrono::nanoseconds(1000000000L / m_opt.hz);
+    m_due += period * static_cast<std::int64_t>(expirations);
+    if (expirations > 1) bump(m_stats.missedTicks, expirations - 1);
+
+    // a late timer runs the missed ticks back to back, so games keep real time
+    const float dt = 1.0f / static_cast<float>(m_opt.hz);
+    for (std::uint64_t e = 0; e < expirations; ++e) {
+        ++m_tick;
+        for (auto &ptr : m_sessions) {
+            Session &s = *ptr;
+            if (!s.started || !s.engine.running()) continue;
+            Events ev = s.engine.tick(dt);
+            if (ev == events::None) continue;
+            s.events |= ev;
+            s.dirty = true;
+            if (ev & (events::Locked | events::LinesRemoved)) s.rowsDirty = true;
+        }
+    }
+
+    std::uint8_t buf[protocol::MaxMessageSize];
+    protocol::State state;
+    std::uint64_t states = 0;
+    for (auto &ptr : m_sessions) {
+        Session &s = *ptr;
+        if (!s.dirty || s.closing) continue;
+        protocol::describe(s.engine, s.rowsDirty, state);
+        state.tick = m_tick;
+        state.events = s.events;
+        state.ack = s.ack;
+        queue(s, buf, protocol::encode(state, buf));
+        if (s.events & events::GameOver) {
+            protocol::GameOver over{state.score, state.lines, static_cast<std::uint32_t>(s.engine.piecesPlaced())};
+            queue(s, buf, protocol::encode(over, buf));
+        }
+        s.dirty = s.rowsDirty = false;
+        s.events = events::None;
+        ++states;
+        if (!s.writing && !s.closing) flush(s);
+    }
+    bump(m_stats.states, states);
+    bump(m_stats.ticks, expirations);
+    m_stats.tickMicros.add(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()));
+}
+
+void Shard::queue(Session &s, const std::uint8_t *data, std::size_t size) {
+    if (s.closing) return;
+    if (s.outEnd + size > s.out.size()) {
+        std::memmove(s.out.data(), s.out.data() + s.outBegin, s.outEnd - s.outBegin);
+        s.outEnd -= s.outBegin;
+        s.outBegin = 0;
+        if (s.outEnd + size > s.out.size()) {
+            close(s); // not reading its updates
+            bump(m_stats.dropped, std::uint64_t{1});
+            return;
+        }
+    }
+    std::memcpy(s.out.data() + s.outEnd, data, size);
+    s.outEnd += size;
+}
+
+void Shard::flush(Session &s) {
+    while (s.outBegin < s.outEnd) {
+        ssize_t sent = ::send(s.fd, s.out.data() + s.outBegin, s.outEnd - s.outBegin, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) { setWriting(s, true); return; }
+            if (errno == EINTR) continue;
+            close(s);
+            return;
+        }
+        s.outBegin += static_cast<std::size_t>(sent);
+        bump(m_stats.bytesOut, static_cast<std::uint64_t>(sent));
+    }
+    s.outBegin = s.outEnd = 0;
+    setWriting(s, false);
+}
+
+void Shard::setWriting(Session &s, bool on) {
+    if (s.writing == on) return;
+    s.writing = on;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | (on ? EPOLLOUT : 0u);
+    ev.data.ptr = &s;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, s.fd, &ev);
+}
+
+// Closed sessions stay allocated until the end of the event batch, since
+// later events of the same batch may still point at them.
+void Shard::close(Session &s) {
+    if (s.closing) return;
+    s.closing = true;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, s.fd, nullptr);
+    ::close(s.fd);
+    m_closed.push_back(&s);
+}
+
+void Shard::reap() {
+    for (Session *s : m_closed) {
+        std::size_t i = s->index;
+        std::swap(m_sessions[i], m_sessions.back());
+        m_sessions[i]->index = i;
+        m_sessions.pop_back();
+    }
+    if (!m_closed.empty()) m_stats.sessions.store(static_cast<std::uint32_t>(m_sessions.size()), std::memory_order_relaxed);
+    m_closed.clear();
+}
+
+int listenOn(const net::Endpoint &ep) {
+    sockaddr_storage addr;
+    socklen_t len = net::address(ep, addr);
+    if (!len) return -1;
+    int fd = net::openSocket(ep);
+    if (fd < 0) return -1;
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (!ep.unixPath.empty()) ::unlink(ep.unixPath.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), len) != 0 || ::listen(fd, 4096) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool parseArgs(int argc, char **argv, Options &opt) {
+    opt.endpoint.host = "0.0.0.0";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) return false;
+        if (arg == "--port") opt.endpoint.port = std::atoi(value);
+        else if (arg == "--unix") opt.endpoint.unixPath = value;
+        else if (arg == "--shards") opt.shards = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--hz") opt.hz = std::atoi(value);
+        else if (arg == "--stats") opt.statsSeconds = std::atof(value);
+        else if (arg == "--max-sessions") opt.maxSessions = static_cast<std::size_t>(std::atoll(value));
+        else return false;
+        ++i;
+    }
+    return opt.hz > 1 && opt.hz <= 1000 && opt.statsSeconds > 0 && opt.maxSessions > 0;
+}
+
+struct Snapshot {
+    std::uint64_t ticks = 0, inputs = 0, states = 0, bytesOut = 0;
+    LatencyHistogram::Counts tick{}, late{};
+};
+
+Snapshot read(const ShardStats &s) {
+    Snapshot out;
+    out.ticks = s.ticks.load(std::memory_order_relaxed);
+    out.inputs = s.inputs.load(std::memory_order_relaxed);
+    out.states = s.states.load(std::memory_order_relaxed);
+    out.bytesOut = s.bytesOut.load(std::memory_order_relaxed);
+    out.tick = s.tickMicros.counts();
+    out.late = s.lateMicros.counts();
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: server [--port P | --unix path] [--shards N] [--hz H] [--stats seconds] [--max-sessions N]\n");
+        return 2;
+    }
+    unsigned shards = opt.shards ? opt.shards : std::max(1u, std::thread::hardware_concurrency());
+    long files = net::raiseFileLimit();
+    int listenFd = listenOn(opt.endpoint);
+    if (listenFd < 0) {
+        std::fprintf(stderr, "server: cannot listen on %s: %s\n",
+                     opt.endpoint.unixPath.empty() ? std::to_string(opt.endpoint.port).c_str() : opt.endpoint.unixPath.c_str(),
+                     std::strerror(errno));
+        return 1;
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::printf("listening on %s with %u shards at %d Hz (file limit %ld)\n",
+                opt.endpoint.unixPath.empty() ? ("port " + std::to_string(opt.endpoint.port)).c_str() : opt.endpoint.unixPath.c_str(),
+                shards, opt.hz, files);
+    std::fflush(stdout);
+
+    const std::size_t perShard = (opt.maxSessions + shards - 1) / shards;
+    std::vector<std::unique_ptr<ShardStats>> stats;
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < shards; ++i) {
+        stats.push_back(std::make_unique<ShardStats>());
+        threads.emplace_back([&, i] {
+            Shard(listenFd, opt.endpoint.unixPath.empty(), opt, perShard, *stats[i]).run();
+        });
+    }
+
+    std::vector<Snapshot> before(shards);
+    auto last = Clock::now();
+    const auto startTime = last;
+    while (!g_stop.load()) {
+        auto wake = last + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.statsSeconds));
+        while (!g_stop.load() && Clock::now() < wake) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        last = now;
+        std::uint32_t total = 0;
+        LatencyHistogram::Counts allTicks{};
+        std::printf("[%7.1f s]\n", std::chrono::duration<double>(now - startTime).count());
+        for (unsigned i = 0; i < shards; ++i) {
+            Snapshot cur = read(*stats[i]);
+            auto ticks = LatencyHistogram::difference(cur.tick, before[i].tick);
+            auto late = LatencyHistogram::difference(cur.late, before[i].late);
+            for (int b = 0; b < LatencyHistogram::Buckets; ++b) allTicks[b] += ticks[b];
+            std::uint32_t sessions = stats[i]->sessions.load(std::memory_order_relaxed);
+            total += sessions;
+            std::printf("  shard %2u: %6u sessions  tick p50 %5llu us p99 %6llu us max %6llu us  late p99 %6llu us"
+                        "  %7.0f inputs/s %7.0f states/s %8.1f KB/s out\n",
+                        i, sessions,
+                        static_cast<unsigned long long>(LatencyHistogram::percentile(ticks, 50)),
+                        static_cast<unsigned long long>(LatencyHistogram::percentile(ticks, 99)),
+                        static_cast<unsigned long long>(LatencyHistogram::percentile(ticks, 100)),
+                        static_cast<unsigned long long>(LatencyHistogram::percentile(late, 99)),
+                        static_cast<double>(cur.inputs - before[i].inputs) / seconds,
+                        static_cast<double>(cur.states - before[i].states) / seconds,
+                        static_cast<double>(cur.bytesOut - before[i].bytesOut) / seconds / 1024.0);
+            before[i] = cur;
+        }
+        std::uint64_t missed = 0, dropped = 0;
+        for (auto &s : stats) {
+            missed += s->missedTicks.load(std::memory_order_relaxed);
+            dropped += s->dropped.load(std::memory_order_relaxed);
+        }
+        std::printf("  total %u sessions (%.0f per core), tick p50 %llu us p99 %llu us, %llu missed ticks, %llu dropped\n",
+                    total, static_cast<double>(total) / shards,
+                    static_cast<unsigned long long>(LatencyHistogram::percentile(allTicks, 50)),
+                    static_cast<unsigned long long>(LatencyHistogram::percentile(allTicks, 99)),
+                    static_cast<unsigned long long>(missed), static_cast<unsigned long long>(dropped));
+        std::fflush(stdout);
+    }
+    for (auto &t : threads) t.join();
+    ::close(listenFd);
+    if (!opt.endpoint.unixPath.empty()) ::unlink(opt.endpoint.unixPath.c_str());
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "../../include/tetris/AllocCounter.hpp"
+
+#ifdef TETRIS_ALLOC_COUNTER
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return ::operator new(size, tag); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t&) noexcept { std::free(p); }
+
+bool tetris::allocationCounterEnabled() { return true; }
+std::uint64_t tetris::allocationCount() { return g_allocations.load(std::memory_order_relaxed); }
+
+#else
+
+bool tetris::allocationCounterEnabled() { return false; }
+std::uint64_t tetris::allocationCount() { return 0; }
+
+#endif
@@ -0,0 +1,156 @@
+#include "../../include/tetris/AssetBundle.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace tetris;
+
+static const char Magic[4] = {'T', 'P', 'A', 'K'};
+static constexpr std::size_t DataAlignment = 16;
+
+static std::uint64_t readLE(const std::uint8_t *p, int bytes) {
+    std::uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+static void putLE(std::vector<std::uint8_t> &out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+AssetBundle::~AssetBundle() { close(); }
+
+bool AssetBundle::open(const std::string &path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { CloseHandle(file); return false; }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { CloseHandle(file); return false; }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(mapping); CloseHandle(file); return false; }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+    void *view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file alive
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(st.st_size);
+#endif
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetBundle::close() {
+    m_entries.clear();
+    if (!m_data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    CloseHandle(static_cast<HANDLE>(m_file));
+    m_mapping = m_file = nullptr;
+#else
+    munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool AssetBundle::parse() {
+    if (m_size < 12 || std::memcmp(m_data, Magic, 4) != 0) return false;
+    if (readLE(m_data + 4, 4) != Version) return false;
+    std::uint64_t count = readLE(m_data + 8, 4);
+    std::size_t pos = 12;
+    m_entries.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, 4096)));
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (m_size - pos < 2) return false;
+        std::size_t nameLength = static_cast<std::size_t>(readLE(m_data + pos, 2));
+        pos += 2;
+        if (m_size - pos < nameLength + 16) return false;
+        Entry entry;
+        entry.name.assign(reinterpret_cast<const char*>(m_data + pos), nameLength);
+        pos += nameLength;
+        std::uint64_t offset = readLE(m_data + pos, 8);
+        std::uint64_t size = readLE(m_data + pos + 8, 8);
+        pos += 16;
+        if (offset > m_size || size > m_size - offset) return false;
+        entry.view = View{m_data + offset, static_cast<std::size_t>(size)};
+        m_entries.push_back(std::move(entry));
+    }
+    return std::is_sorted(m_entries.begin(), m_entries.end(),
+                          [](const Entry &a, const Entry &b) { return a.name < b.name; });
+}
+
+AssetBundle::View AssetBundle::find(const std::string &name) const {
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name,
+                               [](const Entry &e, const std::string &n) { return e.name < n; });
+    if (it == m_entries.end() || it->name != name) return View{};
+    return it->view;
+}
+
+int tetris::writeAssetBundle(const std::string &directory, const std::string &path) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (const auto &entry : fs::directory_iterator(directory, ec))
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    if (ec) return -1;
+    std::sort(files.begin(), files.end(),
+              [](const fs::path &a, const fs::path &b) { return a.filename().string() < b.filename().string(); });
+
+    std::vector<std::vector<std::uint8_t>> contents(files.size());
+    std::vector<std::uint8_t> out(Magic, Magic + 4);
+    putLE(out, AssetBundle::Version, 4);
+    putLE(out, files.size(), 4);
+    std::size_t indexSize = out.size();
+    for (const auto &file : files) indexSize += 2 + file.filename().string().size() + 16;
+
+    std::uint64_t offset = indexSize;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::ifstream in(files[i], std::ios::binary);
+        if (!in) return -1;
+        contents[i].assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        std::string name = files[i].filename().string();
+        offset = (offset + DataAlignment - 1) / DataAlignment * DataAlignment;
+        putLE(out, name.size(), 2);
+        out.insert(out.end(), name.begin(), name.end());
+        putLE(out, offset, 8);
+        putLE(out, contents[i].size(), 8);
+        offset += contents[i].size();
+    }
+    for (const auto &data : contents) {
+        out.resize((out.size() + DataAlignment - 1) / DataAlignment * DataAlignment, 0);
+        out.insert(out.end(), data.begin(), data.end());
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()))) return -1;
+    return static_cast<int>(files.size());
+}
@@ -0,0 +1,62 @@
+#include "../../include/tetris/Assets.hpp"
+#include <chrono>
+
+using namespace tetris;
+
+static const char *const SfxFiles[SfxCount] = {
+    "clear.wav", "rotate.wav", "drop.wav", "harddrop.wav", "ui_click.wav", "voice_levelup.wav"
+};
+
+// A font shipped in the assets directory wins over the system fonts.
+static const char *const SystemFonts[] = {
+    "C:/Windows/Fonts/arial.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/System/Library/Fonts/Supplemental/Arial.ttf",
+};
+
+const char* tetris::sfxFileName(Sfx sfx) {
+    return SfxFiles[static_cast<int>(sfx)];
+}
+
+GameAssets tetris::loadGameAssets(const std::string &bundlePath, const std::string &directory) {
+    auto start = std::chrono::steady_clock::now();
+    GameAssets assets;
+    assets.bundle = std::make_unique<AssetBundle>();
+    if (!assets.bundle->open(bundlePath)) assets.bundle.reset();
+    auto fromBundle = [&](const char *name) {
+        return assets.bundle ? assets.bundle->find(name) : AssetBundle::View{};
+    };
+
+    // fonts opened from memory keep pointing into the mapping: no copy
+    auto font = std::make_unique<sf::Font>();
+    bool fontLoaded = false;
+    if (AssetBundle::View view = fromBundle("font.ttf")) {
+        fontLoaded = font->openFromMemory(view.data, view.size);
+        assets.fromBundle += fontLoaded;
+    }
+    if (!fontLoaded) {
+        fontLoaded = font->openFromFile(directory + "/font.ttf");
+        for (const char *path : SystemFonts) {
+            if (fontLoaded) break;
+            fontLoaded = font->openFromFile(path);
+        }
+        assets.fromFiles += fontLoaded;
+    }
+    if (fontLoaded) assets.font = std::move(font);
+
+    for (int i = 0; i < SfxCount; ++i) {
+        auto buffer = std::make_unique<sf::SoundBuffer>();
+        AssetBundle::View view = fromBundle(SfxFiles[i]);
+        if (view && buffer->loadFromMemory(view.data, view.size)) {
+            ++assets.fromBundle;
+        } else if (buffer->loadFromFile(directory + "/" + SfxFiles[i])) {
+            ++assets.fromFiles;
+        } else {
+            continue;
+        }
+        assets.sounds[i] = std::move(buffer);
+    }
+
+    assets.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return assets;
+}
@@ -0,0 +1,34 @@
+#include "../../include/tetris/AutoRepeat.hpp"
+
+using namespace tetris;
+
+void AutoRepeat::press() {
+    m_held = true;
+    m_repeating = false;
+    m_timer = 0;
+}
+
+void AutoRepeat::release() {
+    m_held = false;
+    m_repeating = false;
+    m_timer = 0;
+}
+
+int AutoRepeat::advance(std::uint32_t micros) {
+    if (!m_held) return 0;
+    m_timer += micros;
+    if (!m_repeating) {
+        if (m_timer < m_timing.delay) return 0;
+        // the first repeat fires when the delay runs out
+        m_repeating = true;
+        m_timer -= m_timing.delay;
+        if (m_timing.interval == 0) return Instant;
+        int count = 1 + static_cast<int>(m_timer / m_timing.interval);
+        m_timer %= m_timing.interval;
+        return count;
+    }
+    if (m_timing.interval == 0) return Instant;
+    int count = static_cast<int>(m_timer / m_timing.interval);
+    m_timer %= m_timing.interval;
+    return count;
+}
@@ -0,0 +1,140 @@
+#include "batch_kernel.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TETRIS_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+using namespace tetris;
+
+#ifdef TETRIS_HAVE_SSE2
+namespace {
+
+// Eight boards per register.
+struct Sse2Lanes {
+    static constexpr int Lanes = 8;
+    __m128i v;
+
+    explicit Sse2Lanes(__m128i x) : v(x) {}
+    explicit Sse2Lanes(unsigned x) : v(_mm_set1_epi16(static_cast<short>(x))) {}
+    static Sse2Lanes load(const std::uint16_t *p) { return Sse2Lanes(_mm_load_si128(reinterpret_cast<const __m128i*>(p))); }
+    static Sse2Lanes load(const std::int16_t *p) { return Sse2Lanes(_mm_load_si128(reinterpret_cast<const __m128i*>(p))); }
+    void store(std::int16_t *p) const { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+    static Sse2Lanes isZero(Sse2Lanes a) { return Sse2Lanes(_mm_cmpeq_epi16(a.v, _mm_setzero_si128())); }
+    friend Sse2Lanes operator&(Sse2Lanes a, Sse2Lanes b) { return Sse2Lanes(_mm_and_si128(a.v, b.v)); }
+    friend Sse2Lanes operator|(Sse2Lanes a, Sse2Lanes b) { return Sse2Lanes(_mm_or_si128(a.v, b.v)); }
+    friend Sse2Lanes operator^(Sse2Lanes a, Sse2Lanes b) { return Sse2Lanes(_mm_xor_si128(a.v, b.v)); }
+    friend Sse2Lanes operator~(Sse2Lanes a) { return Sse2Lanes(_mm_xor_si128(a.v, _mm_set1_epi32(-1))); }
+    friend Sse2Lanes operator+(Sse2Lanes a, Sse2Lanes b) { return Sse2Lanes(_mm_add_epi16(a.v, b.v)); }
+    friend Sse2Lanes operator-(Sse2Lanes a, Sse2Lanes b) { return Sse2Lanes(_mm_sub_epi16(a.v, b.v)); }
+    friend Sse2Lanes operator<<(Sse2Lanes a, int n) { return Sse2Lanes(_mm_slli_epi16(a.v, n)); }
+    friend Sse2Lanes operator>>(Sse2Lanes a, int n) { return Sse2Lanes(_mm_srli_epi16(a.v, n)); }
+};
+
+// Four scores per register.
+struct Sse2Floats {
+    static constexpr int Lanes = 4;
+    __m128 v;
+
+    explicit Sse2Floats(__m128 x) : v(x) {}
+    explicit Sse2Floats(float x) : v(_mm_set1_ps(x)) {}
+    static Sse2Floats load(const std::int16_t *p) {
+        __m128i words = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        // Sign-extend to 32 bits: words into the high halves, shift back down
+        __m128i ints = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        return Sse2Floats(_mm_cvtepi32_ps(ints));
+    }
+    void store(float *p) const { _mm_store_ps(p, v); }
+    friend Sse2Floats operator+(Sse2Floats a, Sse2Floats b) { return Sse2Floats(_mm_add_ps(a.v, b.v)); }
+    friend Sse2Floats operator*(Sse2Floats a, Sse2Floats b) { return Sse2Floats(_mm_mul_ps(a.v, b.v)); }
+};
+
+} // namespace
+#endif
+
+namespace {
+
+bool cpuHasAvx2() {
+#if !defined(TETRIS_HAVE_AVX2)
+    return false;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osSavesYmm = (regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(regs, 7, 0);
+    return osSavesYmm && (regs[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+const char* tetris::simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE2: return "sse2";
+    case SimdLevel::AVX2: return "avx2";
+    default: return "auto";
+    }
+}
+
+bool tetris::simdLevelSupported(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return true;
+    case SimdLevel::SSE2:
+#ifdef TETRIS_HAVE_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case SimdLevel::AVX2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+    default:
+        return false;
+    }
+}
+
+SimdLevel tetris::bestSimdLevel() {
+    if (simdLevelSupported(SimdLevel::AVX2)) return SimdLevel::AVX2;
+    if (simdLevelSupported(SimdLevel::SSE2)) return SimdLevel::SSE2;
+    return SimdLevel::Scalar;
+}
+
+const char* tetris::featureName(int feature) {
+    static const char *const Names[FeatureCount] = {"aggregateHeight", "maxHeight", "holes", "bumpiness",
+                                                    "rowTransitions", "wellDepth", "completeLines"};
+    return feature >= 0 && feature < FeatureCount ? Names[feature] : "?";
+}
+
+BatchEvaluator::BatchEvaluator(const EvalWeights &weights, SimdLevel level) : m_weights(weights), m_level(level) {
+    if (m_level == SimdLevel::Auto) m_level = bestSimdLevel();
+    while (!simdLevelSupported(m_level)) m_level = static_cast<SimdLevel>(static_cast<int>(m_level) - 1);
+}
+
+void BatchEvaluator::evaluate(const BoardBatch &batch, BatchResult &out) const {
+    switch (m_level) {
+#ifdef TETRIS_HAVE_AVX2
+    case SimdLevel::AVX2:
+        detail::evaluateBatchAvx2(batch, m_weights, out);
+        return;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case SimdLevel::SSE2:
+        evaluateLanes<Sse2Lanes, Sse2Floats>(batch, m_weights, out);
+        return;
+#endif
+    default:
+        evaluateLanes<ScalarLanes, ScalarFloats>(batch, m_weights, out);
+        return;
+    }
+}
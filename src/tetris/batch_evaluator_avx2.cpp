@@ -0,0 +1,51 @@
+// AVX2 build of the batch evaluator kernels. CMake compiles only this file
+// with AVX2 enabled; BatchEvaluator calls into it after checking the CPU.
+#include "batch_kernel.hpp"
+#include <immintrin.h>
+
+using namespace tetris;
+
+namespace {
+
+// Sixteen boards per register.
+struct Avx2Lanes {
+    static constexpr int Lanes = 16;
+    __m256i v;
+
+    explicit Avx2Lanes(__m256i x) : v(x) {}
+    explicit Avx2Lanes(unsigned x) : v(_mm256_set1_epi16(static_cast<short>(x))) {}
+    static Avx2Lanes load(const std::uint16_t *p) { return Avx2Lanes(_mm256_load_si256(reinterpret_cast<const __m256i*>(p))); }
+    static Avx2Lanes load(const std::int16_t *p) { return Avx2Lanes(_mm256_load_si256(reinterpret_cast<const __m256i*>(p))); }
+    void store(std::int16_t *p) const { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Avx2Lanes isZero(Avx2Lanes a) { return Avx2Lanes(_mm256_cmpeq_epi16(a.v, _mm256_setzero_si256())); }
+    friend Avx2Lanes operator&(Avx2Lanes a, Avx2Lanes b) { return Avx2Lanes(_mm256_and_si256(a.v, b.v)); }
+    friend Avx2Lanes operator|(Avx2Lanes a, Avx2Lanes b) { return Avx2Lanes(_mm256_or_si256(a.v, b.v)); }
+    friend Avx2Lanes operator^(Avx2Lanes a, Avx2Lanes b) { return Avx2Lanes(_mm256_xor_si256(a.v, b.v)); }
+    friend Avx2Lanes operator~(Avx2Lanes a) { return Avx2Lanes(_mm256_xor_si256(a.v, _mm256_set1_epi32(-1))); }
+    friend Avx2Lanes operator+(Avx2Lanes a, Avx2Lanes b) { return Avx2Lanes(_mm256_add_epi16(a.v, b.v)); }
+    friend Avx2Lanes operator-(Avx2Lanes a, Avx2Lanes b) { return Avx2Lanes(_mm256_sub_epi16(a.v, b.v)); }
+    friend Avx2Lanes operator<<(Avx2Lanes a, int n) { return Avx2Lanes(_mm256_slli_epi16(a.v, n)); }
+    friend Avx2Lanes operator>>(Avx2Lanes a, int n) { return Avx2Lanes(_mm256_srli_epi16(a.v, n)); }
+};
+
+// Eight scores per register.
+struct Avx2Floats {
+    static constexpr int Lanes = 8;
+    __m256 v;
+
+    explicit Avx2Floats(__m256 x) : v(x) {}
+    explicit Avx2Floats(float x) : v(_mm256_set1_ps(x)) {}
+    static Avx2Floats load(const std::int16_t *p) {
+        __m128i words = _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+        return Avx2Floats(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(words)));
+    }
+    void store(float *p) const { _mm256_store_ps(p, v); }
+    friend Avx2Floats operator+(Avx2Floats a, Avx2Floats b) { return Avx2Floats(_mm256_add_ps(a.v, b.v)); }
+    friend Avx2Floats operator*(Avx2Floats a, Avx2Floats b) { return Avx2Floats(_mm256_mul_ps(a.v, b.v)); }
+};
+
+} // namespace
+
+void tetris::detail::evaluateBatchAvx2(const BoardBatch &batch, const EvalWeights &weights, BatchResult &out) {
+    evaluateLanes<Avx2Lanes, Avx2Floats>(batch, weights, out);
+}
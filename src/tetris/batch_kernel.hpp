@@ -0,0 +1,112 @@
+// Feature and score kernels of BatchEvaluator, written once over a lane
+// type. Each translation unit that includes this gets its own copy, built
+// for that file's instruction set (the AVX2 one is compiled with -mavx2).
+#pragma once
+
+#include "../../include/tetris/BatchEvaluator.hpp"
+
+namespace tetris {
+namespace detail {
+
+// BatchEvaluator::evaluate for AVX2, in batch_evaluator_avx2.cpp; only
+// built for x86 targets (TETRIS_HAVE_AVX2).
+void evaluateBatchAvx2(const BoardBatch &batch, const EvalWeights &weights, BatchResult &out);
+
+} // namespace detail
+
+namespace {
+
+// Count set bits of every 16-bit lane.
+template <typename V>
+inline V popcount16(V x) {
+    x = x - ((x >> 1) & V(0x5555));
+    x = (x & V(0x3333)) + ((x >> 2) & V(0x3333));
+    x = (x + (x >> 4)) & V(0x0F0F);
+    return (x + (x >> 8)) & V(0x001F);
+}
+
+// Features of boards [first, first + V::Lanes), one board per lane. V holds
+// 16-bit lanes with &, |, ^, +, -, shifts, load/store and isZero (all ones
+// where the lane is 0).
+template <typename V>
+inline void featureKernel(const BoardBatch &batch, int first, BatchResult &out) {
+    constexpr std::uint16_t Walls = 1u | (1u << (BoardWidth + 1));
+    constexpr std::uint16_t Pairs = (1u << (BoardWidth - 1)) - 1;     // neighboring columns
+    constexpr std::uint16_t WalledPairs = (1u << (BoardWidth + 1)) - 1; // including both walls
+    const V full(Board::FullRow);
+    V seen(0), aggregate(0), maxHeight(0), holes(0), bumpiness(0), transitions(0), wells(0);
+    for (int y = 0; y < BoardHeight; ++y) {
+        V row = V::load(batch.rows(y) + first);
+        holes = holes + popcount16(seen & ~row & full);
+        seen = seen | row;
+        // Each column counts once per row at or below its top
+        aggregate = aggregate + popcount16(seen);
+        maxHeight = maxHeight + V(1) + V::isZero(seen);
+        // Columns x and x+1 differ in height by the rows where only one has started
+        bumpiness = bumpiness + popcount16((seen ^ (seen >> 1)) & V(Pairs));
+        // The row between its walls: bit 0 and bit BoardWidth+1 are set
+        V walled = (row << 1) | V(Walls);
+        transitions = transitions + popcount16((walled ^ (walled >> 1)) & V(WalledPairs));
+        V well = ((walled << 1) & (walled >> 1) & ~walled) >> 1;
+        wells = wells + popcount16(well & ~seen & full);
+    }
+    aggregate.store(out.features[AggregateHeight].data() + first);
+    maxHeight.store(out.features[MaxHeight].data() + first);
+    holes.store(out.features[Holes].data() + first);
+    bumpiness.store(out.features[Bumpiness].data() + first);
+    transitions.store(out.features[RowTransitions].data() + first);
+    wells.store(out.features[WellDepth].data() + first);
+    V::load(batch.lines() + first).store(out.features[CompleteLines].data() + first);
+}
+
+// Scores of boards [first, first + F::Lanes): the weighted features summed
+// in feature order, one multiply and one add per feature.
+template <typename F>
+inline void scoreKernel(const EvalWeights &weights, int first, BatchResult &out) {
+    F sum = F::load(out.features[0].data() + first) * F(weights.w[0]);
+    for (int f = 1; f < FeatureCount; ++f) sum = sum + F::load(out.features[f].data() + first) * F(weights.w[f]);
+    sum.store(out.scores.data() + first);
+}
+
+// One board per lane, portable C++.
+struct ScalarLanes {
+    static constexpr int Lanes = 1;
+    std::uint16_t v;
+
+    explicit ScalarLanes(unsigned x) : v(static_cast<std::uint16_t>(x)) {}
+    static ScalarLanes load(const std::uint16_t *p) { return ScalarLanes(*p); }
+    static ScalarLanes load(const std::int16_t *p) { return ScalarLanes(static_cast<std::uint16_t>(*p)); }
+    void store(std::int16_t *p) const { *p = static_cast<std::int16_t>(v); }
+    static ScalarLanes isZero(ScalarLanes a) { return ScalarLanes(a.v == 0 ? 0xFFFFu : 0u); }
+    friend ScalarLanes operator&(ScalarLanes a, ScalarLanes b) { return ScalarLanes(a.v & b.v); }
+    friend ScalarLanes operator|(ScalarLanes a, ScalarLanes b) { return ScalarLanes(a.v | b.v); }
+    friend ScalarLanes operator^(ScalarLanes a, ScalarLanes b) { return ScalarLanes(a.v ^ b.v); }
+    friend ScalarLanes operator~(ScalarLanes a) { return ScalarLanes(~a.v & 0xFFFFu); }
+    friend ScalarLanes operator+(ScalarLanes a, ScalarLanes b) { return ScalarLanes(a.v + b.v); }
+    friend ScalarLanes operator-(ScalarLanes a, ScalarLanes b) { return ScalarLanes(a.v - b.v); }
+    friend ScalarLanes operator<<(ScalarLanes a, int n) { return ScalarLanes(static_cast<unsigned>(a.v) << n); }
+    friend ScalarLanes operator>>(ScalarLanes a, int n) { return ScalarLanes(a.v >> n); }
+};
+
+struct ScalarFloats {
+    static constexpr int Lanes = 1;
+    float v;
+
+    explicit ScalarFloats(float x) : v(x) {}
+    static ScalarFloats load(const std::int16_t *p) { return ScalarFloats(static_cast<float>(*p)); }
+    void store(float *p) const { *p = v; }
+    friend ScalarFloats operator+(ScalarFloats a, ScalarFloats b) { return ScalarFloats(a.v + b.v); }
+    friend ScalarFloats operator*(ScalarFloats a, ScalarFloats b) { return ScalarFloats(a.v * b.v); }
+};
+
+// Run the kernels over the whole batch; the last group may run past count
+// into the padding lanes.
+template <typename V, typename F>
+inline void evaluateLanes(const BoardBatch &batch, const EvalWeights &weights, BatchResult &out) {
+    out.count = batch.size();
+    for (int i = 0; i < batch.size(); i += V::Lanes) featureKernel<V>(batch, i, out);
+    for (int i = 0; i < batch.size(); i += F::Lanes) scoreKernel<F>(weights, i, out);
+}
+
+} // namespace
+} // namespace tetris
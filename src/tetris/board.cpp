@@ -1,72 +1,214 @@
 #include "../../include/tetris/Board.hpp"
-#include <algorithm>
 
 using namespace tetris;
 
-Board::Board() {
-    for (int y = 0; y < BoardHeight; ++y)
-        for (int x = 0; x < BoardWidth; ++x)
-            grid[y][x].color = -1;
+// Index of the lowest set bit; bits must not be 0.
+template <typename Row>
+static int lowestBit(Row bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(Row) <= sizeof(unsigned)) return __builtin_ctz(bits);
+    else return __builtin_ctzll(bits);
+#else
+    int x = 0;
+    while (!((bits >> x) & 1u)) ++x;
+    return x;
+#endif
 }
 
-bool Board::isInside(const Point &p) const {
-    return p.x >= 0 && p.x < BoardWidth && p.y >= 0 && p.y < BoardHeight;
+template <int W, int H>
+BasicBoard<W, H>::BasicBoard() {
+    rows.fill(0);
+    zobrist = 0;
+    heights.fill(0);
+    fill.fill(0);
+    for (auto &line : grid)
+        for (auto &cell : line) cell.color = -1;
 }
 
-bool Board::isOccupied(const Point &p) const{
+template <int W, int H>
+bool BasicBoard<W, H>::isInside(const Point &p) const {
+    return p.x >= 0 && p.x < W && p.y >= 0 && p.y < H;
+}
+
+template <int W, int H>
+bool BasicBoard<W, H>::isOccupied(const Point &p) const{
     if (!isInside(p)) return true; // outside counts as occupied for collision
-    return grid[p.y][p.x].color != -1;
+    return (rows[p.y] >> p.x) & 1u;
 }
 
-bool Board::isValidPosition(const std::array<Point,4> &blocks, const Point &pos) const {
+template <int W, int H>
+bool BasicBoard<W, H>::isValidPosition(const std::array<Point,4> &blocks, const Point &pos) const {
     for (const auto &b : blocks) {
         Point p = pos + b;
-        if (p.x < 0 || p.x >= BoardWidth || p.y >= BoardHeight) return false;
-        if (p.y >= 0 && grid[p.y][p.x].color != -1) return false;
+        if (p.x < 0 || p.x >= W || p.y >= H) return false;
+        if (p.y >= 0 && (rows[p.y] & (Row{1} << p.x))) return false;
     }
     return true;
 }
 
-void Board::place(const std::array<Point,4> &blocks, const Point &pos, int color){
+template <int W, int H>
+bool BasicBoard<W, H>::isValidPosition(const ShapeInfo &shape, const Point &pos) const {
+    int left = pos.x + shape.minX;
+    if (left < 0 || pos.x + shape.maxX >= W || pos.y + shape.maxY >= H) return false;
+    int top = pos.y + shape.minY;
+    bool free = true;
+    // at most 4 shape rows; unrolled so each test is a branch-free AND
+    detail::unroll<4>([&](auto r) {
+        int y = top + r;
+        if (r < shape.height && y >= 0 && (rows[y] & (static_cast<Row>(shape.rowMasks[r]) << left))) free = false;
+    });
+    return free;
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::place(const std::array<Point,4> &blocks, const Point &pos, int color){
     for (const auto &b : blocks) {
         Point p = pos + b;
-        if (p.y >= 0 && p.y < BoardHeight && p.x >= 0 && p.x < BoardWidth)
+        if (p.y >= 0 && p.y < H && p.x >= 0 && p.x < W) {
+            Row bit = static_cast<Row>(Row{1} << p.x);
+            if (!(rows[p.y] & bit)) {
+                zobrist ^= zobristCells<W, H>[p.y][p.x];
+                ++fill[p.y];
+                if (heights[p.x] < H - p.y) heights[p.x] = static_cast<std::uint8_t>(H - p.y);
+            }
+            rows[p.y] |= bit;
             grid[p.y][p.x].color = color;
+        }
     }
 }
 
-std::vector<int> Board::getFullLines() const {
-    std::vector<int> lines;
-    for (int y = 0; y < BoardHeight; ++y) {
-        bool full = true;
-        for (int x = 0; x < BoardWidth; ++x) {
-            if (grid[y][x].color == -1) { full = false; break; }
+template <int W, int H>
+void BasicBoard<W, H>::setCell(int x, int y, int color) {
+    if (!isInside(Point{x, y})) return;
+    Row before = rows[y];
+    if (color == -1) rows[y] &= static_cast<Row>(~(Row{1} << x));
+    else rows[y] |= static_cast<Row>(Row{1} << x);
+    if (rows[y] != before) {
+        zobrist ^= zobristCells<W, H>[y][x];
+        if (color != -1) {
+            ++fill[y];
+            if (heights[x] < H - y) heights[x] = static_cast<std::uint8_t>(H - y);
+        } else {
+            --fill[y];
+            // The top cell went away: the column now ends at the next one down
+            if (heights[x] == H - y) {
+                int below = y + 1;
+                while (below < H && !((rows[below] >> x) & 1u)) ++below;
+                heights[x] = static_cast<std::uint8_t>(H - below);
+            }
         }
-        if (full) lines.push_back(y);
     }
+    grid[y][x].color = color;
+}
+
+template <int W, int H>
+typename BasicBoard<W, H>::Lines BasicBoard<W, H>::getFullLines() const {
+    Lines lines;
+    detail::unroll<H>([&](auto y) {
+        if (rows[y] == FullRow) lines.push_back(y);
+    });
     return lines;
 }
 
-void Board::removeLines(const std::vector<int>& lines) {
+template <int W, int H>
+typename BasicBoard<W, H>::Lines BasicBoard<W, H>::getFullLines(int first, int last) const {
+    Lines lines;
+    for (int y = first < 0 ? 0 : first; y <= last && y < H; ++y)
+        if (fill[y] == W) lines.push_back(y);
+    return lines;
+}
+
+template <int W, int H>
+int BasicBoard<W, H>::dropDistance(const ShapeInfo &shape, const Point &pos) const {
+    int distance = H;
+    for (int c = 0; c < shape.width; ++c) {
+        int bottom = pos.y + shape.columnBottom[c];
+        int top = H - heights[pos.x + shape.minX + c]; // first filled row
+        if (bottom >= top) {
+            // Under an overhang: the column's top says nothing about the gap below
+            distance = 0;
+            while (isValidPosition(shape, Point{pos.x, pos.y + distance + 1})) ++distance;
+            return distance;
+        }
+        if (top - 1 - bottom < distance) distance = top - 1 - bottom;
+    }
+    return distance;
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::removeLines(const Lines& lines) {
     if (lines.empty()) return;
-    // Create a new grid and copy rows that are not removed
-    std::array<std::array<Cell, BoardWidth>, BoardHeight> newGrid;
-    // Initialize new grid as empty
-    for (int y = 0; y < BoardHeight; ++y)
-        for (int x = 0; x < BoardWidth; ++x)
-            newGrid[y][x].color = -1;
-
-    int write = BoardHeight - 1;
-    for (int y = BoardHeight - 1; y >= 0; --y) {
-        if (std::find(lines.begin(), lines.end(), y) != lines.end()) {
-            // skip this row
-            continue;
+    using Mask = detail::UIntFor<H>;
+    Mask removed = 0;
+    for (int y : lines) removed = static_cast<Mask>(removed | (Mask{1} << y));
+
+    // Compact surviving rows towards the bottom in place
+    int write = H - 1;
+    for (int y = H - 1; y >= 0; --y) {
+        if ((removed >> y) & 1u) continue;
+        if (write != y) {
+            zobrist ^= rowHash(write, static_cast<Row>(rows[write] ^ rows[y]));
+            rows[write] = rows[y];
+            fill[write] = fill[y];
+            grid[write] = grid[y];
         }
-        // copy row y to write
-        newGrid[write] = grid[y];
         --write;
     }
-    grid = newGrid;
+    // Clear the rows that were vacated at the top
+    for (; write >= 0; --write) {
+        zobrist ^= rowHash(write, rows[write]);
+        rows[write] = 0;
+        fill[write] = 0;
+        for (auto &c : grid[write]) c.color = -1;
+    }
+    updateHeights();
+}
+
+template <int W, int H>
+bool BasicBoard<W, H>::addGarbage(int count, int hole, int color) {
+    if (count <= 0) return true;
+    if (count > H) count = H;
+    bool fits = true;
+    for (int y = 0; y < count; ++y) fits = fits && rows[y] == 0;
+    const Row garbage = static_cast<Row>(FullRow & ~(Row{1} << (hole < 0 ? 0 : hole >= W ? W - 1 : hole)));
+    for (int y = 0; y < H; ++y) {
+        Row moved = y + count < H ? rows[y + count] : garbage;
+        zobrist ^= rowHash(y, static_cast<Row>(rows[y] ^ moved));
+        rows[y] = moved;
+        if (y + count < H) {
+            fill[y] = fill[y + count];
+            grid[y] = grid[y + count];
+        } else {
+            fill[y] = static_cast<std::uint8_t>(W - 1);
+            for (int x = 0; x < W; ++x) grid[y][x].color = ((garbage >> x) & 1u) ? color : -1;
+        }
+    }
+    updateHeights();
+    return fits;
 }
 
-const Cell& Board::at(int x, int y) const { return grid[y][x]; }
+template <int W, int H>
+void BasicBoard<W, H>::updateHeights() {
+    // Column tops: the first filled row seen from above, for every column
+    Row open = FullRow;
+    for (int y = 0; y < H && open; ++y) {
+        for (Row top = static_cast<Row>(rows[y] & open); top; top &= static_cast<Row>(top - 1))
+            heights[lowestBit(top)] = static_cast<std::uint8_t>(H - y);
+        open &= static_cast<Row>(~rows[y]);
+    }
+    for (; open; open &= static_cast<Row>(open - 1)) heights[lowestBit(open)] = 0;
+}
+
+template <int W, int H>
+std::uint64_t BasicBoard<W, H>::rowHash(int y, Row bits) {
+    std::uint64_t h = 0;
+    for (; bits; bits &= static_cast<Row>(bits - 1)) h ^= zobristCells<W, H>[y][lowestBit(bits)];
+    return h;
+}
+
+template <int W, int H>
+const Cell& BasicBoard<W, H>::at(int x, int y) const { return grid[y][x]; }
+
+#define TETRIS_INSTANTIATE_BOARD(W, H) template class tetris::BasicBoard<W, H>;
+TETRIS_BOARD_SIZES(TETRIS_INSTANTIATE_BOARD)
+#undef TETRIS_INSTANTIATE_BOARD
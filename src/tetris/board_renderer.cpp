@@ -0,0 +1,133 @@
+#include "../../include/tetris/BoardRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace tetris;
+
+const std::array<sf::Color, PieceCount> BoardRenderer::colors = {
+    sf::Color::Cyan, sf::Color::Yellow, sf::Color::Magenta,
+    sf::Color::Blue, sf::Color(255,165,0), sf::Color::Green, sf::Color::Red
+};
+
+static constexpr int QuadCount = BoardWidth * BoardHeight + static_cast<int>(HudRect::Count);
+
+// Blend white over c with the given alpha, as the old overlay pass did on a black background.
+static sf::Color pulse(sf::Color c, unsigned char alpha) {
+    auto mix = [alpha](std::uint8_t v) {
+        return static_cast<std::uint8_t>((v * (255 - alpha) + 255 * alpha) / 255);
+    };
+    return sf::Color(mix(c.r), mix(c.g), mix(c.b), 255);
+}
+
+BoardRenderer::BoardRenderer() : m_vertices(static_cast<std::size_t>(QuadCount) * VerticesPerQuad) {
+    m_cellColors.fill(sf::Color::Transparent);
+    for (int y = 0; y < BoardHeight; ++y) {
+        for (int x = 0; x < BoardWidth; ++x) {
+            sf::FloatRect area(sf::Vector2f(static_cast<float>(x * CellSize + 1), static_cast<float>(y * CellSize + 1)),
+                               sf::Vector2f(CellSize - 2, CellSize - 2));
+            writeQuad(y * BoardWidth + x, area);
+            writeColor(y * BoardWidth + x, sf::Color::Transparent);
+        }
+    }
+    for (int i = 0; i < static_cast<int>(HudRect::Count); ++i) writeColor(CellCount + i, sf::Color::Transparent);
+
+    if (sf::VertexBuffer::isAvailable()) {
+        m_buffer.emplace(sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Dynamic);
+        if (!m_buffer->create(m_vertices.size())) m_buffer.reset();
+    }
+    m_dirtyBegin = 0;
+    m_dirtyEnd = m_vertices.size();
+}
+
+void BoardRenderer::writeQuad(int quad, const sf::FloatRect &area) {
+    sf::Vertex *v = &m_vertices[static_cast<std::size_t>(quad) * VerticesPerQuad];
+    sf::Vector2f tl = area.position;
+    sf::Vector2f br = area.position + area.size;
+    v[0].position = tl;
+    v[1].position = sf::Vector2f(br.x, tl.y);
+    v[2].position = sf::Vector2f(tl.x, br.y);
+    v[3].position = sf::Vector2f(tl.x, br.y);
+    v[4].position = sf::Vector2f(br.x, tl.y);
+    v[5].position = br;
+}
+
+void BoardRenderer::writeColor(int quad, sf::Color color) {
+    std::size_t first = static_cast<std::size_t>(quad) * VerticesPerQuad;
+    for (std::size_t i = 0; i < VerticesPerQuad; ++i) m_vertices[first + i].color = color;
+    if (m_dirtyBegin == m_dirtyEnd) {
+        m_dirtyBegin = first;
+        m_dirtyEnd = first + VerticesPerQuad;
+    } else {
+        m_dirtyBegin = std::min(m_dirtyBegin, first);
+        m_dirtyEnd = std::max(m_dirtyEnd, first + VerticesPerQuad);
+    }
+}
+
+void BoardRenderer::update(const Engine &engine, float sinceStep) {
+    std::array<sf::Color, CellCount> target;
+    const Board &board = engine.board();
+    for (int y = 0; y < BoardHeight; ++y) {
+        for (int x = 0; x < BoardWidth; ++x) {
+            int c = board.at(x,y).color;
+            if (c == -1) target[y * BoardWidth + x] = sf::Color::Transparent;
+            else target[y * BoardWidth + x] = c == GarbageColor ? sf::Color(110, 110, 110) : colors[c];
+        }
+    }
+
+    // ghost piece where a hard drop would land, then the active piece over it
+    if (engine.running() && !engine.animating()) {
+        const Tetromino &active = engine.active();
+        const Tetromino ghost = engine.ghost();
+        sf::Color shade = colors[static_cast<int>(active.type)];
+        shade.a = 70;
+        for (const auto &b : Tetromino::getShape(ghost.type, ghost.rotation)) {
+            Point p = ghost.position + b;
+            if (p.y >= 0) target[p.y * BoardWidth + p.x] = shade;
+        }
+        for (const auto &b : Tetromino::getShape(active.type, active.rotation)) {
+            Point p = active.position + b;
+            if (p.y >= 0) target[p.y * BoardWidth + p.x] = colors[static_cast<int>(active.type)];
+        }
+    }
+
+    // pulsing line clear overlay
+    if (engine.animating()) {
+        // 0..1, interpolated towards the state of the next logic step
+        float t = std::min(1.0f, engine.lineClearProgress() + sinceStep / Engine::LineClearDuration);
+        float alpha = 160.0f * (1.0f - std::cos(t * 3.14159f)); // fade in/out
+        unsigned char a = static_cast<unsigned char>(std::clamp(alpha, 0.f, 255.f));
+        for (int y : engine.linesToClear()) {
+            for (int x = 0; x < BoardWidth; ++x) {
+                sf::Color &c = target[y * BoardWidth + x];
+                c = pulse(c.a ? c : sf::Color::Black, a);
+            }
+        }
+    }
+
+    for (int i = 0; i < CellCount; ++i) {
+        if (target[i] != m_cellColors[i]) {
+            m_cellColors[i] = target[i];
+            writeColor(i, target[i]);
+        }
+    }
+}
+
+void BoardRenderer::setRect(HudRect rect, const sf::FloatRect &area, sf::Color color) {
+    int quad = CellCount + static_cast<int>(rect);
+    const sf::Vertex *v = &m_vertices[static_cast<std::size_t>(quad) * VerticesPerQuad];
+    if (v[0].position == area.position && v[5].position == area.position + area.size && v[0].color == color) return;
+    writeQuad(quad, area);
+    writeColor(quad, color);
+}
+
+void BoardRenderer::draw(sf::RenderTarget &target) {
+    if (!m_buffer) {
+        target.draw(m_vertices.data(), m_vertices.size(), sf::PrimitiveType::Triangles);
+        return;
+    }
+    if (m_dirtyBegin != m_dirtyEnd) {
+        m_buffer->update(m_vertices.data() + m_dirtyBegin, m_dirtyEnd - m_dirtyBegin, static_cast<unsigned>(m_dirtyBegin));
+        m_dirtyBegin = m_dirtyEnd = 0;
+    }
+    target.draw(*m_buffer);
+}
@@ -0,0 +1,179 @@
+#include "../../include/tetris/Bot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+using namespace tetris;
+
+struct Bot::Search {
+    Board board;
+    TetrominoType next;
+    BotWeights weights;
+    TranspositionTable *table = nullptr;
+    PlacementList first;
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> remaining{0};
+
+    mutable std::mutex mutex;
+    std::condition_variable finished;
+    // Best placements of the one-ply pass and of the two-ply search. Scores
+    // of the two depths are not comparable, so the two-ply choice is only
+    // used once every placement has its two-ply score.
+    struct Choice {
+        double score = -std::numeric_limits<double>::infinity();
+        int index = -1;
+
+        // Ties go to the lower index so a completed search does not depend on task order.
+        void offer(int i, double value) {
+            if (value > score || (value == score && i < index)) {
+                score = value;
+                index = i;
+            }
+        }
+    };
+    Choice quick, deep;
+    int deepOffers = 0;
+
+    void offer(int index, double score, bool isDeep) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!isDeep) {
+            quick.offer(index, score);
+            return;
+        }
+        deep.offer(index, score);
+        ++deepOffers;
+    }
+    // Call with mutex held; -1 when there is no placement.
+    int bestIndex() const {
+        return deepOffers == first.size() && deep.index >= 0 ? deep.index : quick.index;
+    }
+};
+
+// One move generator per pool thread; they are too large to live on the stack.
+static MoveGenerator& threadGenerator() {
+    thread_local std::unique_ptr<MoveGenerator> gen = std::make_unique<MoveGenerator>();
+    return *gen;
+}
+
+static int applyPlacement(Board &board, const Placement &p) {
+    const ShapeInfo &shape = Tetromino::shape(p.type, p.rotation);
+    board.place(shape.blocks, p.position, static_cast<int>(p.type));
+    LineList full = board.getFullLines(p.position.y + shape.minY, p.position.y + shape.maxY);
+    board.removeLines(full);
+    return full.size();
+}
+
+double Bot::evaluate(const Board &board, int lines, const BotWeights &weights) {
+    int heights[BoardWidth];
+    int aggregate = 0, holes = 0, bumpiness = 0;
+    Board::Row seen = 0;
+    for (int x = 0; x < BoardWidth; ++x) heights[x] = 0;
+    for (int y = 0; y < BoardHeight; ++y) {
+        Board::Row row = board.row(y);
+        Board::Row fresh = row & ~seen;
+        for (int x = 0; x < BoardWidth; ++x)
+            if (fresh & (Board::Row{1} << x)) heights[x] = BoardHeight - y;
+        // empty cells under a filled one are holes
+        for (Board::Row h = seen & ~row & Board::FullRow; h; h &= h - 1) ++holes;
+        seen |= row;
+    }
+    for (int x = 0; x < BoardWidth; ++x) {
+        aggregate += heights[x];
+        if (x > 0) bumpiness += heights[x] > heights[x-1] ? heights[x] - heights[x-1] : heights[x-1] - heights[x];
+    }
+    return weights.aggregateHeight * aggregate + weights.completeLines * lines
+         + weights.holes * holes + weights.bumpiness * bumpiness;
+}
+
+Bot::Bot(ThreadPool &pool, BotWeights weights, TranspositionTable *table)
+    : m_pool(pool), m_weights(weights), m_table(table) {}
+
+// Best value of placing `next` on board, not counting lines cleared before.
+// Returns false when cancelled part way.
+static bool bestReply(const Board &board, TetrominoType next, const BotWeights &weights,
+                      TranspositionTable *table, const std::atomic<bool> &cancelled, double &value) {
+    std::uint64_t key = TranspositionTable::key(board.hash(), next, TetrominoType::Count);
+    std::uint64_t bits;
+    if (table && table->probe(key, bits)) {
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+    PlacementList replies;
+    threadGenerator().generate(board, Tetromino{next, 0, SpawnPosition}, replies);
+    // no reply means the preview piece tops out: as bad as it gets
+    value = -std::numeric_limits<double>::infinity();
+    for (const Placement &r : replies) {
+        if (cancelled.load(std::memory_order_relaxed)) return false;
+        Board child = board;
+        int lines = applyPlacement(child, r);
+        value = std::max(value, Bot::evaluate(child, lines, weights));
+    }
+    if (table) {
+        std::memcpy(&bits, &value, sizeof(bits));
+        table->store(key, bits);
+    }
+    return true;
+}
+
+Bot::~Bot() {
+    if (m_search) m_search->cancelled = true;
+}
+
+void Bot::start(const Board &board, const Tetromino &active, TetrominoType next) {
+    if (m_search) m_search->cancelled = true;
+    auto search = std::make_shared<Search>();
+    search->board = board;
+    search->next = next;
+    search->weights = m_weights;
+    search->table = m_table;
+    threadGenerator().generate(board, active, search->first);
+    m_search = search;
+
+    // quick one-ply pass so there is always an answer
+    for (int i = 0; i < search->first.size(); ++i) {
+        Board child = board;
+        int lines = applyPlacement(child, search->first[i]);
+        search->offer(i, evaluate(child, lines, m_weights), false);
+    }
+
+    search->remaining = search->first.size();
+    for (int i = 0; i < search->first.size(); ++i) {
+        m_pool.submit([search, i] {
+            if (!search->cancelled.load(std::memory_order_relaxed)) {
+                Board child = search->board;
+                int lines = applyPlacement(child, search->first[i]);
+                double reply;
+                if (bestReply(child, search->next, search->weights, search->table, search->cancelled, reply))
+                    search->offer(i, reply + search->weights.completeLines * lines, true);
+            }
+            if (search->remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(search->mutex);
+                search->finished.notify_all();
+            }
+        });
+    }
+}
+
+bool Bot::best(Placement &out) const {
+    if (!m_search) return false;
+    std::lock_guard<std::mutex> lock(m_search->mutex);
+    int index = m_search->bestIndex();
+    if (index < 0) return false;
+    out = m_search->first[index];
+    return true;
+}
+
+bool Bot::done() const {
+    return !m_search || m_search->remaining.load() == 0;
+}
+
+bool Bot::think(std::chrono::steady_clock::time_point deadline, Placement &out) {
+    if (m_search) {
+        std::unique_lock<std::mutex> lock(m_search->mutex);
+        m_search->finished.wait_until(lock, deadline, [this] { return m_search->remaining.load() == 0; });
+    }
+    return best(out);
+}
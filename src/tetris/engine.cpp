@@ -0,0 +1,238 @@
+#include "../../include/tetris/Engine.hpp"
+#include "../../include/tetris/Profiler.hpp"
+#include <algorithm>
+#include <type_traits>
+
+using namespace tetris;
+
+template <int W, int H>
+BasicEngine<W, H>::BasicEngine(std::uint32_t seed) {
+    reset(seed);
+}
+
+template <int W, int H>
+BasicEngine<W, H>::BasicEngine(const PieceGenerator &pieces) {
+    reset(pieces);
+}
+
+template <int W, int H>
+void BasicEngine<W, H>::reset(std::uint32_t seed) {
+    reset(PieceGenerator(seed, 0, m_pieces.mode()));
+}
+
+template <int W, int H>
+void BasicEngine<W, H>::reset(const PieceGenerator &pieces) {
+    m_board = Board();
+    m_pieces = pieces;
+    m_dropTimer = 0.0f;
+    m_elapsed = 0.0;
+    m_dropInterval = 0.6f;
+    m_running = true;
+    m_score = 0;
+    m_level = 0;
+    m_totalLines = 0;
+    m_piecesPlaced = 0;
+    m_linesToClear.clear();
+    m_animating = false;
+    m_lineClearTimer = 0.0f;
+    m_next = m_pieces.next();
+    spawnPiece();
+}
+
+template <int W, int H>
+int BasicEngine<W, H>::scoreForLines(int lines, int level) {
+    static const int baseScore[] = {0,100,300,500,800};
+    return (lines >= 1 && lines <= 4) ? baseScore[lines] * (level + 1) : 0;
+}
+
+template <int W, int H>
+int BasicEngine<W, H>::garbageForLines(int lines) {
+    static const int sent[] = {0, 0, 1, 2, 4};
+    return lines >= 0 && lines <= 4 ? sent[lines] : 0;
+}
+
+template <int W, int H>
+float BasicEngine<W, H>::dropIntervalForLevel(int level) {
+    return std::max(0.05f, 0.8f - level * 0.05f);
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::spawnPiece() {
+    m_active.type = m_next;
+    m_active.rotation = 0;
+    m_active.position = spawnPosition(W);
+    m_next = m_pieces.next();
+    // Check immediate collision -> game over
+    if (!m_board.isValidPosition(Tetromino::shape(m_active.type, m_active.rotation), m_active.position)) {
+        m_running = false;
+        return events::GameOver;
+    }
+    return events::Spawned;
+}
+
+template <int W, int H>
+bool BasicEngine<W, H>::tryMove(Point delta) {
+    Point newPos = m_active.position + delta;
+    if (!m_board.isValidPosition(Tetromino::shape(m_active.type, m_active.rotation), newPos)) return false;
+    m_active.position = newPos;
+    return true;
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::step(Action action) {
+    if (!m_running || m_animating) return events::None;
+    switch (action) {
+    case Action::Left:
+        return tryMove(Point{-1,0}) ? events::Moved : events::None;
+    case Action::Right:
+        return tryMove(Point{1,0}) ? events::Moved : events::None;
+    case Action::SoftDrop:
+        return tryMove(Point{0,1}) ? events::SoftDropped : events::None;
+    case Action::Rotate: {
+        int newRot = (m_active.rotation + 1) & 3;
+        const ShapeInfo &shape = Tetromino::shape(m_active.type, newRot);
+        const KickList &kicks = Tetromino::kicks(m_active.type, m_active.rotation);
+        for (int k = 0; k < kicks.count; ++k) {
+            Point newPos = m_active.position + kicks.offsets[k];
+            if (m_board.isValidPosition(shape, newPos)) {
+                m_active.rotation = newRot;
+                m_active.position = newPos;
+                return events::Rotated;
+            }
+        }
+        return events::None;
+    }
+    case Action::HardDrop:
+        return hardDrop();
+    default:
+        return events::None;
+    }
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::tick(float dt) {
+    if (!m_running) return events::None;
+    m_elapsed += dt;
+
+    // Handle line clear animation
+    if (m_animating) {
+        m_lineClearTimer += dt;
+        if (m_lineClearTimer >= LineClearDuration) return finishLineClear();
+        return events::None;
+    }
+
+    m_dropTimer += dt;
+    if (m_dropTimer >= m_dropInterval) {
+        m_dropTimer = 0.0f;
+        if (tryMove(Point{0,1})) return events::Moved;
+        return lockPiece();
+    }
+    return events::None;
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::addGarbage(int lines, int hole) {
+    if (!m_running || m_animating || lines <= 0) return events::None;
+    bool fits = m_board.addGarbage(lines, hole, GarbageColor);
+    const ShapeInfo &shape = Tetromino::shape(m_active.type, m_active.rotation);
+    for (int lift = 0; lift < lines && !m_board.isValidPosition(shape, m_active.position); ++lift) --m_active.position.y;
+    if (!fits || !m_board.isValidPosition(shape, m_active.position)) {
+        m_running = false;
+        return events::GameOver;
+    }
+    return events::None;
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::finishLineClear() {
+    {
+        TETRIS_PROFILE_SCOPE("Board::removeLines");
+        m_board.removeLines(m_linesToClear);
+    }
+    int n = static_cast<int>(m_linesToClear.size());
+    m_score += scoreForLines(n, m_level);
+    m_totalLines += n;
+    int oldLevel = m_level;
+    m_level = m_totalLines / 10;
+    m_dropInterval = dropIntervalForLevel(m_level);
+    m_linesToClear.clear();
+    m_animating = false;
+    Events ev = events::LinesRemoved;
+    if (m_level > oldLevel) ev |= events::LevelUp;
+    return ev | spawnPiece();
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::lockPiece() {
+    TETRIS_PROFILE_SCOPE("Engine::lockPiece");
+    m_board.place(Tetromino::getShape(m_active.type, m_active.rotation), m_active.position, static_cast<int>(m_active.type));
+    ++m_piecesPlaced;
+    // Find full lines and start clear animation if any
+    {
+        TETRIS_PROFILE_SCOPE("Board::getFullLines");
+        const ShapeInfo &shape = Tetromino::shape(m_active.type, m_active.rotation);
+        m_linesToClear = m_board.getFullLines(m_active.position.y + shape.minY, m_active.position.y + shape.maxY);
+    }
+    if (!m_linesToClear.empty()) {
+        m_animating = true;
+        m_lineClearTimer = 0.0f;
+        return events::Locked | events::LinesCleared; // score once the animation completes
+    }
+    return events::Locked | spawnPiece();
+}
+
+template <int W, int H>
+Events BasicEngine<W, H>::hardDrop() {
+    m_active.position.y += dropDistance();
+    return events::HardDropped | lockPiece();
+}
+
+template <int W, int H>
+void BasicEngine<W, H>::snapshot(Snapshot &out) const {
+    static_assert(std::is_trivially_copyable_v<Snapshot>, "snapshots are copied as plain memory");
+    out.board = m_board;
+    out.active = m_active;
+    out.next = m_next;
+    out.pieces = m_pieces;
+    out.dropTimer = m_dropTimer;
+    out.elapsed = m_elapsed;
+    out.dropInterval = m_dropInterval;
+    out.running = m_running;
+    out.score = m_score;
+    out.level = m_level;
+    out.totalLines = m_totalLines;
+    out.piecesPlaced = m_piecesPlaced;
+    out.linesToClear = m_linesToClear;
+    out.animating = m_animating;
+    out.lineClearTimer = m_lineClearTimer;
+}
+
+template <int W, int H>
+typename BasicEngine<W, H>::Snapshot BasicEngine<W, H>::snapshot() const {
+    Snapshot s;
+    snapshot(s);
+    return s;
+}
+
+template <int W, int H>
+void BasicEngine<W, H>::restore(const Snapshot &s) {
+    m_board = s.board;
+    m_active = s.active;
+    m_next = s.next;
+    m_pieces = s.pieces;
+    m_dropTimer = s.dropTimer;
+    m_elapsed = s.elapsed;
+    m_dropInterval = s.dropInterval;
+    m_running = s.running;
+    m_score = s.score;
+    m_level = s.level;
+    m_totalLines = s.totalLines;
+    m_piecesPlaced = s.piecesPlaced;
+    m_linesToClear = s.linesToClear;
+    m_animating = s.animating;
+    m_lineClearTimer = s.lineClearTimer;
+}
+
+#define TETRIS_INSTANTIATE_ENGINE(W, H) template class tetris::BasicEngine<W, H>;
+TETRIS_BOARD_SIZES(TETRIS_INSTANTIATE_ENGINE)
+#undef TETRIS_INSTANTIATE_ENGINE
@@ -0,0 +1,113 @@
+#include "../../include/tetris/FrameExport.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace tetris;
+
+void tetris::convertToYuv(const std::uint8_t *rgba, unsigned width, unsigned height, std::vector<std::uint8_t> &out) {
+    const unsigned cw = (width + 1) / 2, ch = (height + 1) / 2;
+    static const char Tag[] = "FRAME\n";
+    out.resize(sizeof(Tag) - 1 + std::size_t(width) * height + 2 * std::size_t(cw) * ch);
+    std::memcpy(out.data(), Tag, sizeof(Tag) - 1);
+    std::uint8_t *luma = out.data() + sizeof(Tag) - 1;
+    std::uint8_t *u = luma + std::size_t(width) * height;
+    std::uint8_t *v = u + std::size_t(cw) * ch;
+    for (unsigned y = 0; y < height; ++y) {
+        const std::uint8_t *p = rgba + std::size_t(y) * width * 4;
+        for (unsigned x = 0; x < width; ++x, p += 4)
+            luma[std::size_t(y) * width + x] = static_cast<std::uint8_t>(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+    }
+    for (unsigned cy = 0; cy < ch; ++cy) {
+        for (unsigned cx = 0; cx < cw; ++cx) {
+            int r = 0, g = 0, b = 0;
+            for (unsigned dy = 0; dy < 2; ++dy) {
+                for (unsigned dx = 0; dx < 2; ++dx) {
+                    unsigned x = std::min(2 * cx + dx, width - 1), y = std::min(2 * cy + dy, height - 1);
+                    const std::uint8_t *p = rgba + (std::size_t(y) * width + x) * 4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            // Sums of four pixels: the extra >> 2 averages them
+            u[std::size_t(cy) * cw + cx] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+            v[std::size_t(cy) * cw + cx] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+        }
+    }
+}
+
+struct FramePipeline::Job {
+    std::unique_ptr<ExportFrame> frame;
+    bool done = false; // guarded by m_mutex
+};
+
+FramePipeline::FramePipeline(ThreadPool &pool, std::size_t maxInFlight, Encode encode, Write write)
+    : m_pool(pool), m_maxInFlight(std::max<std::size_t>(1, maxInFlight)), m_encode(std::move(encode)), m_write(std::move(write)) {}
+
+FramePipeline::~FramePipeline() {
+    // pool tasks point at the jobs and at this object
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] {
+        return std::all_of(m_inFlight.begin(), m_inFlight.end(), [](const std::unique_ptr<Job> &job) { return job->done; });
+    });
+}
+
+std::unique_ptr<ExportFrame> FramePipeline::next() {
+    std::unique_ptr<ExportFrame> frame;
+    if (m_spare.empty()) frame = std::make_unique<ExportFrame>();
+    else {
+        frame = std::move(m_spare.back());
+        m_spare.pop_back();
+    }
+    frame->index = m_frames++;
+    frame->ok = true;
+    return frame;
+}
+
+void FramePipeline::submit(std::unique_ptr<ExportFrame> frame) {
+    auto job = std::make_unique<Job>();
+    job->frame = std::move(frame);
+    Job *raw = job.get();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight.push_back(std::move(job));
+    }
+    m_pool.submit([this, raw] {
+        ExportFrame &f = *raw->frame;
+        if (f.ok) f.ok = m_encode(f);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        raw->done = true;
+        m_finished.notify_all();
+    });
+    retire(m_maxInFlight);
+}
+
+void FramePipeline::finish() {
+    retire(0);
+}
+
+std::size_t FramePipeline::inFlight() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inFlight.size();
+}
+
+void FramePipeline::retire(std::size_t keep) {
+    for (;;) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_inFlight.empty()) return;
+        if (!m_inFlight.front()->done) {
+            if (m_inFlight.size() <= keep) return;
+            m_finished.wait(lock, [this] { return m_inFlight.front()->done; });
+        }
+        std::unique_ptr<Job> job = std::move(m_inFlight.front());
+        m_inFlight.pop_front();
+        lock.unlock();
+        ExportFrame &frame = *job->frame;
+        if (frame.ok) frame.ok = m_write(frame);
+        if (!frame.ok && !m_failed) {
+            m_failed = true;
+            m_firstFailure = frame.index;
+        }
+        m_spare.push_back(std::move(job->frame));
+    }
+}
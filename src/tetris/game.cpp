@@ -1,371 +1,447 @@
 #include "../../include/tetris/Game.hpp"
+#include "../../include/tetris/AllocCounter.hpp"
+#include "../../include/tetris/Profiler.hpp"
 #include <chrono>
-#include <sstream>
+#include <cstdio>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <random>
 
 using namespace tetris;
 
-const std::array<sf::Color, static_cast<int>(TetrominoType::Count)> Game::colors = {
-    sf::Color::Cyan, sf::Color::Yellow, sf::Color::Magenta,
-    sf::Color::Blue, sf::Color(255,165,0), sf::Color::Green, sf::Color::Red
-};
-
-static TetrominoType randomType(std::mt19937 &rng) {
-    std::uniform_int_distribution<int> dist(0, static_cast<int>(TetrominoType::Count) - 1);
-    return static_cast<TetrominoType>(dist(rng));
+Game::Game(sf::RenderWindow &window, const std::string &recordPath, const std::string &tracePath,
+           const std::string &bundlePath)
+    : m_window(window), m_recordPath(recordPath), m_tracePath(tracePath), m_startTime(std::chrono::steady_clock::now()) {
+    profiler::setThreadName("main");
+    if (!m_tracePath.empty()) profiler::setEnabled(true);
+    std::uint32_t seed = std::random_device{}();
+    m_engine.reset(seed);
+    if (!m_recordPath.empty()) m_recorder = std::make_unique<ReplayWriter>(seed);
+    m_engine.snapshot(m_history.push());
+    m_knob.setFillColor(sf::Color::White);
+    // held keys are tracked from press/release events; DAS/ARR replaces OS key repeat
+    m_window.setKeyRepeatEnabled(false);
+    // font and sounds are optional and load while the first frames are drawn
+    m_pendingAssets = std::async(std::launch::async, [bundlePath] { return loadGameAssets(bundlePath); });
 }
 
-Game::Game(sf::RenderWindow &window): m_window(window) {
-    std::random_device rd;
-    m_rng.seed(rd());
-    m_next = randomType(m_rng);
-    spawnPiece();
-    // Load a system font if available
-    m_fontLoaded = m_font.openFromFile("C:/Windows/Fonts/arial.ttf");
-    // Try to load sound effects from assets (optional)
-    m_clearSoundLoaded = m_clearBuffer.loadFromFile("assets/clear.wav");
-    if (m_clearSoundLoaded) {
-        m_clearSound = std::make_unique<sf::Sound>(m_clearBuffer);
-        m_clearSound->setVolume(m_volume);
-    }
-    m_rotateSoundLoaded = m_rotateBuffer.loadFromFile("assets/rotate.wav");
-    if (m_rotateSoundLoaded) {
-        m_rotateSound = std::make_unique<sf::Sound>(m_rotateBuffer);
-        m_rotateSound->setVolume(m_volume);
-    }
-    m_dropSoundLoaded = m_dropBuffer.loadFromFile("assets/drop.wav");
-    if (m_dropSoundLoaded) {
-        m_dropSound = std::make_unique<sf::Sound>(m_dropBuffer);
-        m_dropSound->setVolume(m_volume);
-    }
-    m_hardDropSoundLoaded = m_hardDropBuffer.loadFromFile("assets/harddrop.wav");
-    if (m_hardDropSoundLoaded) {
-        m_hardDropSound = std::make_unique<sf::Sound>(m_hardDropBuffer);
-        m_hardDropSound->setVolume(m_volume);
+void Game::installAssets(GameAssets assets) {
+    for (int i = 0; i < SfxCount; ++i) m_sounds.setBuffer(static_cast<Sfx>(i), std::move(assets.sounds[i]));
+    m_font.reset();
+    m_bundle = std::move(assets.bundle);
+    m_font = std::move(assets.font);
+    double readyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+    std::printf("assets ready after %.1f ms (%.1f ms loading in the background, %d from bundle, %d from files)\n",
+                readyMs, assets.loadSeconds * 1000.0, assets.fromBundle, assets.fromFiles);
+    if (!m_font) return;
+
+    m_statsText.emplace(*m_font, "", 16);
+    m_statsText->setFillColor(sf::Color::White);
+    m_statsText->setPosition(sf::Vector2f(static_cast<float>(BoardWidth * CellSize + 10), 10.f));
+    m_volumeText.emplace(*m_font, "", 12);
+    m_volumeText->setFillColor(sf::Color::White);
+    m_gameOverText.emplace(*m_font, "Game Over - Press R to restart", 20);
+    m_gameOverText->setFillColor(sf::Color::White);
+    m_gameOverText->setPosition(sf::Vector2f(10.f, static_cast<float>(BoardHeight * CellSize / 2.f - 20.f)));
+    if (allocationCounterEnabled()) {
+        m_allocText.emplace(*m_font, "", 12);
+        m_allocText->setFillColor(sf::Color(255,200,0));
+        m_allocText->setPosition(sf::Vector2f(static_cast<float>(BoardWidth * CellSize + 10), 80.f));
     }
-    // UI and voice sounds
-    m_uiClickLoaded = m_uiClickBuffer.loadFromFile("assets/ui_click.wav");
-    if (m_uiClickLoaded) { m_uiClickSound = std::make_unique<sf::Sound>(m_uiClickBuffer); m_uiClickSound->setVolume(m_volume); }
-    m_voiceLevelLoaded = m_voiceLevelBuffer.loadFromFile("assets/voice_levelup.wav");
-    if (m_voiceLevelLoaded) { m_voiceLevelSound = std::make_unique<sf::Sound>(m_voiceLevelBuffer); m_voiceLevelSound->setVolume(m_volume); }
+    m_latencyText.emplace(*m_font, "", 12);
+    m_latencyText->setFillColor(sf::Color(160,160,160));
+    m_latencyText->setPosition(sf::Vector2f(static_cast<float>(BoardWidth * CellSize + 10), 100.f));
+    m_profilerText.emplace(*m_font, "", 11);
+    m_profilerText->setFillColor(sf::Color(120,255,120));
+    m_profilerText->setPosition(sf::Vector2f(8.f, 8.f));
 }
 
-void Game::spawnPiece() {
-    m_active.type = m_next;
-    m_active.rotation = 0;
-    m_active.position = Point{BoardWidth/2 - 2, -1};
-    m_next = randomType(m_rng);
-    // Check immediate collision -> game over
-    auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[0];
-    if (!m_board.isValidPosition(blocks, m_active.position)) {
-        m_running = false;
-    }
+void Game::setVolume(float volume) {
+    m_sounds.setVolume(volume);
+    m_sounds.play(Sfx::UiClick);
+}
+
+Events Game::applyAction(Action action) {
+    if (m_paused) return events::None;
+    if (m_recorder) m_recorder->action(action);
+    Events ev = m_engine.step(action);
+    if (ev & events::Spawned) m_engine.snapshot(m_history.push());
+    playEffects(ev);
+    return ev;
+}
+
+void Game::playEffects(Events ev) {
+    if (ev & events::SoftDropped) m_sounds.play(Sfx::Drop);
+    if (ev & events::HardDropped) m_sounds.play(Sfx::HardDrop);
+    if (ev & events::Rotated) m_sounds.play(Sfx::Rotate);
+    if (ev & events::LinesCleared) m_sounds.play(Sfx::Clear);
+    if (ev & events::LevelUp) m_sounds.play(Sfx::VoiceLevelUp);
 }
 
 void Game::processInput() {
     while (const std::optional<sf::Event> event = m_window.pollEvent()) {
         if (event->is<sf::Event::Closed>()) m_window.close();
+        if (event->is<sf::Event::FocusLost>()) {
+            // key releases are not delivered while unfocused
+            m_leftRepeat.release();
+            m_rightRepeat.release();
+            m_downRepeat.release();
+            m_horizontal = Action::None;
+        }
+        if (event->is<sf::Event::KeyReleased>()) handleKey(event->getIf<sf::Event::KeyReleased>()->code, false);
         if (event->is<sf::Event::KeyPressed>()) {
             auto key = event->getIf<sf::Event::KeyPressed>()->code;
             if (key == sf::Keyboard::Key::Escape) m_window.close();
             if (key == sf::Keyboard::Key::P) m_paused = !m_paused;
-
-            // In-game controls
-            if (!m_paused && m_running) {
-                if (key == sf::Keyboard::Key::Left) {
-                    auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-                    Point newPos = m_active.position + Point{-1,0};
-                    if (m_board.isValidPosition(blocks, newPos)) m_active.position = newPos;
-                } else if (key == sf::Keyboard::Key::Right) {
-                    auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-                    Point newPos = m_active.position + Point{1,0};
-                    if (m_board.isValidPosition(blocks, newPos)) m_active.position = newPos;
-                } else if (key == sf::Keyboard::Key::Down) {
-                    // soft drop
-                    auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-                    Point newPos = m_active.position + Point{0,1};
-                    if (m_board.isValidPosition(blocks, newPos)) {
-                        m_active.position = newPos;
-                        if (m_dropSoundLoaded && m_dropSound) m_dropSound->play();
-                    }
-                } else if (key == sf::Keyboard::Key::Up) {
-                    // rotate
-                    int newRot = (m_active.rotation + 1) & 3;
-                    auto blocks = Tetromino::getShape(m_active.type, newRot)[newRot];
-                    if (m_board.isValidPosition(blocks, m_active.position)) {
-                        m_active.rotation = newRot;
-                        if (m_rotateSoundLoaded && m_rotateSound) m_rotateSound->play();
-                    }
-                } else if (key == sf::Keyboard::Key::Space) {
-                    hardDrop();
-                    if (m_hardDropSoundLoaded && m_hardDropSound) m_hardDropSound->play();
+            if (key == sf::Keyboard::Key::F3) {
+                // zones are only recorded while someone looks at them
+                m_showProfiler = !m_showProfiler;
+                profiler::setEnabled(m_showProfiler || !m_tracePath.empty());
+                m_profilerRefresh = 0;
+            }
+            if (key == sf::Keyboard::Key::F4) {
+                char path[64];
+                std::snprintf(path, sizeof(path), "tetris-trace-%d.json", m_traceExports++);
+                if (profiler::writeChromeTrace(path)) std::printf("trace written to %s\n", path);
+            }
+            if (key == sf::Keyboard::Key::A) {
+                m_autoplay = !m_autoplay;
+                if (m_autoplay && !m_bot) {
+                    unsigned hw = std::thread::hardware_concurrency();
+                    m_botPool = std::make_unique<ThreadPool>(hw > 1 ? hw - 1 : 1);
+                    m_botTable = std::make_unique<TranspositionTable>(std::size_t{32} << 20);
+                    m_bot = std::make_unique<Bot>(*m_botPool, BotWeights{}, m_botTable.get());
+                    m_botPathGen = std::make_unique<MoveGenerator>();
+                    m_botPlacements = std::make_unique<PlacementList>();
                 }
+                m_botPiece = -1;
             }
 
+            // In-game controls
+            handleKey(key, true);
+
+            if (key == sf::Keyboard::Key::Backspace) rewind();
+
             // Restart after game over
-            if (!m_running && key == sf::Keyboard::Key::R) {
-                m_board = Board();
-                m_running = true;
-                m_paused = false;
-                m_score = 0;
-                spawnPiece();
+            if (!m_engine.running() && key == sf::Keyboard::Key::R) {
+                restart();
             }
 
             // Global input for audio controls
-            if (key == sf::Keyboard::Key::M) {
-                m_muted = !m_muted;
-                float v = m_muted ? 0.0f : m_volume;
-                if (m_clearSound && m_clearSoundLoaded) m_clearSound->setVolume(v);
-                if (m_rotateSound && m_rotateSoundLoaded) m_rotateSound->setVolume(v);
-                if (m_dropSound && m_dropSoundLoaded) m_dropSound->setVolume(v);
-                if (m_hardDropSound && m_hardDropSoundLoaded) m_hardDropSound->setVolume(v);
-                if (m_uiClickSound && m_uiClickLoaded) m_uiClickSound->setVolume(v);
-                if (m_voiceLevelSound && m_voiceLevelLoaded) m_voiceLevelSound->setVolume(v);
-            }
-            if (key == sf::Keyboard::Key::LBracket) { // decrease volume
-                m_volume = std::max(0.0f, m_volume - 10.0f);
-                if (!m_muted) {
-                    if (m_clearSound && m_clearSoundLoaded) m_clearSound->setVolume(m_volume);
-                    if (m_rotateSound && m_rotateSoundLoaded) m_rotateSound->setVolume(m_volume);
-                    if (m_dropSound && m_dropSoundLoaded) m_dropSound->setVolume(m_volume);
-                    if (m_hardDropSound && m_hardDropSoundLoaded) m_hardDropSound->setVolume(m_volume);
-                    if (m_uiClickSound && m_uiClickLoaded) { m_uiClickSound->setVolume(m_volume); m_uiClickSound->play(); }
-                    if (m_voiceLevelSound && m_voiceLevelLoaded) m_voiceLevelSound->setVolume(m_volume);
-                }
-            }
-            if (key == sf::Keyboard::Key::RBracket) { // increase volume
-                m_volume = std::min(100.0f, m_volume + 10.0f);
-                if (!m_muted) {
-                    if (m_clearSound && m_clearSoundLoaded) m_clearSound->setVolume(m_volume);
-                    if (m_rotateSound && m_rotateSoundLoaded) m_rotateSound->setVolume(m_volume);
-                    if (m_dropSound && m_dropSoundLoaded) m_dropSound->setVolume(m_volume);
-                    if (m_hardDropSound && m_hardDropSoundLoaded) m_hardDropSound->setVolume(m_volume);
-                    if (m_uiClickSound && m_uiClickLoaded) { m_uiClickSound->setVolume(m_volume); m_uiClickSound->play(); }
-                    if (m_voiceLevelSound && m_voiceLevelLoaded) m_voiceLevelSound->setVolume(m_volume);
-                }
-            }
+            if (key == sf::Keyboard::Key::M) m_sounds.setMuted(!m_sounds.muted());
+            if (key == sf::Keyboard::Key::LBracket) setVolume(m_sounds.volume() - 10.0f);
+            if (key == sf::Keyboard::Key::RBracket) setVolume(m_sounds.volume() + 10.0f);
         }
-        
+
         // Mouse handling for volume slider
         if (event->is<sf::Event::MouseButtonPressed>()) {
             auto m = event->getIf<sf::Event::MouseButtonPressed>();
             if (m->button == sf::Mouse::Button::Left) {
-                    sf::Vector2i pos = m->position;
-                    if (m_volumeSliderRect.contains(sf::Vector2f(static_cast<float>(pos.x), static_cast<float>(pos.y)))) {
-                        m_draggingVolume = true;
-                        float rel = (pos.x - m_volumeSliderRect.position.x) / m_volumeSliderRect.size.x;
-                        m_volume = std::clamp(rel * 100.0f, 0.0f, 100.0f);
-                        if (!m_muted && m_uiClickSound && m_uiClickLoaded) m_uiClickSound->play();
-                        // update volumes
-                        if (!m_muted) {
-                            if (m_clearSound && m_clearSoundLoaded) m_clearSound->setVolume(m_volume);
-                            if (m_rotateSound && m_rotateSoundLoaded) m_rotateSound->setVolume(m_volume);
-                            if (m_dropSound && m_dropSoundLoaded) m_dropSound->setVolume(m_volume);
-                            if (m_hardDropSound && m_hardDropSoundLoaded) m_hardDropSound->setVolume(m_volume);
-                            if (m_voiceLevelSound && m_voiceLevelLoaded) m_voiceLevelSound->setVolume(m_volume);
-                        }
-                    }
+                sf::Vector2f pos(static_cast<float>(m->position.x), static_cast<float>(m->position.y));
+                if (m_volumeSliderRect.contains(pos)) {
+                    m_draggingVolume = true;
+                    setVolume((pos.x - m_volumeSliderRect.position.x) / m_volumeSliderRect.size.x * 100.0f);
                 }
+            }
         }
         if (event->is<sf::Event::MouseButtonReleased>()) {
             auto m = event->getIf<sf::Event::MouseButtonReleased>();
             if (m->button == sf::Mouse::Button::Left) m_draggingVolume = false;
         }
-        if (event->is<sf::Event::MouseMoved>()) {
-                if (m_draggingVolume) {
-                auto mm = event->getIf<sf::Event::MouseMoved>();
-                float mx = static_cast<float>(mm->position.x);
-                float rel = (mx - m_volumeSliderRect.position.x) / m_volumeSliderRect.size.x;
-                m_volume = std::clamp(rel * 100.0f, 0.0f, 100.0f);
-                if (!m_muted) {
-                    if (m_clearSound && m_clearSoundLoaded) m_clearSound->setVolume(m_volume);
-                    if (m_rotateSound && m_rotateSoundLoaded) m_rotateSound->setVolume(m_volume);
-                    if (m_dropSound && m_dropSoundLoaded) m_dropSound->setVolume(m_volume);
-                    if (m_hardDropSound && m_hardDropSoundLoaded) m_hardDropSound->setVolume(m_volume);
-                    if (m_uiClickSound && m_uiClickLoaded) m_uiClickSound->setVolume(m_volume);
-                    if (m_voiceLevelSound && m_voiceLevelLoaded) m_voiceLevelSound->setVolume(m_volume);
-                }
-            }
+        if (event->is<sf::Event::MouseMoved>() && m_draggingVolume) {
+            float mx = static_cast<float>(event->getIf<sf::Event::MouseMoved>()->position.x);
+            m_sounds.setVolume((mx - m_volumeSliderRect.position.x) / m_volumeSliderRect.size.x * 100.0f);
         }
     }
 }
 
-void Game::update(float dt) {
-    if (m_paused || !m_running) return;
-
-    // Handle line clear animation
-    if (m_animating) {
-        m_lineClearTimer += dt;
-        if (m_lineClearTimer >= m_lineClearDuration) {
-            // finalize clear
-            m_board.removeLines(m_linesToClear);
-            int n = static_cast<int>(m_linesToClear.size());
-            static const int baseScore[] = {0,100,300,500,800};
-            int gained = (n >=1 && n <=4) ? baseScore[n] * (m_level + 1) : 0;
-            m_score += gained;
-            m_totalLines += n;
-            int oldLevel = m_level;
-            m_level = m_totalLines / 10;
-            if (m_level > oldLevel && m_voiceLevelLoaded && m_voiceLevelSound && !m_muted) m_voiceLevelSound->play();
-            m_dropInterval = std::max(0.05f, 0.8f - m_level * 0.05f);
-            m_linesToClear.clear();
-            m_animating = false;
-            spawnPiece();
+void Game::handleKey(sf::Keyboard::Key key, bool pressed) {
+    Action action = Action::None;
+    AutoRepeat *repeat = nullptr;
+    switch (key) {
+    case sf::Keyboard::Key::Left: action = Action::Left; repeat = &m_leftRepeat; break;
+    case sf::Keyboard::Key::Right: action = Action::Right; repeat = &m_rightRepeat; break;
+    case sf::Keyboard::Key::Down: action = Action::SoftDrop; repeat = &m_downRepeat; break;
+    case sf::Keyboard::Key::Up: action = Action::Rotate; break;
+    case sf::Keyboard::Key::Space: action = Action::HardDrop; break;
+    default: return;
+    }
+
+    if (!pressed) {
+        if (repeat) repeat->release();
+        if (action == m_horizontal) {
+            // fall back to the other direction if it is still held
+            AutoRepeat &other = action == Action::Left ? m_rightRepeat : m_leftRepeat;
+            m_horizontal = other.held() ? (action == Action::Left ? Action::Right : Action::Left) : Action::None;
+            if (other.held()) other.press();
         }
         return;
     }
+    if (repeat) repeat->press();
+    if (repeat && action != Action::SoftDrop) m_horizontal = action;
 
-    m_dropTimer += dt;
-    if (m_dropTimer >= m_dropInterval) {
-        m_dropTimer = 0.0f;
-        auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-        Point newPos = m_active.position + Point{0,1};
-        if (m_board.isValidPosition(blocks, newPos)) {
-            m_active.position = newPos;
-        } else {
-            // lock piece
-            lockPiece();
-        }
+    // the clock starts when the event is read; it stops once a frame showing the change is displayed
+    auto polled = std::chrono::steady_clock::now();
+    if (applyAction(action) != events::None && !m_latencyPending) {
+        m_latencyPending = true;
+        m_inputTime = polled;
     }
 }
 
-void Game::lockPiece() {
-    auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-    m_board.place(blocks, m_active.position, static_cast<int>(m_active.type));
-    // Find full lines and start clear animation if any
-    m_linesToClear = m_board.getFullLines();
-    if (!m_linesToClear.empty()) {
-        m_animating = true;
-        m_lineClearTimer = 0.0f;
-        if (m_clearSoundLoaded && m_clearSound) m_clearSound->play();
-        return; // wait until animation completes to remove lines and score
+void Game::restart() {
+    std::uint32_t seed = std::random_device{}();
+    m_engine.reset(seed);
+    m_history.clear();
+    m_engine.snapshot(m_history.push());
+    if (m_recorder) m_recorder->reset(seed);
+    m_paused = false;
+    m_botPiece = -1;
+}
+
+void Game::rewind() {
+    // a replay only holds inputs, so it could not reproduce the jump
+    if (m_recorder) {
+        std::printf("rewind is disabled while recording a replay\n");
+        return;
     }
-    spawnPiece();
+    if (m_history.empty()) return;
+    // the newest snapshot is the spawn of the current piece; once the game
+    // is back there, step one piece further
+    if (m_history.size() > 1 && m_history.top().piecesPlaced == m_engine.piecesPlaced()) m_history.pop();
+    m_engine.restore(m_history.top());
+    m_botPiece = -1;
 }
 
-void Game::hardDrop() {
-    auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-    Point pos = m_active.position;
-    while (m_board.isValidPosition(blocks, pos + Point{0,1})) pos.y += 1;
-    m_active.position = pos;
-    lockPiece();
+void Game::update(std::uint32_t micros) {
+    if (m_paused) return;
+    updateRepeats(micros);
+    updateAutoplay();
+    // time is kept in whole microseconds so a replay sees the same ticks
+    if (m_recorder) m_recorder->tick(micros);
+    Events ev = m_engine.tick(replay::tickSeconds(micros));
+    if (ev & events::Spawned) m_engine.snapshot(m_history.push());
+    playEffects(ev);
 }
 
-void Game::render() {
-    m_window.clear(sf::Color::Black);
-
-    // draw board
-    for (int y = 0; y < BoardHeight; ++y) {
-        for (int x = 0; x < BoardWidth; ++x) {
-            int c = m_board.at(x,y).color;
-            if (c != -1) {
-                sf::RectangleShape r(sf::Vector2f(CellSize - 2, CellSize - 2));
-                r.setFillColor(colors[c]);
-                r.setPosition(sf::Vector2f(static_cast<float>(x * CellSize + 1), static_cast<float>(y * CellSize + 1)));
-                m_window.draw(r);
-            }
-        }
+void Game::updateRepeats(std::uint32_t micros) {
+    if (m_horizontal != Action::None) {
+        AutoRepeat &repeat = m_horizontal == Action::Left ? m_leftRepeat : m_rightRepeat;
+        for (int n = repeat.advance(micros); n > 0; --n)
+            if (!(applyAction(m_horizontal) & events::Moved)) break;
     }
+    for (int n = m_downRepeat.advance(micros); n > 0; --n)
+        if (!(applyAction(Action::SoftDrop) & events::SoftDropped)) break;
+}
 
-    // draw active piece
-    if (m_running) {
-        auto blocks = Tetromino::getShape(m_active.type, m_active.rotation)[m_active.rotation];
-        for (const auto &b : blocks) {
-            Point p = m_active.position + b;
-            if (p.y >= 0) {
-                sf::RectangleShape r(sf::Vector2f(CellSize - 2, CellSize - 2));
-                r.setFillColor(colors[static_cast<int>(m_active.type)]);
-                r.setPosition(sf::Vector2f(static_cast<float>(p.x * CellSize + 1), static_cast<float>(p.y * CellSize + 1)));
-                m_window.draw(r);
-            }
-        }
+void Game::updateAutoplay() {
+    if (!m_autoplay || !m_engine.running() || m_engine.animating()) return;
+    auto now = std::chrono::steady_clock::now();
+    if (m_botPiece != m_engine.piecesPlaced()) {
+        // new piece: search until half the drop interval is used up
+        m_botPiece = m_engine.piecesPlaced();
+        m_bot->start(m_engine.board(), m_engine.active(), m_engine.next());
+        m_botDeadline = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float>(m_engine.dropInterval() * 0.5f));
+        return;
     }
+    if (!m_bot->done() && now < m_botDeadline) return;
 
-    // If animating line clear, draw pulsing overlay on clearing rows
-    if (m_animating) {
-        float t = m_lineClearTimer / m_lineClearDuration; // 0..1
-        float alpha = 160.0f * (1.0f - std::cos(t * 3.14159f)); // fade in/out
-        for (int y : m_linesToClear) {
-            for (int x = 0; x < BoardWidth; ++x) {
-                sf::RectangleShape r(sf::Vector2f(CellSize - 2, CellSize - 2));
-                unsigned char a = static_cast<unsigned char>(std::clamp(alpha, 0.f, 255.f));
-                sf::Color c(255,255,255,a);
-                r.setFillColor(c);
-                r.setPosition(sf::Vector2f(static_cast<float>(x * CellSize + 1), static_cast<float>(y * CellSize + 1)));
-                m_window.draw(r);
-            }
-        }
+    // Gravity may have moved the piece since the search started, so plan the
+    // input path from where it is now and fall back to a plain hard drop.
+    Placement target;
+    ActionPath path;
+    m_botPathGen->generate(m_engine.board(), m_engine.active(), *m_botPlacements);
+    if (m_bot->best(target) && m_botPathGen->pathTo(target, path)) {
+        for (int i = 0; i < path.count; ++i) applyAction(path.actions[i]);
+    } else {
+        applyAction(Action::HardDrop);
     }
+}
 
-    // draw simple UI: score and next piece (if font loaded)
-    if (m_fontLoaded) {
-        std::stringstream ss;
-        ss << "Score: " << m_score << "\nLevel: " << m_level << "\nLines: " << m_totalLines;
-        sf::Text text(m_font, ss.str(), 16);
-        text.setFillColor(sf::Color::White);
-        text.setPosition(sf::Vector2f(static_cast<float>(BoardWidth * CellSize + 10), 10.f));
-        m_window.draw(text);
+void Game::refreshHudText() {
+    char buf[64];
+    if (m_statsText && (m_engine.score() != m_shownScore || m_engine.level() != m_shownLevel || m_engine.lines() != m_shownLines)) {
+        m_shownScore = m_engine.score();
+        m_shownLevel = m_engine.level();
+        m_shownLines = m_engine.lines();
+        std::snprintf(buf, sizeof(buf), "Score: %d\nLevel: %d\nLines: %d", m_shownScore, m_shownLevel, m_shownLines);
+        m_statsText->setString(buf);
     }
+    int volume = static_cast<int>(m_sounds.volume());
+    if (m_volumeText && (volume != m_shownVolume || m_sounds.muted() != m_shownMuted)) {
+        m_shownVolume = volume;
+        m_shownMuted = m_sounds.muted();
+        if (m_shownMuted) std::snprintf(buf, sizeof(buf), "Muted"); else std::snprintf(buf, sizeof(buf), "%d%%", volume);
+        m_volumeText->setString(buf);
+    }
+    if (m_latencyText && m_latencyTotal != m_shownLatencyTotal) {
+        m_shownLatencyTotal = m_latencyTotal;
+        std::snprintf(buf, sizeof(buf), "Input lag: %.1f ms\n(p95 %.1f ms)", m_latencyMean, m_latencyP95);
+        m_latencyText->setString(buf);
+    }
+    if (m_allocText && m_frameAllocations != m_shownAllocations) {
+        m_shownAllocations = m_frameAllocations;
+        std::snprintf(buf, sizeof(buf), "Allocs/frame: %llu", static_cast<unsigned long long>(m_frameAllocations));
+        m_allocText->setString(buf);
+    }
+}
 
-    // draw volume slider UI on the right side
+void Game::render(float sinceStep) {
+    draw(m_window, sinceStep);
+    TETRIS_PROFILE_SCOPE("render.display");
+    m_window.display();
+}
+
+void Game::draw(sf::RenderTarget &target, float sinceStep) {
+    const float sx = static_cast<float>(BoardWidth * CellSize + 10);
+    const float sy = static_cast<float>(static_cast<int>(target.getSize().y) - 40);
+    const float sw = 160.0f;
+    const float sh = 12.0f;
+    const float fillW = (m_sounds.volume() / 100.0f) * sw;
     {
-        float sx = static_cast<float>(BoardWidth * CellSize + 10);
-        float sy = static_cast<float>(static_cast<int>(m_window.getSize().y) - 40);
-        float sw = 160.0f;
-        float sh = 12.0f;
-        m_volumeSliderRect = sf::FloatRect(sf::Vector2f(sx, sy), sf::Vector2f(sw, sh));
+        TETRIS_PROFILE_SCOPE("render.board");
+        target.clear(sf::Color::Black);
 
-        sf::RectangleShape bg(sf::Vector2f(sw, sh));
-        bg.setFillColor(sf::Color(80,80,80));
-        bg.setPosition(sf::Vector2f(sx, sy));
-        m_window.draw(bg);
-
-        float fillW = (m_volume / 100.0f) * sw;
-        sf::RectangleShape fill(sf::Vector2f(fillW, sh));
-        fill.setFillColor(sf::Color(200,200,200));
-        fill.setPosition(sf::Vector2f(sx, sy));
-        m_window.draw(fill);
-
-        // knob
-        sf::CircleShape knob(7.f);
-        knob.setFillColor(sf::Color::White);
-        knob.setPosition(sf::Vector2f(sx + std::max(0.f, fillW - 7.f), sy - 3.f));
-        m_window.draw(knob);
-
-        // volume text
-        if (m_fontLoaded) {
-            std::stringstream vs;
-            if (m_muted) vs << "Muted"; else vs << static_cast<int>(m_volume) << "%";
-            sf::Text vtext(m_font, vs.str(), 12);
-            vtext.setFillColor(sf::Color::White);
-            vtext.setPosition(sf::Vector2f(sx, sy - 20.f));
-            m_window.draw(vtext);
+        // board, active piece, line clear pulse and HUD rectangles in one batch
+        m_renderer.update(m_engine, m_paused ? 0.0f : sinceStep);
+        m_volumeSliderRect = sf::FloatRect(sf::Vector2f(sx, sy), sf::Vector2f(sw, sh));
+        m_renderer.setRect(HudRect::SliderBack, m_volumeSliderRect, sf::Color(80,80,80));
+        m_renderer.setRect(HudRect::SliderFill, sf::FloatRect(sf::Vector2f(sx, sy), sf::Vector2f(fillW, sh)), sf::Color(200,200,200));
+        if (!m_engine.running()) {
+            m_renderer.setRect(HudRect::GameOverShade, sf::FloatRect(sf::Vector2f(0.f, static_cast<float>(BoardHeight * CellSize/2 - 30)),
+                               sf::Vector2f(static_cast<float>(BoardWidth * CellSize), 60.f)), sf::Color(0,0,0,160));
+        } else {
+            m_renderer.setRect(HudRect::GameOverShade, sf::FloatRect(), sf::Color::Transparent);
         }
+        if (m_showProfiler && m_profilerText) {
+            m_renderer.setRect(HudRect::ProfilerShade, sf::FloatRect(sf::Vector2f(4.f, 4.f), sf::Vector2f(static_cast<float>(BoardWidth * CellSize + 180), 170.f)),
+                               sf::Color(0,0,0,200));
+        } else {
+            m_renderer.setRect(HudRect::ProfilerShade, sf::FloatRect(), sf::Color::Transparent);
+        }
+        m_renderer.draw(target);
     }
+    {
+        TETRIS_PROFILE_SCOPE("render.hud");
+        // score, level and lines
+        refreshHudText();
+        if (m_statsText) target.draw(*m_statsText);
+        if (m_allocText) target.draw(*m_allocText);
+        if (m_latencyText && m_latencyTotal) target.draw(*m_latencyText);
+
+        // volume slider knob and label on the right side
+        m_knob.setPosition(sf::Vector2f(sx + std::max(0.f, fillW - 7.f), sy - 3.f));
+        target.draw(m_knob);
+        if (m_volumeText) {
+            m_volumeText->setPosition(sf::Vector2f(sx, sy - 20.f));
+            target.draw(*m_volumeText);
+        }
+
+        if (!m_engine.running() && m_gameOverText) target.draw(*m_gameOverText);
 
-    if (!m_running) {
-        sf::RectangleShape overlay(sf::Vector2f(static_cast<float>(BoardWidth * CellSize), 60.f));
-        overlay.setFillColor(sf::Color(0,0,0,160));
-        overlay.setPosition(sf::Vector2f(0.f, static_cast<float>(BoardHeight * CellSize/2 - 30)));
-        m_window.draw(overlay);
-        if (m_fontLoaded) {
-            sf::Text text(m_font, "Game Over - Press R to restart", 20);
-            text.setFillColor(sf::Color::White);
-            text.setPosition(sf::Vector2f(10.f, static_cast<float>(BoardHeight * CellSize / 2.f - 20.f)));
-            m_window.draw(text);
+        if (m_showProfiler && m_profilerText) {
+            refreshProfilerText();
+            target.draw(*m_profilerText);
         }
     }
+}
 
-    m_window.display();
+void Game::waitForAssets() {
+    if (m_pendingAssets.valid()) installAssets(m_pendingAssets.get());
+}
+
+void Game::restore(const Engine::Snapshot &snapshot) {
+    m_engine.restore(snapshot);
+    m_history.clear();
+    m_engine.snapshot(m_history.push());
+}
+
+void Game::refreshProfilerText() {
+    std::uint64_t now = profiler::now();
+    int frames = static_cast<int>(std::min<std::uint64_t>(m_frameCount, FrameSamples));
+    if (now < m_profilerRefresh || frames == 0) return;
+    m_profilerRefresh = now + 250000000; // 4 updates per second
+
+    std::array<float, FrameSamples> sorted = m_frameTimes;
+    std::sort(sorted.begin(), sorted.begin() + frames);
+    auto percentile = [&](int p) { return sorted[(frames - 1) * p / 100]; };
+    char text[1024];
+    int len = std::snprintf(text, sizeof(text), "Frame ms (last %d): p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+                            frames, percentile(50), percentile(95), percentile(99), sorted[frames - 1]);
+
+    // per-zone time per frame over the last second, all threads
+    profiler::ZoneTotal totals[24];
+    const std::uint64_t window = 1000000000;
+    int n = profiler::summarize(now > window ? now - window : 0, totals, 24);
+    std::sort(totals, totals + n, [](const profiler::ZoneTotal &a, const profiler::ZoneTotal &b) { return a.nanos > b.nanos; });
+    std::uint32_t frameZones = 0;
+    for (int i = 0; i < n; ++i)
+        if (std::strcmp(totals[i].name, "frame") == 0) frameZones = totals[i].count;
+    if (frameZones == 0) frameZones = 1;
+    for (int i = 0; i < n && len < static_cast<int>(sizeof(text)); ++i) {
+        len += std::snprintf(text + len, sizeof(text) - static_cast<std::size_t>(len), "%-22s %7.3f ms/frame  %5.1fx\n", totals[i].name,
+                             static_cast<double>(totals[i].nanos) * 1e-6 / frameZones,
+                             static_cast<double>(totals[i].count) / frameZones);
+    }
+    m_profilerText->setString(text);
+}
+
+void Game::recordLatency() {
+    if (!m_latencyPending) return;
+    m_latencyPending = false;
+    std::chrono::duration<float, std::milli> ms = std::chrono::steady_clock::now() - m_inputTime;
+    m_latency[m_latencyTotal % LatencySamples] = ms.count();
+    ++m_latencyTotal;
+
+    int count = static_cast<int>(std::min<std::uint64_t>(m_latencyTotal, LatencySamples));
+    std::array<float, LatencySamples> sorted = m_latency;
+    std::sort(sorted.begin(), sorted.begin() + count);
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) sum += sorted[i];
+    m_latencyMean = sum / static_cast<float>(count);
+    m_latencyP95 = sorted[(count - 1) * 95 / 100];
 }
 
 void Game::run() {
     sf::Clock clock;
     while (m_window.isOpen()) {
-        float dt = clock.restart().asSeconds();
-        processInput();
-        update(dt);
-        render();
+        std::uint64_t allocationsBefore = allocationCount();
+        TETRIS_PROFILE_SCOPE("frame");
+        std::int64_t frameMicros = clock.restart().asMicroseconds();
+        m_frameTimes[m_frameCount++ % FrameSamples] = static_cast<float>(frameMicros) * 1e-3f;
+        auto micros = static_cast<std::uint32_t>(std::min<std::int64_t>(frameMicros, MaxFrameMicros));
+        // key presses are applied as soon as they are read, between logic steps
+        {
+            TETRIS_PROFILE_SCOPE("Game::processInput");
+            processInput();
+        }
+        m_accumulator += micros;
+        while (m_accumulator >= LogicStepMicros) {
+            TETRIS_PROFILE_SCOPE("Game::update");
+            update(LogicStepMicros);
+            m_accumulator -= LogicStepMicros;
+        }
+        render(static_cast<float>(m_accumulator) * 1e-6f);
+        recordLatency();
+        if (!m_firstFrameShown) {
+            m_firstFrameShown = true;
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+            std::printf("first frame after %.1f ms\n", ms);
+        }
+        if (m_pendingAssets.valid() && m_pendingAssets.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            installAssets(m_pendingAssets.get());
+        m_frameAllocations = allocationCount() - allocationsBefore;
+    }
+    if (!m_tracePath.empty()) {
+        if (profiler::writeChromeTrace(m_tracePath)) std::printf("trace written to %s\n", m_tracePath.c_str());
+        else std::printf("could not write trace %s\n", m_tracePath.c_str());
+    }
+    if (m_latencyTotal)
+        std::printf("input latency over the last %d presses: mean %.1f ms, p95 %.1f ms\n",
+                    static_cast<int>(std::min<std::uint64_t>(m_latencyTotal, LatencySamples)), m_latencyMean, m_latencyP95);
+    if (m_recorder) {
+        m_recorder->finish(m_engine);
+        m_recorder->save(m_recordPath);
     }
 }
@@ -0,0 +1,156 @@
+#include "../../include/tetris/MoveGen.hpp"
+#include <algorithm>
+#include <memory>
+
+using namespace tetris;
+
+// States are stored with a margin of 4 cells on every side of the board.
+static constexpr int Margin = 4;
+
+MoveGenerator::MoveGenerator() {
+    m_visited.fill(0);
+    m_keyStamp.fill(0);
+}
+
+int MoveGenerator::stateIndex(int rotation, Point pos) {
+    int x = pos.x + Margin, y = pos.y + Margin;
+    if (x < 0 || x >= MoveGenXSpan || y < 0 || y >= MoveGenYSpan) return -1;
+    return ((rotation & 3) * MoveGenYSpan + y) * MoveGenXSpan + x;
+}
+
+bool MoveGenerator::insertKey(std::uint64_t key) {
+    std::uint32_t slot = static_cast<std::uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 52) & (KeySlots - 1);
+    while (m_keyStamp[slot] == m_stamp) {
+        if (m_keys[slot] == key) return false;
+        slot = (slot + 1) & (KeySlots - 1);
+    }
+    m_keyStamp[slot] = m_stamp;
+    m_keys[slot] = key;
+    return true;
+}
+
+// Identifies the set of cells a piece covers, independent of rotation and origin.
+static std::uint64_t cellKey(const ShapeInfo &shape, Point pos) {
+    std::array<std::uint16_t,4> c;
+    for (int i = 0; i < 4; ++i) {
+        Point p = pos + shape.blocks[i];
+        c[i] = static_cast<std::uint16_t>((p.y + Margin) * 64 + p.x);
+    }
+    std::sort(c.begin(), c.end());
+    return (std::uint64_t{c[0]} << 48) | (std::uint64_t{c[1]} << 32) | (std::uint64_t{c[2]} << 16) | c[3];
+}
+
+void MoveGenerator::generate(const Board &board, const Tetromino &start, PlacementList &out) {
+    out.clear();
+    if (++m_stamp == 0) { // wrapped: forget every stamp
+        m_visited.fill(0);
+        m_keyStamp.fill(0);
+        m_stamp = 1;
+    }
+    m_startIndex = stateIndex(start.rotation, start.position);
+    if (m_startIndex < 0 || !board.isValidPosition(Tetromino::shape(start.type, start.rotation), start.position)) {
+        m_startIndex = -1;
+        return;
+    }
+
+    int head = 0, tail = 0;
+    m_visited[m_startIndex] = m_stamp;
+    m_parent[m_startIndex] = -1;
+    m_queue[tail++] = static_cast<std::int16_t>(m_startIndex);
+
+    auto visit = [&](int from, int rotation, Point pos, Action via) {
+        int idx = stateIndex(rotation, pos);
+        if (idx < 0 || m_visited[idx] == m_stamp) return;
+        if (!board.isValidPosition(Tetromino::shape(start.type, rotation), pos)) return;
+        m_visited[idx] = m_stamp;
+        m_parent[idx] = static_cast<std::int16_t>(from);
+        m_via[idx] = via;
+        m_queue[tail++] = static_cast<std::int16_t>(idx);
+    };
+
+    while (head < tail) {
+        int idx = m_queue[head++];
+        int rotation = idx / (MoveGenXSpan * MoveGenYSpan);
+        Point pos{idx % MoveGenXSpan - Margin, (idx / MoveGenXSpan) % MoveGenYSpan - Margin};
+        const ShapeInfo &shape = Tetromino::shape(start.type, rotation);
+
+        visit(idx, rotation, pos + Point{-1,0}, Action::Left);
+        visit(idx, rotation, pos + Point{1,0}, Action::Right);
+        visit(idx, rotation, pos + Point{0,1}, Action::SoftDrop);
+        int newRot = (rotation + 1) & 3;
+        const KickList &kicks = Tetromino::kicks(start.type, rotation);
+        for (int k = 0; k < kicks.count; ++k) {
+            Point kicked = pos + kicks.offsets[k];
+            if (board.isValidPosition(Tetromino::shape(start.type, newRot), kicked)) {
+                visit(idx, newRot, kicked, Action::Rotate);
+                break;
+            }
+        }
+
+        // resting states are lock positions
+        if (!board.isValidPosition(shape, pos + Point{0,1}) && insertKey(cellKey(shape, pos)))
+            out.items[out.count++] = Placement{start.type, rotation, pos};
+    }
+}
+
+bool MoveGenerator::pathTo(const Placement &p, ActionPath &path) const {
+    path.count = 0;
+    int idx = stateIndex(p.rotation, p.position);
+    if (idx < 0 || m_startIndex < 0 || m_visited[idx] != m_stamp) return false;
+    for (int i = idx; i != m_startIndex; i = m_parent[i]) {
+        if (path.count + 1 >= static_cast<int>(path.actions.size())) return false;
+        path.actions[path.count++] = m_via[i];
+    }
+    std::reverse(path.actions.begin(), path.actions.begin() + path.count);
+    path.actions[path.count++] = Action::HardDrop;
+    return true;
+}
+
+namespace {
+
+struct PerftContext {
+    MoveGenerator gen;
+    const TetrominoType *queue = nullptr;
+    int queueLength = 0;
+    TranspositionTable *table = nullptr;
+};
+
+} // namespace
+
+static std::uint64_t perftRecursive(PerftContext &ctx, const Board &board, int ply, int depth) {
+    // the queue suffix follows from the ply, so (board, ply, depth) fixes the count
+    std::uint64_t key = 0;
+    if (ctx.table && depth > 1) {
+        TetrominoType preview = ply + 1 < ctx.queueLength ? ctx.queue[ply + 1] : TetrominoType::Count;
+        key = TranspositionTable::key(board.hash(), ctx.queue[ply], preview)
+            ^ detail::splitmix64(static_cast<std::uint64_t>(ply) << 8 | static_cast<std::uint64_t>(depth));
+        std::uint64_t cached;
+        if (ctx.table->probe(key, cached)) return cached;
+    }
+
+    PlacementList placements;
+    ctx.gen.generate(board, Tetromino{ctx.queue[ply], 0, SpawnPosition}, placements);
+    if (depth == 1) return static_cast<std::uint64_t>(placements.size());
+
+    std::uint64_t nodes = 0;
+    for (const Placement &p : placements) {
+        Board child = board;
+        const ShapeInfo &shape = Tetromino::shape(p.type, p.rotation);
+        child.place(shape.blocks, p.position, static_cast<int>(p.type));
+        child.removeLines(child.getFullLines(p.position.y + shape.minY, p.position.y + shape.maxY));
+        nodes += perftRecursive(ctx, child, ply + 1, depth - 1);
+    }
+    if (ctx.table) ctx.table->store(key, nodes);
+    return nodes;
+}
+
+std::uint64_t tetris::perft(const Board &board, const TetrominoType *queue, int queueLength, int depth,
+                            TranspositionTable *table) {
+    if (depth <= 0) return 1;
+    if (depth > queueLength) return 0;
+    auto ctx = std::make_unique<PerftContext>();
+    ctx->queue = queue;
+    ctx->queueLength = queueLength;
+    ctx->table = table;
+    return perftRecursive(*ctx, board, 0, depth);
+}
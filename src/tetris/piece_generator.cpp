@@ -0,0 +1,102 @@
+#include "../../include/tetris/PieceGenerator.hpp"
+#include "../../include/tetris/Board.hpp"
+#include <cstring>
+#include <utility>
+
+using namespace tetris;
+
+namespace {
+
+constexpr std::uint64_t Gamma = 0x9E3779B97F4A7C15ull;
+constexpr int HistoryRolls = 4;
+
+// Key of stream `stream` under `parent`; both go through the mixer so
+// neighbouring seeds and indices land far apart.
+std::uint64_t streamKey(std::uint64_t parent, std::uint64_t stream) {
+    return detail::splitmix64(parent ^ detail::splitmix64(stream * Gamma + 0x632BE59BD9B4E019ull));
+}
+
+} // namespace
+
+const char* tetris::randomizerName(Randomizer mode) {
+    switch (mode) {
+    case Randomizer::Bag7: return "bag7";
+    case Randomizer::Uniform: return "uniform";
+    case Randomizer::History: return "history";
+    default: return "?";
+    }
+}
+
+bool tetris::parseRandomizer(const char *name, Randomizer &out) {
+    for (int i = 0; i < static_cast<int>(Randomizer::Count); ++i) {
+        if (std::strcmp(name, randomizerName(static_cast<Randomizer>(i))) == 0) {
+            out = static_cast<Randomizer>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+PieceGenerator::PieceGenerator(std::uint64_t seed, std::uint64_t stream, Randomizer mode)
+    : m_key(streamKey(detail::splitmix64(seed), stream)), m_stream(stream), m_seed(seed), m_mode(mode) {
+    m_history = {TetrominoType::Z, TetrominoType::S, TetrominoType::Z, TetrominoType::S};
+}
+
+PieceGenerator PieceGenerator::split(std::uint64_t index) const {
+    // The child is stream `index` of a seed derived from this generator's
+    // key, so its seed() and stream() rebuild it like any other generator.
+    return PieceGenerator(detail::splitmix64(m_key), index, m_mode);
+}
+
+int PieceGenerator::below(int n) {
+    std::uint64_t r = detail::splitmix64(m_key + m_counter++ * Gamma);
+    // multiply-shift instead of modulo; bias is below 2^-29 for n <= 7
+    return static_cast<int>(((r >> 32) * static_cast<std::uint64_t>(n)) >> 32);
+}
+
+void PieceGenerator::refillBag() {
+    for (int i = 0; i < 7; ++i) m_bag[i] = static_cast<TetrominoType>(i);
+    for (int i = 6; i > 0; --i) std::swap(m_bag[i], m_bag[below(i + 1)]);
+    m_bagIndex = 0;
+}
+
+TetrominoType PieceGenerator::next() {
+    TetrominoType piece;
+    switch (m_mode) {
+    case Randomizer::Bag7:
+        if (m_bagIndex == 7) refillBag();
+        piece = m_bag[m_bagIndex++];
+        break;
+    case Randomizer::History: {
+        auto seen = [&](TetrominoType t) {
+            return t == m_history[0] || t == m_history[1] || t == m_history[2] || t == m_history[3];
+        };
+        if (m_dealt == 0) {
+            // I, T, J or L
+            static const TetrominoType First[] = {TetrominoType::I, TetrominoType::T, TetrominoType::J, TetrominoType::L};
+            piece = First[below(4)];
+        } else {
+            piece = static_cast<TetrominoType>(below(7));
+            for (int roll = 1; roll < HistoryRolls && seen(piece); ++roll) piece = static_cast<TetrominoType>(below(7));
+        }
+        m_history = {piece, m_history[0], m_history[1], m_history[2]};
+        break;
+    }
+    default:
+        piece = static_cast<TetrominoType>(below(7));
+        break;
+    }
+    ++m_dealt;
+    return piece;
+}
+
+TetrominoType PieceGenerator::peek(int i) const {
+    PieceGenerator copy = *this;
+    while (i-- > 0) copy.next();
+    return copy.next();
+}
+
+void PieceGenerator::peek(TetrominoType *out, int n) const {
+    PieceGenerator copy = *this;
+    for (int i = 0; i < n; ++i) out[i] = copy.next();
+}
@@ -0,0 +1,69 @@
+#include "../../include/tetris/Policy.hpp"
+#include <limits>
+
+using namespace tetris;
+
+RandomPolicy::RandomPolicy(std::uint32_t seed)
+    : m_rng(seed), m_gen(std::make_unique<MoveGenerator>()), m_placements(std::make_unique<PlacementList>()) {}
+
+void RandomPolicy::plan(const Engine &engine, ActionPath &path) {
+    path.count = 0;
+    m_gen->generate(engine.board(), engine.active(), *m_placements);
+    if (m_placements->empty() || !m_gen->pathTo((*m_placements)[static_cast<int>(m_rng() % m_placements->size())], path)) {
+        path.actions[0] = Action::HardDrop;
+        path.count = 1;
+    }
+}
+
+GreedyPolicy::GreedyPolicy(BotWeights weights)
+    : m_weights(weights), m_gen(std::make_unique<MoveGenerator>()), m_placements(std::make_unique<PlacementList>()) {}
+
+void GreedyPolicy::plan(const Engine &engine, ActionPath &path) {
+    path.count = 0;
+    m_gen->generate(engine.board(), engine.active(), *m_placements);
+    int best = -1;
+    double bestScore = -std::numeric_limits<double>::infinity();
+    for (int i = 0; i < m_placements->size(); ++i) {
+        const Placement &p = (*m_placements)[i];
+        Board child = engine.board();
+        const ShapeInfo &shape = Tetromino::shape(p.type, p.rotation);
+        child.place(shape.blocks, p.position, static_cast<int>(p.type));
+        LineList full = child.getFullLines(p.position.y + shape.minY, p.position.y + shape.maxY);
+        child.removeLines(full);
+        double score = Bot::evaluate(child, full.size(), m_weights);
+        if (score > bestScore) { bestScore = score; best = i; }
+    }
+    if (best < 0 || !m_gen->pathTo((*m_placements)[best], path)) {
+        path.actions[0] = Action::HardDrop;
+        path.count = 1;
+    }
+}
+
+ScriptedPolicy::ScriptedPolicy(const std::string &script) {
+    for (char ch : script) {
+        Action a = Action::None;
+        switch (ch) {
+        case 'L': a = Action::Left; break;
+        case 'R': a = Action::Right; break;
+        case 'D': a = Action::SoftDrop; break;
+        case 'U': a = Action::Rotate; break;
+        case 'H': a = Action::HardDrop; break;
+        default: break;
+        }
+        if (a != Action::None && m_script.count + 1 < static_cast<int>(m_script.actions.size()))
+            m_script.actions[m_script.count++] = a;
+    }
+    if (m_script.count == 0 || m_script.actions[m_script.count - 1] != Action::HardDrop)
+        m_script.actions[m_script.count++] = Action::HardDrop;
+}
+
+void ScriptedPolicy::plan(const Engine &, ActionPath &path) {
+    path = m_script;
+}
+
+std::unique_ptr<Policy> tetris::makePolicy(const std::string &name, std::uint32_t seed, const std::string &script) {
+    if (name == "random") return std::make_unique<RandomPolicy>(seed);
+    if (name == "greedy") return std::make_unique<GreedyPolicy>();
+    if (name == "scripted") return std::make_unique<ScriptedPolicy>(script);
+    return nullptr;
+}
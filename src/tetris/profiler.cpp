@@ -0,0 +1,155 @@
+#include "../../include/tetris/Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace tetris;
+using namespace tetris::profiler;
+
+namespace {
+
+// Single-writer ring. Each slot carries a sequence number that is odd while
+// the owner writes it, so readers on other threads can detect torn or
+// overwritten slots without locking the writer.
+struct Slot {
+    std::atomic<std::uint64_t> seq{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<std::uint64_t> begin{0};
+    std::atomic<std::uint64_t> end{0};
+};
+
+struct ThreadRing {
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<const char*> threadName{nullptr};
+    Slot slots[RingCapacity];
+};
+
+// Rings live until exit so readers never see a freed buffer.
+std::atomic<ThreadRing*> g_rings[MaxThreads];
+std::atomic<int> g_ringCount{0};
+thread_local ThreadRing *t_ring = nullptr;
+thread_local bool t_noRing = false;
+
+const auto g_epoch = std::chrono::steady_clock::now();
+
+ThreadRing* ownRing() {
+    if (t_ring || t_noRing) return t_ring;
+    int index = g_ringCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MaxThreads) {
+        t_noRing = true;
+        return nullptr;
+    }
+    t_ring = new ThreadRing;
+    g_rings[index].store(t_ring, std::memory_order_release);
+    return t_ring;
+}
+
+// Visit every intact zone of every thread that ended at or after since.
+template <typename F>
+void forEachZone(std::uint64_t since, F &&visit) {
+    int threads = std::min(g_ringCount.load(std::memory_order_acquire), MaxThreads);
+    for (int t = 0; t < threads; ++t) {
+        ThreadRing *ring = g_rings[t].load(std::memory_order_acquire);
+        if (!ring) continue; // registered but not published yet
+        std::uint64_t written = ring->written.load(std::memory_order_acquire);
+        std::uint64_t first = written > RingCapacity ? written - RingCapacity : 0;
+        for (std::uint64_t i = first; i < written; ++i) {
+            const Slot &slot = ring->slots[i & (RingCapacity - 1)];
+            std::uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            Zone zone{slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed),
+                      slot.end.load(std::memory_order_relaxed), t};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq != 2 * i + 2 || slot.seq.load(std::memory_order_relaxed) != seq) continue;
+            if (zone.end >= since) visit(zone);
+        }
+    }
+}
+
+void writeJsonString(std::FILE *f, const char *s) {
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        if (static_cast<unsigned char>(*s) >= 0x20) std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+} // namespace
+
+void profiler::setEnabled(bool on) { g_enabled.store(on, std::memory_order_relaxed); }
+
+std::uint64_t profiler::now() {
+    // +1 so a valid timestamp is never 0, which Scope uses for "not recording"
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_epoch).count()) + 1;
+}
+
+void profiler::record(const char *name, std::uint64_t begin, std::uint64_t end) {
+    ThreadRing *ring = ownRing();
+    if (!ring) return;
+    std::uint64_t i = ring->written.load(std::memory_order_relaxed);
+    Slot &slot = ring->slots[i & (RingCapacity - 1)];
+    slot.seq.store(2 * i + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.seq.store(2 * i + 2, std::memory_order_release);
+    ring->written.store(i + 1, std::memory_order_release);
+}
+
+void profiler::setThreadName(const char *name) {
+    if (ThreadRing *ring = ownRing()) ring->threadName.store(name, std::memory_order_relaxed);
+}
+
+void profiler::collect(std::uint64_t since, std::vector<Zone> &out) {
+    forEachZone(since, [&](const Zone &zone) { out.push_back(zone); });
+}
+
+int profiler::summarize(std::uint64_t since, ZoneTotal *out, int capacity) {
+    int count = 0;
+    forEachZone(since, [&](const Zone &zone) {
+        int i = 0;
+        while (i < count && out[i].name != zone.name) ++i;
+        if (i == count) {
+            if (count == capacity) return;
+            out[count++] = ZoneTotal{zone.name, 0, 0};
+        }
+        out[i].nanos += zone.end - zone.begin;
+        ++out[i].count;
+    });
+    return count;
+}
+
+bool profiler::writeChromeTrace(const std::string &path) {
+    std::vector<Zone> zones;
+    collect(0, zones);
+    std::sort(zones.begin(), zones.end(), [](const Zone &a, const Zone &b) { return a.begin < b.begin; });
+
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    bool first = true;
+    int threads = std::min(g_ringCount.load(std::memory_order_acquire), MaxThreads);
+    for (int t = 0; t < threads; ++t) {
+        ThreadRing *ring = g_rings[t].load(std::memory_order_acquire);
+        const char *name = ring ? ring->threadName.load(std::memory_order_relaxed) : nullptr;
+        if (!name) continue;
+        std::fprintf(f, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", t);
+        writeJsonString(f, name);
+        std::fputs("}}", f);
+        first = false;
+    }
+    for (const Zone &z : zones) {
+        // trace timestamps are microseconds
+        std::fprintf(f, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                     first ? "" : ",\n", z.thread, static_cast<double>(z.begin) * 1e-3,
+                     static_cast<double>(z.end - z.begin) * 1e-3);
+        writeJsonString(f, z.name);
+        std::fputc('}', f);
+        first = false;
+    }
+    std::fputs("\n]}\n", f);
+    return std::fclose(f) == 0;
+}
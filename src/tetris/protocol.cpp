@@ -0,0 +1,150 @@
+#include "../../include/tetris/Protocol.hpp"
+
+using namespace tetris;
+using namespace tetris::protocol;
+
+namespace {
+
+struct Writer {
+    std::uint8_t *begin;
+    std::uint8_t *p;
+
+    Writer(std::uint8_t *out, MsgType type) : begin(out), p(out + HeaderSize) { out[1] = static_cast<std::uint8_t>(type); }
+    void u8(std::uint8_t v) { *p++ = v; }
+    void u16(std::uint16_t v) { u8(static_cast<std::uint8_t>(v)); u8(static_cast<std::uint8_t>(v >> 8)); }
+    void u32(std::uint32_t v) { u16(static_cast<std::uint16_t>(v)); u16(static_cast<std::uint16_t>(v >> 16)); }
+    void u64(std::uint64_t v) { u32(static_cast<std::uint32_t>(v)); u32(static_cast<std::uint32_t>(v >> 32)); }
+    std::size_t finish() {
+        begin[0] = static_cast<std::uint8_t>(p - begin - HeaderSize);
+        return static_cast<std::size_t>(p - begin);
+    }
+};
+
+// Reads a payload whose length was already checked against the message size.
+struct Reader {
+    const std::uint8_t *p;
+    const std::uint8_t *end;
+
+    bool has(std::size_t n) const { return static_cast<std::size_t>(end - p) >= n; }
+    std::uint8_t u8() { return *p++; }
+    std::uint16_t u16() { std::uint16_t v = u8(); return static_cast<std::uint16_t>(v | (u8() << 8)); }
+    std::uint32_t u32() { std::uint32_t v = u16(); return v | (static_cast<std::uint32_t>(u16()) << 16); }
+    std::uint64_t u64() { std::uint64_t v = u32(); return v | (static_cast<std::uint64_t>(u32()) << 32); }
+};
+
+constexpr std::size_t StartSize = 17;
+constexpr std::size_t InputSize = 3;
+constexpr std::size_t StateSize = 22;
+constexpr std::size_t RowsSize = 2 * BoardHeight;
+constexpr std::size_t GameOverSize = 10;
+
+} // namespace
+
+std::size_t protocol::encode(const Start &msg, std::uint8_t *out) {
+    Writer w(out, MsgType::Start);
+    w.u64(msg.seed);
+    w.u64(msg.stream);
+    w.u8(static_cast<std::uint8_t>(msg.randomizer));
+    return w.finish();
+}
+
+std::size_t protocol::encode(const Input &msg, std::uint8_t *out) {
+    Writer w(out, MsgType::Input);
+    w.u8(static_cast<std::uint8_t>(msg.action));
+    w.u16(msg.seq);
+    return w.finish();
+}
+
+std::size_t protocol::encode(const State &msg, std::uint8_t *out) {
+    Writer w(out, MsgType::State);
+    w.u32(msg.tick);
+    w.u32(msg.events);
+    w.u32(msg.score);
+    w.u16(msg.lines);
+    w.u8(msg.level);
+    w.u16(msg.ack);
+    w.u8(static_cast<std::uint8_t>(msg.active.type));
+    w.u8(static_cast<std::uint8_t>(msg.active.rotation));
+    w.u8(static_cast<std::uint8_t>(static_cast<std::int8_t>(msg.active.position.x)));
+    w.u8(static_cast<std::uint8_t>(static_cast<std::int8_t>(msg.active.position.y)));
+    w.u8(static_cast<std::uint8_t>(msg.next));
+    if (msg.hasRows)
+        for (std::uint16_t row : msg.rows) w.u16(row);
+    return w.finish();
+}
+
+std::size_t protocol::encode(const GameOver &msg, std::uint8_t *out) {
+    Writer w(out, MsgType::GameOver);
+    w.u32(msg.score);
+    w.u16(msg.lines);
+    w.u32(msg.pieces);
+    return w.finish();
+}
+
+void protocol::describe(const Engine &engine, bool withRows, State &out) {
+    out.score = static_cast<std::uint32_t>(engine.score());
+    out.lines = static_cast<std::uint16_t>(engine.lines());
+    out.level = static_cast<std::uint8_t>(engine.level());
+    out.active = engine.active();
+    out.next = engine.next();
+    out.hasRows = withRows;
+    if (withRows)
+        for (int y = 0; y < BoardHeight; ++y) out.rows[y] = engine.board().row(y);
+}
+
+int protocol::decode(const std::uint8_t *data, std::size_t size, Message &out) {
+    if (size < HeaderSize) return 0;
+    std::size_t length = HeaderSize + data[0];
+    if (size < length) return 0;
+    Reader in{data + HeaderSize, data + length};
+    out.type = static_cast<MsgType>(data[1]);
+    switch (out.type) {
+    case MsgType::Start:
+        if (!in.has(StartSize)) return -1;
+        out.start.seed = in.u64();
+        out.start.stream = in.u64();
+        out.start.randomizer = static_cast<Randomizer>(in.u8());
+        if (out.start.randomizer >= Randomizer::Count) return -1;
+        break;
+    case MsgType::Input: {
+        if (!in.has(InputSize)) return -1;
+        std::uint8_t action = in.u8();
+        if (action == 0 || action >= static_cast<std::uint8_t>(Action::Count)) return -1;
+        out.input.action = static_cast<Action>(action);
+        out.input.seq = in.u16();
+        break;
+    }
+    case MsgType::State: {
+        if (!in.has(StateSize)) return -1;
+        State &s = out.state;
+        s.tick = in.u32();
+        s.events = in.u32();
+        s.score = in.u32();
+        s.lines = in.u16();
+        s.level = in.u8();
+        s.ack = in.u16();
+        std::uint8_t piece = in.u8();
+        if (piece >= PieceCount) return -1;
+        s.active.type = static_cast<TetrominoType>(piece);
+        s.active.rotation = in.u8() & 3;
+        s.active.position.x = static_cast<std::int8_t>(in.u8());
+        s.active.position.y = static_cast<std::int8_t>(in.u8());
+        std::uint8_t next = in.u8();
+        if (next >= PieceCount) return -1;
+        s.next = static_cast<TetrominoType>(next);
+        s.hasRows = in.has(RowsSize);
+        if (s.hasRows)
+            for (auto &row : s.rows) row = in.u16();
+        break;
+    }
+    case MsgType::GameOver:
+        if (!in.has(GameOverSize)) return -1;
+        out.gameOver.score = in.u32();
+        out.gameOver.lines = in.u16();
+        out.gameOver.pieces = in.u32();
+        break;
+    default:
+        return -1;
+    }
+    return static_cast<int>(length);
+}
@@ -0,0 +1,184 @@
+#include "../../include/tetris/Replay.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace tetris;
+
+static const char Magic[4] = {'T', 'R', 'P', 'L'};
+
+ReplayWriter::ReplayWriter(std::uint64_t seed, std::uint64_t stream, Randomizer mode)
+    : m_bytes(Magic, Magic + 4) {
+    m_bytes.push_back(replay::Version);
+    m_bytes.push_back(static_cast<std::uint8_t>(mode));
+    putVarint(seed);
+    putVarint(stream);
+}
+
+void ReplayWriter::putVarint(std::uint64_t v) {
+    while (v >= 0x80) {
+        m_bytes.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    m_bytes.push_back(static_cast<std::uint8_t>(v));
+}
+
+void ReplayWriter::flushRepeats() {
+    if (m_repeats == 0) return;
+    m_bytes.push_back(replay::OpRepeat);
+    putVarint(m_repeats);
+    m_repeats = 0;
+}
+
+void ReplayWriter::action(Action action) {
+    if (m_finished || action == Action::None || action >= Action::Count) return;
+    flushRepeats();
+    m_bytes.push_back(static_cast<std::uint8_t>(action));
+}
+
+void ReplayWriter::tick(std::uint32_t micros) {
+    if (m_finished) return;
+    if (m_haveTick && micros == m_lastTick) {
+        ++m_repeats;
+        return;
+    }
+    flushRepeats();
+    m_bytes.push_back(replay::OpTick);
+    putVarint(micros);
+    m_lastTick = micros;
+    m_haveTick = true;
+}
+
+void ReplayWriter::reset(std::uint32_t seed) {
+    if (m_finished) return;
+    flushRepeats();
+    m_bytes.push_back(replay::OpReset);
+    putVarint(seed);
+}
+
+void ReplayWriter::finish(const Engine &engine) {
+    if (m_finished) return;
+    flushRepeats();
+    m_bytes.push_back(replay::OpEnd);
+    putVarint(static_cast<std::uint64_t>(engine.score()));
+    putVarint(static_cast<std::uint64_t>(engine.lines()));
+    putVarint(static_cast<std::uint64_t>(engine.level()));
+    putVarint(static_cast<std::uint64_t>(engine.piecesPlaced()));
+    std::uint64_t h = engine.board().hash();
+    for (int i = 0; i < 8; ++i) m_bytes.push_back(static_cast<std::uint8_t>(h >> (8 * i)));
+    m_finished = true;
+}
+
+bool ReplayWriter::save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(m_bytes.data()), static_cast<std::streamsize>(m_bytes.size()));
+    return static_cast<bool>(out);
+}
+
+bool tetris::loadReplayFile(const std::string &path, std::vector<std::uint8_t> &out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+namespace {
+
+struct Reader {
+    const std::uint8_t *p;
+    const std::uint8_t *end;
+
+    bool byte(std::uint8_t &b) {
+        if (p == end) return false;
+        b = *p++;
+        return true;
+    }
+    bool varint(std::uint64_t &v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t b;
+            if (!byte(b)) return false;
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+ReplayResult tetris::playReplay(const std::uint8_t *data, std::size_t size, StateStreamWriter *states) {
+    if (!states) return playReplay(data, size, ReplayObserver());
+    ReplayResult result = playReplay(data, size, [states](const Engine &engine, std::uint32_t) { states->tick(engine); });
+    states->finish();
+    return result;
+}
+
+ReplayResult tetris::playReplay(const std::uint8_t *data, std::size_t size, const ReplayObserver &observer) {
+    ReplayResult result;
+    Reader in{data, data + size};
+    if (size < 5 || std::memcmp(data, Magic, 4) != 0) { result.error = "not a replay file"; return result; }
+    in.p += 4;
+    std::uint8_t version, mode;
+    std::uint64_t value, stream;
+    if (!in.byte(version) || version != replay::Version) { result.error = "unsupported replay version"; return result; }
+    if (!in.byte(mode) || !in.varint(value) || !in.varint(stream)) { result.error = "truncated header"; return result; }
+    if (mode >= static_cast<std::uint8_t>(Randomizer::Count)) { result.error = "unknown randomizer"; return result; }
+
+    Engine engine(PieceGenerator(value, stream, static_cast<Randomizer>(mode)));
+    std::uint32_t lastTick = 0;
+    for (;;) {
+        std::uint8_t op;
+        if (!in.byte(op)) { result.error = "missing end marker"; return result; }
+        if (op == replay::OpEnd) break;
+        if (op > 0 && op < static_cast<std::uint8_t>(Action::Count)) {
+            engine.step(static_cast<Action>(op));
+            ++result.actions;
+        } else if (op == replay::OpTick) {
+            if (!in.varint(value)) { result.error = "truncated tick"; return result; }
+            lastTick = static_cast<std::uint32_t>(value);
+            engine.tick(replay::tickSeconds(lastTick));
+            if (observer) observer(engine, lastTick);
+            ++result.ticks;
+        } else if (op == replay::OpRepeat) {
+            if (!in.varint(value)) { result.error = "truncated repeat"; return result; }
+            float dt = replay::tickSeconds(lastTick);
+            for (std::uint64_t i = 0; i < value; ++i) {
+                engine.tick(dt);
+                if (observer) observer(engine, lastTick);
+            }
+            result.ticks += value;
+        } else if (op == replay::OpReset) {
+            if (!in.varint(value)) { result.error = "truncated reset"; return result; }
+            engine.reset(static_cast<std::uint32_t>(value));
+        } else {
+            result.error = "unknown record";
+            return result;
+        }
+    }
+
+    std::uint64_t score, lines, level, pieces;
+    if (!in.varint(score) || !in.varint(lines) || !in.varint(level) || !in.varint(pieces) || in.end - in.p < 8) {
+        result.error = "truncated final state";
+        return result;
+    }
+    std::uint64_t hash = 0;
+    for (int i = 0; i < 8; ++i) hash |= static_cast<std::uint64_t>(in.p[i]) << (8 * i);
+
+    result.valid = true;
+    result.expectedScore = static_cast<int>(score);
+    result.expectedLines = static_cast<int>(lines);
+    result.expectedLevel = static_cast<int>(level);
+    result.expectedPieces = static_cast<int>(pieces);
+    result.expectedBoardHash = hash;
+    result.score = engine.score();
+    result.lines = engine.lines();
+    result.level = engine.level();
+    result.pieces = engine.piecesPlaced();
+    result.boardHash = engine.board().hash();
+    result.matches = result.score == result.expectedScore && result.lines == result.expectedLines
+                  && result.level == result.expectedLevel && result.pieces == result.expectedPieces
+                  && result.boardHash == result.expectedBoardHash;
+    if (!result.matches) result.error = "final state differs from recording";
+    return result;
+}
@@ -0,0 +1,53 @@
+#include "../../include/tetris/SoundManager.hpp"
+#include <algorithm>
+
+using namespace tetris;
+
+void SoundManager::setBuffer(Sfx sfx, std::unique_ptr<sf::SoundBuffer> buffer) {
+    Effect &effect = m_effects[static_cast<int>(sfx)];
+    // voices reference the buffer, so they go first
+    for (auto &voice : effect.voices) voice.reset();
+    effect.buffer = std::move(buffer);
+    effect.next = 0;
+    if (!effect.buffer) return;
+    float volume = m_muted ? 0.0f : m_volume;
+    for (auto &voice : effect.voices) {
+        voice.emplace(*effect.buffer);
+        voice->setVolume(volume);
+    }
+}
+
+void SoundManager::play(Sfx sfx) {
+    Effect &effect = m_effects[static_cast<int>(sfx)];
+    if (!effect.buffer || m_muted || m_volume <= 0.0f) return;
+    int chosen = effect.next;
+    for (int i = 0; i < VoicesPerEffect; ++i) {
+        int v = (effect.next + i) % VoicesPerEffect;
+        if (effect.voices[v]->getStatus() != sf::Sound::Status::Playing) {
+            chosen = v;
+            break;
+        }
+    }
+    sf::Sound &voice = *effect.voices[chosen];
+    voice.stop();
+    voice.play();
+    effect.next = (chosen + 1) % VoicesPerEffect;
+}
+
+void SoundManager::setVolume(float volume) {
+    m_volume = std::clamp(volume, 0.0f, 100.0f);
+    applyVolume();
+}
+
+void SoundManager::setMuted(bool muted) {
+    m_muted = muted;
+    applyVolume();
+}
+
+void SoundManager::applyVolume() {
+    float volume = m_muted ? 0.0f : m_volume;
+    for (Effect &effect : m_effects) {
+        if (!effect.buffer) continue;
+        for (auto &voice : effect.voices) voice->setVolume(volume);
+    }
+}
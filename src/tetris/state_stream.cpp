@@ -0,0 +1,523 @@
+#include "../../include/tetris/StateStream.hpp"
+#include <cstring>
+
+using namespace tetris;
+
+static_assert(BoardWidth * BoardHeight <= 256, "cell indices are written as one byte");
+
+static const char Magic[4] = {'T', 'S', 'S', 'T'};
+static const char IndexMagic[4] = {'T', 'S', 'I', 'X'};
+
+namespace {
+
+enum Op : std::uint8_t {
+    OpEnd = 0x00, OpTickEnd, OpIdle, OpKeyframe,
+    OpLock = 0x10, OpPlace, OpClear, OpCells,
+    OpLeft = 0x20, OpRight, OpDown, OpPiece,
+    OpNext = 0x30, OpScore, OpLines, OpLevel, OpRunning,
+};
+
+// Field bits of OpPiece.
+constexpr std::uint8_t PieceType = 1, PieceRotation = 2, PieceX = 4, PieceY = 8;
+
+// Beyond this many changed cells a keyframe is about as small as the delta.
+constexpr int MaxCellDelta = 48;
+constexpr int KeyframeCellBytes = BoardWidth * BoardHeight / 2;
+
+bool sameCell(const Board &a, const Board &b, int x, int y) { return a.at(x, y).color == b.at(x, y).color; }
+
+int changedCells(const Board &a, const Board &b) {
+    int n = 0;
+    for (int y = 0; y < BoardHeight; ++y)
+        for (int x = 0; x < BoardWidth; ++x) n += !sameCell(a, b, x, y);
+    return n;
+}
+
+// Find where a piece of the given type covers exactly the four cells.
+bool findPlacement(TetrominoType type, const Point (&cells)[4], Tetromino &out) {
+    for (int r = 0; r < RotationCount; ++r) {
+        const auto &blocks = Tetromino::getShape(type, r);
+        // Some block lands on cells[0]; try each as that one.
+        for (const Point &anchor : blocks) {
+            Point origin = cells[0] - anchor;
+            int matched = 0;
+            for (const Point &b : blocks)
+                for (const Point &c : cells) matched += (origin + b) == c;
+            if (matched == 4) {
+                out = Tetromino{type, r, origin};
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void placePiece(Board &board, const Tetromino &piece) {
+    board.place(Tetromino::getShape(piece.type, piece.rotation), piece.position, static_cast<int>(piece.type));
+}
+
+bool samePiece(const Tetromino &a, const Tetromino &b) {
+    return a.type == b.type && a.rotation == b.rotation && a.position == b.position;
+}
+
+} // namespace
+
+StateStreamWriter::StateStreamWriter(std::uint32_t keyframeInterval)
+    : m_interval(keyframeInterval ? keyframeInterval : 1) {
+    m_bytes.reserve(4096);
+    m_bytes.insert(m_bytes.end(), Magic, Magic + 4);
+    m_bytes.push_back(stream::Version);
+    m_bytes.push_back(static_cast<std::uint8_t>(BoardWidth));
+    m_bytes.push_back(static_cast<std::uint8_t>(BoardHeight));
+}
+
+void StateStreamWriter::putVarint(std::uint64_t v) {
+    while (v >= 0x80) {
+        m_bytes.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    m_bytes.push_back(static_cast<std::uint8_t>(v));
+}
+
+void StateStreamWriter::flushIdle() {
+    if (m_idle == 0) return;
+    m_bytes.push_back(OpIdle);
+    putVarint(m_idle);
+    m_idle = 0;
+}
+
+void StateStreamWriter::keyframe(const Engine &engine) {
+    m_index.push_back(KeyframeEntry{m_tick, static_cast<std::uint32_t>(m_bytes.size())});
+    m_bytes.push_back(OpKeyframe);
+    putVarint(m_tick);
+    const Board &board = engine.board();
+    for (int i = 0; i < BoardWidth * BoardHeight; i += 2) {
+        auto nibble = [&](int cell) { return static_cast<std::uint8_t>(board.at(cell % BoardWidth, cell / BoardWidth).color + 1); };
+        m_bytes.push_back(static_cast<std::uint8_t>(nibble(i) | (nibble(i + 1) << 4)));
+    }
+    const Tetromino &active = engine.active();
+    m_bytes.push_back(static_cast<std::uint8_t>(active.type));
+    m_bytes.push_back(static_cast<std::uint8_t>(active.rotation));
+    m_bytes.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(active.position.x)));
+    m_bytes.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(active.position.y)));
+    m_bytes.push_back(static_cast<std::uint8_t>(engine.next()));
+    putVarint(static_cast<std::uint64_t>(engine.score()));
+    putVarint(static_cast<std::uint64_t>(engine.lines()));
+    putVarint(static_cast<std::uint64_t>(engine.level()));
+    m_bytes.push_back(engine.running() ? 1 : 0);
+
+    m_sent.board = board;
+    m_sent.active = active;
+    m_sent.next = engine.next();
+    m_sent.score = engine.score();
+    m_sent.lines = engine.lines();
+    m_sent.level = engine.level();
+    m_sent.running = engine.running();
+}
+
+bool StateStreamWriter::boardDelta(const Board &board) {
+    Board work = m_sent.board;
+    if (changedCells(work, board) == 0) return true;
+
+    // Line clears first: the engine removes rows in tick() before any step()
+    // of the next frame can place more pieces.
+    std::size_t start = m_bytes.size();
+    Board::Lines full = work.getFullLines();
+    if (!full.empty()) {
+        Board cleared = work;
+        cleared.removeLines(full);
+        if (changedCells(cleared, board) < changedCells(work, board)) {
+            m_bytes.push_back(OpClear);
+            work = cleared;
+        }
+    }
+
+    // Then whole pieces: four new cells of one color forming a shape. More
+    // than one piece can land between two ticks when hard drops come fast.
+    bool placed = true;
+    while (placed) {
+        placed = false;
+        for (int type = 0; type < PieceCount && !placed; ++type) {
+            Point cells[4];
+            int n = 0;
+            bool onlyNew = true;
+            for (int y = 0; y < BoardHeight; ++y)
+                for (int x = 0; x < BoardWidth; ++x) {
+                    if (sameCell(work, board, x, y) || board.at(x, y).color != type) continue;
+                    onlyNew = onlyNew && work.at(x, y).color == -1;
+                    if (n < 4) cells[n] = Point{x, y};
+                    ++n;
+                }
+            // Two same-colored pieces in one tick fall through to OpCells
+            Tetromino piece{TetrominoType::I, 0, Point{}};
+            if (n != 4 || !onlyNew || !findPlacement(static_cast<TetrominoType>(type), cells, piece)) continue;
+            if (samePiece(piece, m_sent.active)) {
+                m_bytes.push_back(OpLock);
+            } else {
+                m_bytes.push_back(OpPlace);
+                m_bytes.push_back(static_cast<std::uint8_t>(piece.type));
+                m_bytes.push_back(static_cast<std::uint8_t>(piece.rotation));
+                m_bytes.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(piece.position.x)));
+                m_bytes.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(piece.position.y)));
+            }
+            placePiece(work, piece);
+            placed = true;
+        }
+    }
+
+    // Whatever is left goes cell by cell, or as a keyframe when most of the
+    // board changed (a new game).
+    int left = changedCells(work, board);
+    if (left > MaxCellDelta) {
+        m_bytes.resize(start);
+        return false;
+    }
+    if (left > 0) {
+        m_bytes.push_back(OpCells);
+        m_bytes.push_back(static_cast<std::uint8_t>(left));
+        for (int y = 0; y < BoardHeight; ++y)
+            for (int x = 0; x < BoardWidth; ++x) {
+                if (sameCell(work, board, x, y)) continue;
+                m_bytes.push_back(static_cast<std::uint8_t>(y * BoardWidth + x));
+                m_bytes.push_back(static_cast<std::uint8_t>(board.at(x, y).color + 1));
+                work.setCell(x, y, board.at(x, y).color);
+            }
+    }
+    m_sent.board = work;
+    return true;
+}
+
+void StateStreamWriter::tick(const Engine &engine) {
+    if (m_finished) return;
+    if (m_tick % m_interval == 0) {
+        flushIdle();
+        keyframe(engine);
+        m_bytes.push_back(OpTickEnd);
+        ++m_tick;
+        return;
+    }
+
+    std::size_t start = m_bytes.size();
+    // Idle ticks are only written once the run ends; ops go after it.
+    if (m_idle) {
+        m_bytes.push_back(OpIdle);
+        putVarint(m_idle);
+    }
+    std::size_t ops = m_bytes.size();
+    if (!boardDelta(engine.board())) {
+        m_bytes.resize(start);
+        flushIdle();
+        keyframe(engine);
+        m_bytes.push_back(OpTickEnd);
+        ++m_tick;
+        return;
+    }
+
+    const Tetromino &a = engine.active();
+    Tetromino &s = m_sent.active;
+    if (!samePiece(a, s)) {
+        Point d = a.position - s.position;
+        bool shifted = a.type == s.type && a.rotation == s.rotation;
+        if (shifted && d == Point{-1, 0}) m_bytes.push_back(OpLeft);
+        else if (shifted && d == Point{1, 0}) m_bytes.push_back(OpRight);
+        else if (shifted && d == Point{0, 1}) m_bytes.push_back(OpDown);
+        else {
+            std::uint8_t mask = static_cast<std::uint8_t>((a.type != s.type ? PieceType : 0) | (a.rotation != s.rotation ? PieceRotation : 0)
+                                                          | (d.x ? PieceX : 0) | (d.y ? PieceY : 0));
+            m_bytes.push_back(OpPiece);
+            m_bytes.push_back(mask);
+            if (mask & PieceType) m_bytes.push_back(static_cast<std::uint8_t>(a.type));
+            if (mask & PieceRotation) m_bytes.push_back(static_cast<std::uint8_t>(a.rotation));
+            if (mask & PieceX) m_bytes.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(a.position.x)));
+            if (mask & PieceY) m_bytes.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(a.position.y)));
+        }
+        s = a;
+    }
+    if (engine.next() != m_sent.next) {
+        m_bytes.push_back(OpNext);
+        m_bytes.push_back(static_cast<std::uint8_t>(engine.next()));
+        m_sent.next = engine.next();
+    }
+    if (engine.score() != m_sent.score) {
+        m_bytes.push_back(OpScore);
+        putVarint(static_cast<std::uint64_t>(engine.score()));
+        m_sent.score = engine.score();
+    }
+    if (engine.lines() != m_sent.lines) {
+        m_bytes.push_back(OpLines);
+        putVarint(static_cast<std::uint64_t>(engine.lines()));
+        m_sent.lines = engine.lines();
+    }
+    if (engine.level() != m_sent.level) {
+        m_bytes.push_back(OpLevel);
+        putVarint(static_cast<std::uint64_t>(engine.level()));
+        m_sent.level = engine.level();
+    }
+    if (engine.running() != m_sent.running) {
+        m_bytes.push_back(OpRunning);
+        m_bytes.push_back(engine.running() ? 1 : 0);
+        m_sent.running = engine.running();
+    }
+
+    if (m_bytes.size() == ops) {
+        // Nothing changed: extend the idle run instead
+        m_bytes.resize(start);
+        ++m_idle;
+    } else {
+        m_idle = 0;
+        m_bytes.push_back(OpTickEnd);
+    }
+    ++m_tick;
+}
+
+void StateStreamWriter::finish() {
+    if (m_finished) return;
+    flushIdle();
+    m_bytes.push_back(OpEnd);
+    auto put32 = [&](std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) m_bytes.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    };
+    auto indexOffset = static_cast<std::uint32_t>(m_bytes.size());
+    put32(static_cast<std::uint32_t>(m_index.size()));
+    for (const KeyframeEntry &k : m_index) {
+        put32(k.tick);
+        put32(k.offset);
+    }
+    put32(indexOffset);
+    m_bytes.insert(m_bytes.end(), IndexMagic, IndexMagic + 4);
+    m_finished = true;
+}
+
+namespace {
+
+std::uint32_t get32(const std::uint8_t *p) {
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+         | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+struct Cursor {
+    const std::uint8_t *&p;
+    const std::uint8_t *end;
+
+    bool byte(std::uint8_t &b) {
+        if (p == end) return false;
+        b = *p++;
+        return true;
+    }
+    bool i8(int &v) {
+        std::uint8_t b;
+        if (!byte(b)) return false;
+        v = static_cast<std::int8_t>(b);
+        return true;
+    }
+    bool varint(std::uint64_t &v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t b;
+            if (!byte(b)) return false;
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+    bool count(int &v) {
+        std::uint64_t x;
+        if (!varint(x) || x > 0x7FFFFFFF) return false;
+        v = static_cast<int>(x);
+        return true;
+    }
+    bool piece(Tetromino &t) {
+        std::uint8_t type, rotation;
+        if (!byte(type) || !byte(rotation) || !i8(t.position.x) || !i8(t.position.y)) return false;
+        if (type >= PieceCount || rotation >= RotationCount) return false;
+        t.type = static_cast<TetrominoType>(type);
+        t.rotation = rotation;
+        return true;
+    }
+};
+
+} // namespace
+
+bool StateStreamReader::fail(const char *message) {
+    m_error = message;
+    return false;
+}
+
+bool StateStreamReader::open(const std::uint8_t *data, std::size_t size) {
+    *this = StateStreamReader();
+    if (size < static_cast<std::size_t>(stream::HeaderSize) || std::memcmp(data, Magic, 4) != 0) return fail("not a state stream");
+    if (data[4] != stream::Version) return fail("unsupported state stream version");
+    if (data[5] != BoardWidth || data[6] != BoardHeight) return fail("unsupported board size");
+    m_data = data;
+    m_p = data + stream::HeaderSize;
+    m_end = data + size;
+    // A finished stream ends in its keyframe index; a live one does not yet.
+    if (size >= stream::HeaderSize + 8 && std::memcmp(data + size - 4, IndexMagic, 4) == 0) {
+        std::uint32_t offset = get32(data + size - 8);
+        if (offset < stream::HeaderSize || offset > size - 12) return fail("bad keyframe index");
+        std::uint32_t count = get32(data + offset);
+        if (offset + 12 + 8 * static_cast<std::uint64_t>(count) != size) return fail("bad keyframe index");
+        m_index = data + offset + 4;
+        m_indexCount = count;
+        m_end = data + offset;
+    }
+    return true;
+}
+
+bool StateStreamReader::keyframe() {
+    Cursor in{m_p, m_end};
+    std::uint64_t tick;
+    if (!in.varint(tick)) return fail("truncated keyframe");
+    if (m_end - m_p < KeyframeCellBytes) return fail("truncated keyframe");
+    Board board;
+    for (int i = 0; i < KeyframeCellBytes; ++i) {
+        std::uint8_t b = *m_p++;
+        int lo = (b & 0x0F) - 1, hi = (b >> 4) - 1;
+        if (lo >= 0) board.setCell((2 * i) % BoardWidth, (2 * i) / BoardWidth, lo);
+        if (hi >= 0) board.setCell((2 * i + 1) % BoardWidth, (2 * i + 1) / BoardWidth, hi);
+    }
+    StreamState s;
+    s.board = board;
+    std::uint8_t next, running;
+    if (!in.piece(s.active) || !in.byte(next) || next >= PieceCount || !in.count(s.score) || !in.count(s.lines)
+        || !in.count(s.level) || !in.byte(running))
+        return fail("truncated keyframe");
+    s.next = static_cast<TetrominoType>(next);
+    s.running = running != 0;
+    m_state = s;
+    m_tick = static_cast<std::uint32_t>(tick);
+    return true;
+}
+
+bool StateStreamReader::next() {
+    if (!m_data || m_error) return false;
+    if (m_idle) {
+        --m_idle;
+        ++m_tick;
+        return true;
+    }
+    Cursor in{m_p, m_end};
+    bool keyed = false;
+    for (;;) {
+        std::uint8_t op;
+        if (!in.byte(op)) return fail("truncated stream");
+        switch (op) {
+        case OpEnd:
+            --m_p; // stay at the end
+            return false;
+        case OpTickEnd:
+            if (!keyed) {
+                if (!m_started) return fail("stream does not start with a keyframe");
+                ++m_tick;
+            }
+            m_started = true;
+            return true;
+        case OpIdle: {
+            std::uint64_t n;
+            if (!in.varint(n) || n == 0) return fail("bad idle run");
+            if (!m_started) return fail("stream does not start with a keyframe");
+            m_idle = n - 1;
+            ++m_tick;
+            return true;
+        }
+        case OpKeyframe:
+            if (!keyframe()) return false;
+            keyed = true;
+            break;
+        case OpLock:
+            placePiece(m_state.board, m_state.active);
+            break;
+        case OpPlace: {
+            Tetromino piece{TetrominoType::I, 0, Point{}};
+            if (!in.piece(piece)) return fail("truncated place");
+            placePiece(m_state.board, piece);
+            break;
+        }
+        case OpClear:
+            m_state.board.removeLines(m_state.board.getFullLines());
+            break;
+        case OpCells: {
+            std::uint8_t n;
+            if (!in.byte(n)) return fail("truncated cells");
+            for (int i = 0; i < n; ++i) {
+                std::uint8_t cell, color;
+                if (!in.byte(cell) || !in.byte(color)) return fail("truncated cells");
+                if (cell >= BoardWidth * BoardHeight) return fail("bad cell index");
+                m_state.board.setCell(cell % BoardWidth, cell / BoardWidth, static_cast<int>(color) - 1);
+            }
+            break;
+        }
+        case OpLeft: --m_state.active.position.x; break;
+        case OpRight: ++m_state.active.position.x; break;
+        case OpDown: ++m_state.active.position.y; break;
+        case OpPiece: {
+            std::uint8_t mask, v;
+            Tetromino &a = m_state.active;
+            if (!in.byte(mask)) return fail("truncated piece");
+            if (mask & PieceType) {
+                if (!in.byte(v) || v >= PieceCount) return fail("bad piece");
+                a.type = static_cast<TetrominoType>(v);
+            }
+            if (mask & PieceRotation) {
+                if (!in.byte(v) || v >= RotationCount) return fail("bad piece");
+                a.rotation = v;
+            }
+            if ((mask & PieceX) && !in.i8(a.position.x)) return fail("truncated piece");
+            if ((mask & PieceY) && !in.i8(a.position.y)) return fail("truncated piece");
+            break;
+        }
+        case OpNext: {
+            std::uint8_t v;
+            if (!in.byte(v) || v >= PieceCount) return fail("bad next piece");
+            m_state.next = static_cast<TetrominoType>(v);
+            break;
+        }
+        case OpScore:
+            if (!in.count(m_state.score)) return fail("truncated score");
+            break;
+        case OpLines:
+            if (!in.count(m_state.lines)) return fail("truncated lines");
+            break;
+        case OpLevel:
+            if (!in.count(m_state.level)) return fail("truncated level");
+            break;
+        case OpRunning: {
+            std::uint8_t v;
+            if (!in.byte(v)) return fail("truncated running flag");
+            m_state.running = v != 0;
+            break;
+        }
+        default:
+            return fail("unknown op");
+        }
+    }
+}
+
+void StateStreamReader::rewindTo(std::size_t offset) {
+    m_p = m_data + offset;
+    m_idle = 0;
+    m_started = false;
+    m_error = nullptr;
+}
+
+bool StateStreamReader::seek(std::uint32_t tick) {
+    if (!m_data) return false;
+    if (m_indexCount) {
+        // Nearest keyframe at or before tick
+        std::uint32_t lo = 0, hi = m_indexCount;
+        while (hi - lo > 1) {
+            std::uint32_t mid = (lo + hi) / 2;
+            if (get32(m_index + 8 * mid) <= tick) lo = mid;
+            else hi = mid;
+        }
+        std::uint32_t offset = get32(m_index + 8 * lo + 4);
+        if (offset < stream::HeaderSize || m_data + offset >= m_end) return fail("bad keyframe index");
+        rewindTo(offset);
+    } else if (!m_started || m_error || m_tick > tick) {
+        // No index yet (a live stream): scan from the start
+        rewindTo(stream::HeaderSize);
+    }
+    while (!m_started || m_tick < tick)
+        if (!next()) return false;
+    return m_tick == tick;
+}
@@ -0,0 +1,59 @@
+// C entry points of the tetris_env shared library. No exception may cross
+// into the caller, so construction failures become NULL.
+#include "../../include/tetris/tetris_env.h"
+#include "../../include/tetris/VecEnv.hpp"
+#include <new>
+
+using namespace tetris;
+
+struct tetris_env {
+    VecEnv env;
+};
+
+void tetris_env_get_shape(tetris_env_shape *shape) {
+    if (!shape) return;
+    shape->planes = VecEnv::Planes;
+    shape->height = BoardHeight;
+    shape->width = BoardWidth;
+    shape->piece_fields = VecEnv::PieceFields;
+    shape->actions = static_cast<int>(Action::Count);
+}
+
+tetris_env *tetris_env_create(int num_envs, uint64_t seed, int threads, float frame_seconds) {
+    if (num_envs <= 0 || threads < 0 || !(frame_seconds > 0.0f)) return nullptr;
+    try {
+        return new tetris_env{VecEnv(num_envs, seed, static_cast<unsigned>(threads), frame_seconds)};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void tetris_env_destroy(tetris_env *env) {
+    delete env;
+}
+
+int tetris_env_num_envs(const tetris_env *env) {
+    return env ? env->env.size() : 0;
+}
+
+int tetris_env_num_threads(const tetris_env *env) {
+    return env ? static_cast<int>(env->env.threads()) : 0;
+}
+
+void tetris_env_set_buffers(tetris_env *env, uint8_t *boards, int32_t *pieces, float *rewards, uint8_t *dones) {
+    if (!env) return;
+    VecEnvBuffers buffers;
+    buffers.boards = boards;
+    buffers.pieces = pieces;
+    buffers.rewards = rewards;
+    buffers.dones = dones;
+    env->env.setBuffers(buffers);
+}
+
+void tetris_env_reset(tetris_env *env) {
+    if (env) env->env.reset();
+}
+
+int tetris_env_step(tetris_env *env, const uint8_t *actions) {
+    return env ? env->env.step(actions) : -1;
+}
@@ -0,0 +1,76 @@
+#include "../../include/tetris/ThreadPool.hpp"
+#include <algorithm>
+
+using namespace tetris;
+
+// Index of the pool worker running on this thread, or -1 elsewhere.
+static thread_local int t_workerIndex = -1;
+static thread_local const ThreadPool *t_workerPool = nullptr;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) m_queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < threads; ++i) m_threads.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &t : m_threads) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned index = (t_workerPool == this) ? static_cast<unsigned>(t_workerIndex)
+                                            : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % size();
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // pairs with the predicate check in workerLoop so no wake-up is lost
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_pending.fetch_add(1, std::memory_order_release);
+    }
+    m_wake.notify_one();
+}
+
+bool ThreadPool::popLocal(unsigned index, std::function<void()> &task) {
+    Queue &q = *m_queues[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief, std::function<void()> &task) {
+    for (unsigned i = 1; i < size(); ++i) {
+        Queue &q = *m_queues[(thief + i) % size()];
+        std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || q.tasks.empty()) continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    t_workerIndex = static_cast<int>(index);
+    t_workerPool = this;
+    std::function<void()> task;
+    for (;;) {
+        if (popLocal(index, task) || steal(index, task)) {
+            m_pending.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_stop || m_pending.load(std::memory_order_acquire) > 0; });
+        if (m_stop) return;
+    }
+}
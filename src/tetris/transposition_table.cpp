@@ -0,0 +1,81 @@
+#include "../../include/tetris/TranspositionTable.hpp"
+#include "../../include/tetris/Board.hpp"
+
+using namespace tetris;
+
+static constexpr std::uint64_t EmptyKey = 0;
+
+// Piece keys for the active and preview slots, one extra entry for "none".
+static constexpr std::uint64_t pieceKey(int role, TetrominoType type) {
+    return detail::splitmix64(0xA5A5A5A5ull + static_cast<std::uint64_t>(role * 16 + static_cast<int>(type)));
+}
+
+TranspositionTable::TranspositionTable(std::size_t bytes) {
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Slot) <= bytes) count *= 2;
+    m_slots = std::make_unique<Slot[]>(count);
+    m_mask = count - 1;
+    m_counters = std::make_unique<Counters[]>(CounterShards);
+}
+
+TranspositionTable::Counters& TranspositionTable::counters() {
+    // Threads take shards in order of first use; only more than
+    // CounterShards threads share one.
+    static std::atomic<unsigned> nextShard{0};
+    thread_local unsigned shard = nextShard.fetch_add(1, std::memory_order_relaxed) % CounterShards;
+    return m_counters[shard];
+}
+
+std::uint64_t TranspositionTable::key(std::uint64_t boardHash, TetrominoType active, TetrominoType preview) {
+    std::uint64_t k = boardHash ^ pieceKey(0, active) ^ pieceKey(1, preview);
+    return k == EmptyKey ? 1 : k; // 0 marks an empty slot
+}
+
+bool TranspositionTable::probe(std::uint64_t key, std::uint64_t &data) {
+    Counters &c = counters();
+    c.probes.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_slots[key & m_mask];
+    std::uint64_t d = slot.data.load(std::memory_order_relaxed);
+    std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ d) == key) {
+        c.hits.fetch_add(1, std::memory_order_relaxed);
+        data = d;
+        return true;
+    }
+    if ((check ^ d) != EmptyKey) c.collisions.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, std::uint64_t data) {
+    Counters &c = counters();
+    c.stores.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_slots[key & m_mask];
+    std::uint64_t old = slot.check.load(std::memory_order_relaxed) ^ slot.data.load(std::memory_order_relaxed);
+    if (old != EmptyKey && old != key) c.overwrites.fetch_add(1, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i <= m_mask; ++i) {
+        m_slots[i].check.store(0, std::memory_order_relaxed);
+        m_slots[i].data.store(0, std::memory_order_relaxed);
+    }
+    for (unsigned i = 0; i < CounterShards; ++i) {
+        Counters &c = m_counters[i];
+        c.probes = c.hits = c.collisions = c.stores = c.overwrites = 0;
+    }
+}
+
+TranspositionTable::Stats TranspositionTable::stats() const {
+    Stats s;
+    for (unsigned i = 0; i < CounterShards; ++i) {
+        const Counters &c = m_counters[i];
+        s.probes += c.probes.load(std::memory_order_relaxed);
+        s.hits += c.hits.load(std::memory_order_relaxed);
+        s.collisions += c.collisions.load(std::memory_order_relaxed);
+        s.stores += c.stores.load(std::memory_order_relaxed);
+        s.overwrites += c.overwrites.load(std::memory_order_relaxed);
+    }
+    return s;
+}
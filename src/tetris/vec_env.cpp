@@ -0,0 +1,153 @@
+#include "../../include/tetris/VecEnv.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+using namespace tetris;
+
+namespace {
+
+// Below this many environments per chunk, waking another thread costs more
+// than stepping the games.
+constexpr int MinChunkEnvs = 64;
+
+// Byte i of entry b is bit i of b: eight cells of a row word at a time.
+const std::array<std::array<std::uint8_t, 8>, 256> ByteSpread = [] {
+    std::array<std::array<std::uint8_t, 8>, 256> table{};
+    for (int b = 0; b < 256; ++b)
+        for (int i = 0; i < 8; ++i) table[b][i] = static_cast<std::uint8_t>((b >> i) & 1);
+    return table;
+}();
+
+} // namespace
+
+VecEnv::VecEnv(int envs, std::uint64_t seed, unsigned threads, float frameSeconds, Randomizer mode)
+    : m_seed(seed), m_mode(mode), m_frameSeconds(frameSeconds) {
+    envs = std::max(envs, 1);
+    m_engines.reserve(static_cast<std::size_t>(envs));
+    for (int i = 0; i < envs; ++i) m_engines.emplace_back(PieceGenerator(seed, static_cast<std::uint64_t>(i), mode));
+    m_lastScore.assign(static_cast<std::size_t>(envs), 0);
+    m_games.assign(static_cast<std::size_t>(envs), 1);
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    m_chunks = std::max(1, std::min(static_cast<int>(threads), (envs + MinChunkEnvs - 1) / MinChunkEnvs));
+    if (m_chunks > 1) m_pool = std::make_unique<ThreadPool>(static_cast<unsigned>(m_chunks - 1));
+}
+
+void VecEnv::reset() {
+    runChunks([this](int first, int last) {
+        resetRange(first, last);
+        return 0;
+    });
+}
+
+int VecEnv::step(const std::uint8_t *actions) {
+    m_actions = actions;
+    return runChunks([this](int first, int last) { return stepRange(first, last); });
+}
+
+// Run work(first, last) over all chunks and return the sum of the results.
+template <typename F>
+int VecEnv::runChunks(F work) {
+    if (m_chunks == 1) return work(0, size());
+    struct Batch {
+        F *work = nullptr;
+        int size = 0, chunks = 1;
+        int remaining = 0; // guarded by mutex
+        std::atomic<int> ended{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        int bound(int chunk) const { return size * chunk / chunks; }
+    } batch;
+    batch.work = &work;
+    batch.size = size();
+    batch.chunks = m_chunks;
+    batch.remaining = m_chunks - 1;
+
+    // Two words of capture, small enough for std::function to store inline.
+    // The batch lives on this stack frame, so a task counts itself done and
+    // notifies under the lock: the caller cannot see remaining reach zero and
+    // return while the last task still touches the mutex or condition.
+    for (int c = 0; c < m_chunks - 1; ++c) {
+        m_pool->submit([b = &batch, c] {
+            b->ended += (*b->work)(b->bound(c), b->bound(c + 1));
+            std::lock_guard<std::mutex> lock(b->mutex);
+            if (--b->remaining == 0) b->finished.notify_all();
+        });
+    }
+    int ended = work(batch.bound(m_chunks - 1), size());
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.finished.wait(lock, [&] { return batch.remaining == 0; });
+    return ended + batch.ended.load();
+}
+
+int VecEnv::stepRange(int first, int last) {
+    int ended = 0;
+    for (int i = first; i < last; ++i) {
+        Engine &engine = m_engines[i];
+        std::uint8_t action = m_actions ? m_actions[i] : 0;
+        engine.step(action < static_cast<std::uint8_t>(Action::Count) ? static_cast<Action>(action) : Action::None);
+        engine.tick(m_frameSeconds);
+        bool done = !engine.running();
+        if (m_buffers.rewards) m_buffers.rewards[i] = static_cast<float>(engine.score() - m_lastScore[i]);
+        if (m_buffers.dones) m_buffers.dones[i] = done ? 1 : 0;
+        if (done) {
+            startGame(i);
+            ++ended;
+        }
+        m_lastScore[i] = engine.score();
+        observe(i);
+    }
+    return ended;
+}
+
+void VecEnv::resetRange(int first, int last) {
+    for (int i = first; i < last; ++i) {
+        startGame(i);
+        m_lastScore[i] = 0;
+        if (m_buffers.rewards) m_buffers.rewards[i] = 0.0f;
+        if (m_buffers.dones) m_buffers.dones[i] = 0;
+        observe(i);
+    }
+}
+
+void VecEnv::startGame(int env) {
+    std::uint64_t stream = (static_cast<std::uint64_t>(m_games[env]) << 32) | static_cast<std::uint32_t>(env);
+    m_engines[env].reset(PieceGenerator(m_seed, stream, m_mode));
+    ++m_games[env];
+}
+
+void VecEnv::observe(int env) {
+    const Engine &engine = m_engines[env];
+    const Tetromino &active = engine.active();
+    if (m_buffers.boards) {
+        std::uint8_t *cells = m_buffers.boards + static_cast<std::size_t>(env) * BoardSize;
+        const Board &board = engine.board();
+        for (int y = 0; y < BoardHeight; ++y) {
+            std::uint64_t row = board.row(y);
+            for (int x = 0; x < BoardWidth; x += 8)
+                std::memcpy(cells + y * BoardWidth + x, ByteSpread[(row >> x) & 0xFF].data(),
+                            static_cast<std::size_t>(std::min(8, BoardWidth - x)));
+        }
+        // The piece plane is empty while a line clear runs and after game over
+        std::uint8_t *piece = cells + BoardWidth * BoardHeight;
+        std::memset(piece, 0, BoardWidth * BoardHeight);
+        if (engine.running() && !engine.animating()) {
+            for (const Point &block : Tetromino::getShape(active.type, active.rotation)) {
+                Point p = active.position + block;
+                if (board.isInside(p)) piece[p.y * BoardWidth + p.x] = 1;
+            }
+        }
+    }
+    if (m_buffers.pieces) {
+        std::int32_t *fields = m_buffers.pieces + static_cast<std::size_t>(env) * PieceFields;
+        fields[0] = static_cast<std::int32_t>(active.type);
+        fields[1] = active.rotation;
+        fields[2] = active.position.x;
+        fields[3] = active.position.y;
+        fields[4] = static_cast<std::int32_t>(engine.next());
+    }
+}
@@ -0,0 +1,173 @@
+#include "../../include/tetris/Versus.hpp"
+#include "../../include/tetris/Policy.hpp"
+#include "../../include/tetris/Profiler.hpp"
+#include "../../include/tetris/Replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using namespace tetris;
+
+// Everything here but playing belongs to the player's simulation thread.
+struct Versus::Player {
+    int index = 0;
+    Engine engine;
+    SpscQueue<Action, 64> inputs;
+    TripleBuffer<VersusPlayerState> published;
+    std::atomic<bool> playing{true}; // read by the others when sending garbage
+
+    bool bot = false;
+    std::unique_ptr<Policy> policy;
+    ActionPath path;
+    int planned = -1, cursor = 0;
+
+    std::mt19937 holes;
+    int pending = 0, sent = 0, place = 0;
+    int target = 0; // next opponent to attack, as an offset - 1 from index
+    std::uint64_t ticks = 0;
+
+    Player(int i, std::uint64_t seed)
+        : index(i), engine(PieceGenerator(seed, 0)),
+          holes(static_cast<std::uint32_t>(detail::splitmix64(seed ^ (0x9E3779B97F4A7C15ull * (i + 1))))) {}
+
+    void publish() {
+        VersusPlayerState &out = published.back();
+        engine.snapshot(out.engine);
+        out.pendingGarbage = pending;
+        out.sentGarbage = sent;
+        out.place = place;
+        out.ticks = ticks;
+        published.publish();
+    }
+};
+
+Versus::Versus(int players, std::uint64_t seed)
+    : m_count(std::clamp(players, 2, MaxPlayers)), m_alive(m_count) {
+    for (int i = 0; i < m_count; ++i) {
+        m_players[i] = std::make_unique<Player>(i, seed);
+        m_players[i]->publish();
+        for (int to = 0; to < m_count; ++to)
+            if (to != i) m_garbage[i][to] = std::make_unique<GarbageQueue>();
+    }
+}
+
+Versus::~Versus() {
+    stop();
+}
+
+void Versus::setBot(int player, bool bot) {
+    Player &p = *m_players[player];
+    p.bot = bot;
+    if (bot && !p.policy) p.policy = std::make_unique<GreedyPolicy>();
+}
+
+bool Versus::isBot(int player) const {
+    return m_players[player]->bot;
+}
+
+void Versus::start() {
+    if (started()) return;
+    m_stop = false;
+    for (int i = 0; i < m_count; ++i) m_threads.emplace_back([this, i] { run(i); });
+}
+
+void Versus::stop() {
+    m_stop = true;
+    for (auto &t : m_threads) t.join();
+    m_threads.clear();
+}
+
+bool Versus::input(int player, Action action) {
+    return m_players[player]->inputs.push(action);
+}
+
+const VersusPlayerState& Versus::state(int player) {
+    Player &p = *m_players[player];
+    p.published.update();
+    return p.published.front();
+}
+
+// Fixed-rate loop: steps that fall due while the thread was not scheduled
+// are caught up, but a stall of more than a quarter second is skipped.
+void Versus::run(int player) {
+    static const char *const names[MaxPlayers] = {"versus 1", "versus 2", "versus 3", "versus 4",
+                                                  "versus 5", "versus 6", "versus 7", "versus 8"};
+    profiler::setThreadName(names[player]);
+    using Clock = std::chrono::steady_clock;
+    const auto stepTime = std::chrono::microseconds(LogicStepMicros);
+    auto next = Clock::now();
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        auto now = Clock::now();
+        if (now - next > std::chrono::milliseconds(250)) next = now;
+        while (next <= now) {
+            TETRIS_PROFILE_SCOPE("Versus::step");
+            step(player);
+            next += stepTime;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void Versus::step(int player) {
+    Player &p = *m_players[player];
+    if (!p.place) {
+        std::int32_t rows;
+        for (int from = 0; from < m_count; ++from)
+            if (from != player)
+                while (m_garbage[from][player]->pop(rows)) p.pending += rows;
+
+        Action action;
+        while (p.inputs.pop(action)) afterEvents(p, p.engine.step(action));
+        if (p.bot && !p.engine.animating() && p.ticks % BotStepInterval == 0) {
+            if (p.planned != p.engine.piecesPlaced()) {
+                p.policy->plan(p.engine, p.path);
+                p.planned = p.engine.piecesPlaced();
+                p.cursor = 0;
+            }
+            if (p.cursor < p.path.count) afterEvents(p, p.engine.step(p.path.actions[p.cursor++]));
+        }
+        afterEvents(p, p.engine.tick(replay::tickSeconds(LogicStepMicros)));
+        ++p.ticks;
+
+        // Topping out takes the worst place left; the last one playing wins
+        if (!p.engine.running()) {
+            p.playing.store(false, std::memory_order_release);
+            p.place = m_alive.fetch_sub(1, std::memory_order_acq_rel);
+        } else if (m_alive.load(std::memory_order_acquire) == 1) {
+            p.playing.store(false, std::memory_order_release);
+            p.place = 1;
+        }
+    }
+    p.publish();
+}
+
+void Versus::afterEvents(Player &p, Events ev) {
+    if (!(ev & events::Locked)) return;
+    int cleared = (ev & events::LinesCleared) ? static_cast<int>(p.engine.linesToClear().size()) : 0;
+    int rows = Engine::garbageForLines(cleared);
+    int cancelled = std::min(rows, p.pending);
+    p.pending -= cancelled;
+    rows -= cancelled;
+    if (rows > 0) {
+        p.sent += rows;
+        sendGarbage(p.index, rows);
+    }
+    if (!cleared && p.pending > 0) {
+        int risen = std::min(p.pending, MaxGarbagePerLock);
+        p.engine.addGarbage(risen, static_cast<int>(p.holes() % BoardWidth));
+        p.pending -= risen;
+    }
+}
+
+void Versus::sendGarbage(int player, int rows) {
+    Player &p = *m_players[player];
+    for (int k = 0; k < m_count - 1; ++k) {
+        int offset = (p.target + k) % (m_count - 1);
+        int to = (player + 1 + offset) % m_count;
+        if (!m_players[to]->playing.load(std::memory_order_acquire)) continue;
+        // A full queue drops the attack; 64 unread attacks do not happen in play
+        m_garbage[player][to]->push(rows);
+        p.target = (offset + 1) % (m_count - 1);
+        return;
+    }
+}
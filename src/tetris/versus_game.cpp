@@ -0,0 +1,178 @@
+#include "../../include/tetris/VersusGame.hpp"
+#include "../../include/tetris/Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace tetris;
+
+namespace {
+
+struct KeyBinding {
+    sf::Keyboard::Key key;
+    int player;
+    Action action;
+};
+
+// Player 1 on WASD + Space, player 2 on the arrows + Enter. With a single
+// human both sets drive player 1.
+constexpr KeyBinding Bindings[] = {
+    {sf::Keyboard::Key::A, 0, Action::Left},
+    {sf::Keyboard::Key::D, 0, Action::Right},
+    {sf::Keyboard::Key::S, 0, Action::SoftDrop},
+    {sf::Keyboard::Key::W, 0, Action::Rotate},
+    {sf::Keyboard::Key::Space, 0, Action::HardDrop},
+    {sf::Keyboard::Key::Left, 1, Action::Left},
+    {sf::Keyboard::Key::Right, 1, Action::Right},
+    {sf::Keyboard::Key::Down, 1, Action::SoftDrop},
+    {sf::Keyboard::Key::Up, 1, Action::Rotate},
+    {sf::Keyboard::Key::Enter, 1, Action::HardDrop},
+};
+
+int gridColumns(int players) { return std::min(players, VersusGame::GridColumns); }
+int gridRows(int players) { return (players + VersusGame::GridColumns - 1) / VersusGame::GridColumns; }
+
+} // namespace
+
+sf::Vector2u VersusGame::windowSize(int players) {
+    players = std::clamp(players, 2, Versus::MaxPlayers);
+    int width = gridColumns(players) * PanelWidth;
+    int height = gridRows(players) * PanelHeight;
+    // two rows of boards are shrunk to stay on a 1080p screen
+    float scale = std::min(1.0f, 900.0f / static_cast<float>(height));
+    return sf::Vector2u(static_cast<unsigned>(width * scale), static_cast<unsigned>(height * scale));
+}
+
+VersusGame::VersusGame(sf::RenderWindow &window, int players, int humans, std::uint64_t seed,
+                       const std::string &bundlePath)
+    : m_window(window), m_versus(players, seed), m_humans(std::clamp(humans, 0, MaxHumans)) {
+    profiler::setThreadName("main");
+    const int count = m_versus.players();
+    const float columns = static_cast<float>(gridColumns(count));
+    const float rows = static_cast<float>(gridRows(count));
+    for (int p = 0; p < count; ++p) {
+        m_versus.setBot(p, p >= m_humans);
+        m_panels[p] = std::make_unique<Panel>();
+        Panel &panel = *m_panels[p];
+        panel.view = sf::View(sf::FloatRect(sf::Vector2f(0.f, 0.f), sf::Vector2f(PanelWidth, PanelHeight)));
+        panel.view.setViewport(sf::FloatRect(sf::Vector2f(static_cast<float>(p % GridColumns) / columns,
+                                                          static_cast<float>(p / GridColumns) / rows),
+                                             sf::Vector2f(1.f / columns, 1.f / rows)));
+    }
+    // moves are entered one press at a time, so OS key repeat is the DAS here
+    m_window.setKeyRepeatEnabled(true);
+    m_pendingAssets = std::async(std::launch::async, [bundlePath] { return loadGameAssets(bundlePath); });
+}
+
+void VersusGame::installAssets(GameAssets assets) {
+    m_font.reset();
+    m_bundle = std::move(assets.bundle);
+    m_font = std::move(assets.font);
+    if (!m_font) return;
+    for (int p = 0; p < m_versus.players(); ++p) {
+        Panel &panel = *m_panels[p];
+        panel.text.emplace(*m_font, "", 16);
+        panel.text->setFillColor(sf::Color::White);
+        panel.text->setPosition(sf::Vector2f(static_cast<float>(BoardWidth * CellSize + 14), 10.f));
+        panel.shownScore = -1;
+    }
+    m_resultText.emplace(*m_font, "", 28);
+    m_resultText->setFillColor(sf::Color::White);
+    m_resultText->setPosition(sf::Vector2f(10.f, 10.f));
+}
+
+void VersusGame::handleKey(sf::Keyboard::Key key) {
+    for (const KeyBinding &b : Bindings) {
+        if (b.key != key) continue;
+        int player = m_humans == 1 ? 0 : b.player;
+        if (player < m_humans) m_versus.input(player, b.action);
+    }
+}
+
+void VersusGame::processInput() {
+    while (const std::optional<sf::Event> event = m_window.pollEvent()) {
+        if (event->is<sf::Event::Closed>()) m_window.close();
+        if (event->is<sf::Event::KeyPressed>()) {
+            auto key = event->getIf<sf::Event::KeyPressed>()->code;
+            if (key == sf::Keyboard::Key::Escape) m_window.close();
+            handleKey(key);
+        }
+    }
+}
+
+void VersusGame::refreshText(Panel &panel, int player, const VersusPlayerState &state) {
+    if (!panel.text) return;
+    if (state.engine.score == panel.shownScore && state.engine.totalLines == panel.shownLines &&
+        state.pendingGarbage == panel.shownPending && state.place == panel.shownPlace)
+        return;
+    panel.shownScore = state.engine.score;
+    panel.shownLines = state.engine.totalLines;
+    panel.shownPending = state.pendingGarbage;
+    panel.shownPlace = state.place;
+    char buf[160];
+    int n = std::snprintf(buf, sizeof(buf), "P%d %s\n\nScore: %d\nLines: %d\nGarbage: %d\nSent: %d",
+                          player + 1, m_versus.isBot(player) ? "(bot)" : "", state.engine.score,
+                          state.engine.totalLines, state.pendingGarbage, state.sentGarbage);
+    if (state.place == 1) std::snprintf(buf + n, sizeof(buf) - n, "\n\nWinner");
+    else if (state.place) std::snprintf(buf + n, sizeof(buf) - n, "\n\nOut: #%d", state.place);
+    panel.text->setString(buf);
+}
+
+void VersusGame::render() {
+    TETRIS_PROFILE_SCOPE("VersusGame::render");
+    m_window.clear(sf::Color::Black);
+    const float boardWidth = static_cast<float>(BoardWidth * CellSize);
+    const float boardHeight = static_cast<float>(BoardHeight * CellSize);
+    for (int p = 0; p < m_versus.players(); ++p) {
+        Panel &panel = *m_panels[p];
+        const VersusPlayerState &state = m_versus.state(p);
+        panel.engine.restore(state.engine);
+        panel.renderer.update(panel.engine);
+
+        // incoming garbage as a red bar beside the board, one cell per row
+        float meter = static_cast<float>(std::min(state.pendingGarbage, BoardHeight) * CellSize);
+        if (meter > 0.f)
+            panel.renderer.setRect(HudRect::GarbageMeter, sf::FloatRect(sf::Vector2f(boardWidth + 2.f, boardHeight - meter),
+                                                                        sf::Vector2f(6.f, meter)), sf::Color(220, 40, 40));
+        else
+            panel.renderer.setRect(HudRect::GarbageMeter, sf::FloatRect(), sf::Color::Transparent);
+        if (state.place > 1)
+            panel.renderer.setRect(HudRect::GameOverShade, sf::FloatRect(sf::Vector2f(0.f, 0.f), sf::Vector2f(boardWidth, boardHeight)),
+                                   sf::Color(0, 0, 0, 160));
+        else
+            panel.renderer.setRect(HudRect::GameOverShade, sf::FloatRect(), sf::Color::Transparent);
+
+        m_window.setView(panel.view);
+        panel.renderer.draw(m_window);
+        refreshText(panel, p, state);
+        if (panel.text) m_window.draw(*panel.text);
+    }
+    m_window.setView(m_window.getDefaultView());
+    if (m_resultText && m_versus.alive() <= 1) m_window.draw(*m_resultText);
+    TETRIS_PROFILE_SCOPE("render.display");
+    m_window.display();
+}
+
+void VersusGame::run() {
+    m_versus.start();
+    bool announced = false;
+    while (m_window.isOpen()) {
+        TETRIS_PROFILE_SCOPE("frame");
+        processInput();
+        render();
+        if (m_pendingAssets.valid() && m_pendingAssets.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            installAssets(m_pendingAssets.get());
+        if (!announced && m_versus.alive() <= 1) {
+            // the winner publishes its place on its next step
+            for (int p = 0; p < m_versus.players(); ++p) {
+                if (m_versus.state(p).place != 1) continue;
+                char buf[64];
+                std::snprintf(buf, sizeof(buf), "Player %d wins - Esc to quit", p + 1);
+                std::printf("%s\n", buf);
+                if (m_resultText) m_resultText->setString(buf);
+                announced = true;
+            }
+        }
+    }
+    m_versus.stop();
+}
@@ -0,0 +1,98 @@
+// Compares the bitboard Board against the previous cell-grid layout.
+#include "tetris/Board.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace tetris;
+
+namespace {
+
+// Reference copy of the former per-cell implementation
+struct GridBoard {
+    std::array<std::array<Cell, BoardWidth>, BoardHeight> grid;
+
+    bool isValidPosition(const std::array<Point,4> &blocks, const Point &pos) const {
+        for (const auto &b : blocks) {
+            Point p = pos + b;
+            if (p.x < 0 || p.x >= BoardWidth || p.y >= BoardHeight) return false;
+            if (p.y >= 0 && grid[p.y][p.x].color != -1) return false;
+        }
+        return true;
+    }
+    void place(int x, int y, int color) { grid[y][x].color = color; }
+    std::vector<int> getFullLines() const {
+        std::vector<int> lines;
+        for (int y = 0; y < BoardHeight; ++y) {
+            bool full = true;
+            for (int x = 0; x < BoardWidth; ++x) {
+                if (grid[y][x].color == -1) { full = false; break; }
+            }
+            if (full) lines.push_back(y);
+        }
+        return lines;
+    }
+    void removeLines(const std::vector<int>& lines) {
+        if (lines.empty()) return;
+        std::array<std::array<Cell, BoardWidth>, BoardHeight> newGrid;
+        int write = BoardHeight - 1;
+        for (int y = BoardHeight - 1; y >= 0; --y) {
+            if (std::find(lines.begin(), lines.end(), y) != lines.end()) continue;
+            newGrid[write] = grid[y];
+            --write;
+        }
+        grid = newGrid;
+    }
+};
+
+template<class F>
+double nsPerOp(int iterations, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) f(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+volatile long long sink = 0;
+
+} // namespace
+
+int main() {
+    constexpr int Iterations = 2000000;
+    std::mt19937 rng(1234);
+    const std::array<Point,4> tShape = { Point{1,0}, Point{0,1}, Point{1,1}, Point{2,1} };
+
+    // Bottom half filled at ~70%, with four complete rows to clear
+    Board board;
+    GridBoard grid;
+    for (int y = BoardHeight / 2; y < BoardHeight; ++y) {
+        for (int x = 0; x < BoardWidth; ++x) {
+            bool full = y >= BoardHeight - 4;
+            if (full || rng() % 10 < 7) {
+                board.place({ Point{0,0}, Point{0,0}, Point{0,0}, Point{0,0} }, Point{x,y}, 0);
+                grid.place(x, y, 0);
+            }
+        }
+    }
+    std::array<Point,16> positions;
+    for (auto &p : positions) p = Point{static_cast<int>(rng() % BoardWidth) - 1, static_cast<int>(rng() % BoardHeight)};
+
+    double gridValid = nsPerOp(Iterations, [&](int i) { sink += grid.isValidPosition(tShape, positions[i & 15]); });
+    double bitValid = nsPerOp(Iterations, [&](int i) { sink += board.isValidPosition(tShape, positions[i & 15]); });
+    const ShapeInfo &tInfo = Tetromino::shape(TetrominoType::T, 0);
+    double maskValid = nsPerOp(Iterations, [&](int i) { sink += board.isValidPosition(tInfo, positions[i & 15]); });
+    double gridFull = nsPerOp(Iterations, [&](int) { sink += grid.getFullLines().size(); });
+    double bitFull = nsPerOp(Iterations, [&](int) { sink += board.getFullLines().size(); });
+    const LineList lines = board.getFullLines();
+    const std::vector<int> gridLines(lines.begin(), lines.end());
+    double gridRemove = nsPerOp(Iterations / 10, [&](int) { GridBoard g = grid; g.removeLines(gridLines); sink += g.grid[0][0].color; });
+    double bitRemove = nsPerOp(Iterations / 10, [&](int) { Board b = board; b.removeLines(lines); sink += b.row(0); });
+
+    std::printf("%-18s %12s %12s %8s\n", "operation", "grid ns/op", "bits ns/op", "speedup");
+    std::printf("%-18s %12.2f %12.2f %7.1fx\n", "isValidPosition", gridValid, bitValid, gridValid / bitValid);
+    std::printf("%-18s %12.2f %12.2f %7.1fx\n", "  (row masks)", gridValid, maskValid, gridValid / maskValid);
+    std::printf("%-18s %12.2f %12.2f %7.1fx\n", "getFullLines", gridFull, bitFull, gridFull / bitFull);
+    std::printf("%-18s %12.2f %12.2f %7.1fx\n", "copy+removeLines", gridRemove, bitRemove, gridRemove / bitRemove);
+    return 0;
+}
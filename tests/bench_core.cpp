@@ -0,0 +1,198 @@
+// Microbenchmarks of the board and engine hot paths at several stack heights.
+//
+//   bench_core [--quick] [--out file.json] [--compare earlier.json [--threshold percent]]
+//
+// Writes one JSON record per operation and fill level; with --compare it
+// also prints the change against an earlier run, e.g. of the previous commit.
+#include "bench_util.hpp"
+#include "tetris/BatchEvaluator.hpp"
+#include "tetris/Bot.hpp"
+#include "tetris/Engine.hpp"
+#include "tetris/FrameExport.hpp"
+#include "tetris/VecEnv.hpp"
+#include <array>
+#include <memory>
+#include <thread>
+
+using namespace tetris;
+
+namespace {
+
+constexpr int Fills[] = {0, 25, 50, 75};
+
+// A piece and position to test or place; positions cover the whole board,
+// so at higher fills more of them collide.
+struct Probe {
+    const ShapeInfo *shape;
+    const std::array<Point,4> *blocks;
+    Point pos;
+};
+
+std::array<Probe, 64> makeProbes(std::uint64_t seed) {
+    std::array<Probe, 64> probes;
+    for (auto &p : probes) {
+        seed = detail::splitmix64(seed);
+        auto type = static_cast<TetrominoType>(seed % PieceCount);
+        int rotation = static_cast<int>((seed >> 8) & 3);
+        p.shape = &Tetromino::shape(type, rotation);
+        p.blocks = &Tetromino::getShape(type, rotation);
+        p.pos = Point{static_cast<int>((seed >> 16) % (BoardWidth - 1)), static_cast<int>((seed >> 24) % (BoardHeight - 1))};
+    }
+    return probes;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::Options opt;
+    if (!bench::parseOptions(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: bench_core %s\n", bench::Usage);
+        return 2;
+    }
+    std::vector<bench::Result> results;
+    const auto probes = makeProbes(99);
+
+    results.push_back(bench::measure(opt, "Tetromino::getShape", 0, [&](int i) {
+        const auto &blocks = Tetromino::getShape(static_cast<TetrominoType>(i % PieceCount), (i >> 3) & 3);
+        bench::sink += blocks[0].x + blocks[3].y;
+    }));
+
+    for (int fill : Fills) {
+        const Board board = bench::filledBoard<BoardWidth, BoardHeight>(fill, 0, 1000 + static_cast<std::uint64_t>(fill));
+        const Board clearing = bench::filledBoard<BoardWidth, BoardHeight>(std::max(fill, 20), 4, 2000 + static_cast<std::uint64_t>(fill));
+        const LineList lines = clearing.getFullLines();
+
+        results.push_back(bench::measure(opt, "Board::isValidPosition", fill, [&](int i) {
+            const Probe &p = probes[i & 63];
+            bench::sink += board.isValidPosition(*p.blocks, p.pos);
+        }));
+        results.push_back(bench::measure(opt, "Board::isValidPosition(masks)", fill, [&](int i) {
+            const Probe &p = probes[i & 63];
+            bench::sink += board.isValidPosition(*p.shape, p.pos);
+        }));
+        // place() does not check for overlap, so the same board takes every probe
+        Board scratch = board;
+        results.push_back(bench::measure(opt, "Board::place", fill, [&](int i) {
+            const Probe &p = probes[i & 63];
+            scratch.place(*p.blocks, p.pos, i % PieceCount);
+        }));
+        bench::sink += static_cast<long long>(scratch.hash());
+        // Every rotation of every piece at every column, from the top row
+        std::vector<Probe> drops;
+        for (int t = 0; t < PieceCount; ++t)
+            for (int r = 0; r < RotationCount; ++r) {
+                const ShapeInfo &shape = Tetromino::shape(static_cast<TetrominoType>(t), r);
+                for (int x = -shape.minX; x + shape.maxX < BoardWidth; ++x)
+                    drops.push_back(Probe{&shape, &shape.blocks, Point{x, -shape.minY}});
+            }
+        results.push_back(bench::measure(opt, "Board::dropDistance", fill, [&](int i) {
+            const Probe &p = drops[static_cast<std::size_t>(i) % drops.size()];
+            bench::sink += board.dropDistance(*p.shape, p.pos);
+        }));
+        results.push_back(bench::measure(opt, "Board::getFullLines", fill, [&](int) {
+            bench::sink += board.getFullLines().size();
+        }));
+        results.push_back(bench::measure(opt, "Board::getFullLines(4 full)", fill, [&](int) {
+            bench::sink += clearing.getFullLines().size();
+        }));
+        results.push_back(bench::measure(opt, "Board::getFullLines(4 rows)", fill, [&](int) {
+            bench::sink += clearing.getFullLines(BoardHeight - 4, BoardHeight - 1).size();
+        }));
+        results.push_back(bench::measure(opt, "Board copy", fill, [&](int) {
+            Board b = clearing;
+            bench::keep(b);
+        }));
+        results.push_back(bench::measure(opt, "Board copy+removeLines(4)", fill, [&](int) {
+            Board b = clearing;
+            b.removeLines(lines);
+            bench::keep(b);
+        }));
+
+        // Engine positions with this stack and a fresh piece at the spawn
+        Engine engine(PieceGenerator(7, static_cast<std::uint64_t>(fill)));
+        Engine::Snapshot start = engine.snapshot();
+        start.board = board;
+        results.push_back(bench::measure(opt, "Engine::restore", fill, [&](int) {
+            engine.restore(start);
+            bench::sink += engine.score();
+        }));
+        // One 240 Hz logic step with an input on most steps; pieces lock,
+        // clear lines and spawn as in play. Restored every 32 steps so the
+        // stack height stays near the fill level.
+        static const Action Inputs[8] = {Action::Left, Action::Rotate, Action::None, Action::Right,
+                                         Action::SoftDrop, Action::Left, Action::None, Action::SoftDrop};
+        results.push_back(bench::measure(opt, "Engine::step+tick", fill, [&](int i) {
+            if ((i & 31) == 0) engine.restore(start);
+            engine.step(Inputs[i & 7]);
+            bench::sink += engine.tick(1.0f / 240.0f);
+        }));
+        results.push_back(bench::measure(opt, "Engine::restore+hardDrop", fill, [&](int) {
+            engine.restore(start);
+            bench::sink += engine.step(Action::HardDrop);
+        }));
+
+        // Board heuristics one by one and a full batch per call; reported
+        // per board, so the levels compare directly.
+        auto batch = std::make_unique<BoardBatch>();
+        std::vector<Board> boards;
+        for (int i = 0; i < BoardBatch::Capacity; ++i) {
+            boards.push_back(bench::filledBoard<BoardWidth, BoardHeight>(fill, 0, 3000 + static_cast<std::uint64_t>(i)));
+            batch->add(boards.back(), i % 3);
+        }
+        const BotWeights botWeights;
+        results.push_back(bench::measure(opt, "Bot::evaluate", fill, [&](int i) {
+            bench::sink += static_cast<long long>(Bot::evaluate(boards[i & (BoardBatch::Capacity - 1)], 0, botWeights));
+        }));
+        auto scores = std::make_unique<BatchResult>();
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            if (!simdLevelSupported(level)) continue;
+            BatchEvaluator evaluator({}, level);
+            std::string name = std::string("BatchEvaluator(") + simdLevelName(level) + ")";
+            bench::Result r = bench::measure(opt, name.c_str(), fill, [&](int) {
+                evaluator.evaluate(*batch, *scores);
+                bench::keep(*scores);
+            });
+            r.nsPerOp /= BoardBatch::Capacity;
+            r.minNsPerOp /= BoardBatch::Capacity;
+            std::fprintf(stderr, "%-24s fill %2d%%: %.1f M boards/s\n", name.c_str(), fill, 1e3 / r.nsPerOp);
+            results.push_back(r);
+        }
+    }
+
+    // Batched RL environments with every observation written, reported per
+    // environment step; games run from empty boards to game over and reset.
+    constexpr int Envs = 256;
+    std::vector<std::uint8_t> boards(Envs * VecEnv::BoardSize), dones(Envs), actions(Envs * 8);
+    std::vector<std::int32_t> pieces(Envs * VecEnv::PieceFields);
+    std::vector<float> rewards(Envs);
+    for (std::size_t i = 0; i < actions.size(); ++i) actions[i] = static_cast<std::uint8_t>(detail::splitmix64(i) % 6);
+    std::vector<unsigned> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1) threadCounts.push_back(0);
+    for (unsigned threads : threadCounts) {
+        VecEnv env(Envs, 11, threads);
+        env.setBuffers(VecEnvBuffers{boards.data(), pieces.data(), rewards.data(), dones.data()});
+        env.reset();
+        std::string name = "VecEnv::step(" + std::to_string(env.threads()) + " threads)";
+        bench::Result r = bench::measure(opt, name.c_str(), 0, [&](int i) {
+            bench::sink += env.step(actions.data() + (i & 7) * Envs);
+        });
+        r.nsPerOp /= Envs;
+        r.minNsPerOp /= Envs;
+        std::fprintf(stderr, "%-24s: %.2f M env steps/s\n", name.c_str(), 1e3 / r.nsPerOp);
+        results.push_back(r);
+    }
+
+    // Y4M conversion of one export_replay frame (the game window size)
+    {
+        const unsigned width = BoardWidth * CellSize + 200, height = BoardHeight * CellSize;
+        std::vector<std::uint8_t> rgba(std::size_t(width) * height * 4), yuv;
+        for (std::size_t i = 0; i < rgba.size(); ++i) rgba[i] = static_cast<std::uint8_t>(detail::splitmix64(i));
+        bench::Result r = bench::measure(opt, "convertToYuv(500x600)", 0, [&](int) {
+            convertToYuv(rgba.data(), width, height, yuv);
+            bench::sink += yuv[6];
+        });
+        std::fprintf(stderr, "%-24s: %.0f frames/s per thread\n", "convertToYuv(500x600)", 1e9 / r.nsPerOp);
+        results.push_back(r);
+    }
+    return bench::finish(opt, "core", results);
+}
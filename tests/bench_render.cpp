@@ -0,0 +1,46 @@
+// Offscreen frame time of Game::draw at several stack heights.
+//
+//   bench_render [--quick] [--out file.json] [--compare earlier.json [--threshold percent]]
+//
+// Draws into a RenderTexture the size of the game window, so it runs without
+// a visible window (under Xvfb on a machine without a display). "draw" is
+// the CPU cost of building and submitting a frame; "draw+readback" also waits
+// for the GPU by copying the frame back to memory.
+#include "bench_util.hpp"
+#include "tetris/Game.hpp"
+
+using namespace tetris;
+
+int main(int argc, char **argv) {
+    bench::Options opt;
+    if (!bench::parseOptions(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: bench_render %s\n", bench::Usage);
+        return 2;
+    }
+    const sf::Vector2u size(BoardWidth * CellSize + 200, BoardHeight * CellSize);
+    // Game needs a window for input; it stays hidden and is never drawn to
+    sf::RenderWindow window(sf::VideoMode(size), "bench_render");
+    window.setVisible(false);
+    sf::RenderTexture target(size);
+
+    Game game(window, {}, {}, TETRIS_BENCH_BUNDLE);
+    game.waitForAssets();
+
+    std::vector<bench::Result> results;
+    for (int fill : {0, 25, 50, 75}) {
+        Engine::Snapshot position = game.engine().snapshot();
+        position.board = bench::filledBoard<BoardWidth, BoardHeight>(fill, 0, 1000 + static_cast<std::uint64_t>(fill));
+        game.restore(position);
+
+        results.push_back(bench::measure(opt, "Game::draw", fill, [&](int i) {
+            game.draw(target, static_cast<float>(i & 7) * 5e-4f);
+            target.display();
+        }));
+        results.push_back(bench::measure(opt, "Game::draw+readback", fill, [&](int i) {
+            game.draw(target, static_cast<float>(i & 7) * 5e-4f);
+            target.display();
+            bench::sink += target.getTexture().copyToImage().getPixelsPtr()[0];
+        }));
+    }
+    return bench::finish(opt, "render", results);
+}
@@ -0,0 +1,186 @@
+// Timing, board fixtures and JSON output shared by the benchmark programs.
+#pragma once
+
+#include "tetris/Board.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Result {
+    std::string name;
+    int fill;            // percent of the board height that is stacked
+    double nsPerOp;      // median over the samples
+    double minNsPerOp;
+    long long iterations; // per sample
+};
+
+struct Options {
+    double sampleSeconds = 0.05; // --quick: 0.002
+    int samples = 5;
+    std::string out;       // JSON file, stdout when empty
+    std::string compare;   // earlier JSON output to print deltas against
+    double threshold = 0;  // with --compare: exit 1 when an op got slower by more than this percent
+};
+
+inline volatile long long sink = 0;
+
+// Make the compiler assume value is read and written here, so work whose
+// result is otherwise unused is not optimized away.
+template <typename T>
+inline void keep(T &value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void *volatile escape;
+    escape = &value;
+#endif
+}
+
+// Parse the options every benchmark understands; returns false on unknown ones.
+inline bool parseOptions(int argc, char **argv, Options &opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(argv[i], "--quick") == 0) { opt.sampleSeconds = 0.002; opt.samples = 3; continue; }
+        if (!value) return false;
+        if (std::strcmp(argv[i], "--out") == 0) opt.out = value;
+        else if (std::strcmp(argv[i], "--compare") == 0) opt.compare = value;
+        else if (std::strcmp(argv[i], "--threshold") == 0) opt.threshold = std::atof(value);
+        else return false;
+        ++i;
+    }
+    return true;
+}
+
+// Time op(i) for i = 0, 1, ...: the iteration count is doubled until one
+// sample takes sampleSeconds, then the median of opt.samples runs is kept.
+template <typename F>
+Result measure(const Options &opt, const char *name, int fill, F &&op) {
+    using Clock = std::chrono::steady_clock;
+    auto run = [&](long long n) {
+        auto start = Clock::now();
+        for (long long i = 0; i < n; ++i) op(static_cast<int>(i));
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+    long long n = 1;
+    while (run(n) < opt.sampleSeconds && n < (1ll << 40)) n *= 2;
+    std::vector<double> ns;
+    for (int s = 0; s < opt.samples; ++s) ns.push_back(run(n) * 1e9 / static_cast<double>(n));
+    std::sort(ns.begin(), ns.end());
+    return Result{name, fill, ns[ns.size() / 2], ns.front(), n};
+}
+
+// A board stacked to fill percent of its height: each stacked row is about
+// 70% occupied with at least one hole, except the fullRows bottom rows, which
+// are complete.
+template <int W, int H>
+tetris::BasicBoard<W, H> filledBoard(int fill, int fullRows, std::uint64_t seed) {
+    tetris::BasicBoard<W, H> board;
+    int stacked = std::max(H * fill / 100, fullRows);
+    for (int y = H - stacked; y < H; ++y) {
+        bool full = y >= H - fullRows;
+        int hole = static_cast<int>(tetris::detail::splitmix64(seed + static_cast<std::uint64_t>(y) * 131) % W);
+        for (int x = 0; x < W; ++x) {
+            seed = tetris::detail::splitmix64(seed);
+            if (full || (x != hole && seed % 10 < 7)) board.setCell(x, y, static_cast<int>(seed % tetris::PieceCount));
+        }
+    }
+    return board;
+}
+
+inline const char* compilerVersion() {
+#ifdef __VERSION__
+    return __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+inline const char* buildType() {
+#ifdef NDEBUG
+    return "release";
+#else
+    return "debug";
+#endif
+}
+
+// One result per line, so earlier runs can be read back without a JSON parser.
+inline bool writeJson(const Options &opt, const char *suite, const std::vector<Result> &results) {
+    std::FILE *f = opt.out.empty() ? stdout : std::fopen(opt.out.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"suite\": \"%s\", \"build\": \"%s\", \"compiler\": \"%s\",\n  \"results\": [\n",
+                 suite, buildType(), compilerVersion());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result &r = results[i];
+        std::fprintf(f, "    {\"name\": \"%s\", \"fill\": %d, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"iterations\": %lld}%s\n",
+                     r.name.c_str(), r.fill, r.nsPerOp, r.minNsPerOp, r.iterations, i + 1 < results.size() ? "," : "");
+    }
+    std::fputs("  ]\n}\n", f);
+    return f == stdout || std::fclose(f) == 0;
+}
+
+// Read the results back from a file written by writeJson.
+inline bool readJson(const std::string &path, std::vector<Result> &out) {
+    std::FILE *f = std::fopen(path.c_str(), "r");
+    if (!f) return false;
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        const char *name = std::strstr(line, "\"name\": \"");
+        const char *fill = std::strstr(line, "\"fill\": ");
+        const char *ns = std::strstr(line, "\"ns_per_op\": ");
+        if (!name || !fill || !ns) continue;
+        name += 9;
+        const char *nameEnd = std::strchr(name, '"');
+        if (!nameEnd) continue;
+        Result r{std::string(name, nameEnd), std::atoi(fill + 8), std::atof(ns + 13), 0, 0};
+        out.push_back(r);
+    }
+    std::fclose(f);
+    return true;
+}
+
+// Print old and new times per operation to stderr; returns false when an
+// operation slowed down by more than opt.threshold percent.
+inline bool compare(const Options &opt, const std::vector<Result> &results) {
+    std::vector<Result> before;
+    if (!readJson(opt.compare, before)) {
+        std::fprintf(stderr, "cannot read %s\n", opt.compare.c_str());
+        return false;
+    }
+    bool ok = true;
+    std::fprintf(stderr, "%-32s %5s %12s %12s %8s\n", "operation", "fill", "before ns", "now ns", "change");
+    for (const Result &r : results) {
+        auto old = std::find_if(before.begin(), before.end(),
+                                [&](const Result &b) { return b.name == r.name && b.fill == r.fill; });
+        if (old == before.end() || old->nsPerOp <= 0) {
+            std::fprintf(stderr, "%-32s %4d%% %12s %12.2f %8s\n", r.name.c_str(), r.fill, "-", r.nsPerOp, "new");
+            continue;
+        }
+        double change = (r.nsPerOp / old->nsPerOp - 1.0) * 100.0;
+        bool slower = opt.threshold > 0 && change > opt.threshold;
+        ok = ok && !slower;
+        std::fprintf(stderr, "%-32s %4d%% %12.2f %12.2f %+7.1f%%%s\n", r.name.c_str(), r.fill, old->nsPerOp, r.nsPerOp,
+                     change, slower ? "  SLOWER" : "");
+    }
+    return ok;
+}
+
+// Write the results and run the comparison the options ask for; the exit
+// code of a benchmark program.
+inline int finish(const Options &opt, const char *suite, const std::vector<Result> &results) {
+    if (!writeJson(opt, suite, results)) {
+        std::fprintf(stderr, "cannot write %s\n", opt.out.c_str());
+        return 1;
+    }
+    if (!opt.compare.empty() && !compare(opt, results)) return 1;
+    return 0;
+}
+
+constexpr const char *Usage = "[--quick] [--out file.json] [--compare earlier.json [--threshold percent]]";
+
+} // namespace bench
@@ -0,0 +1,29 @@
+// Fails when the engine allocates on the heap after construction.
+#include "tetris/AllocCounter.hpp"
+#include "tetris/Engine.hpp"
+#include <cstdio>
+
+using namespace tetris;
+
+int main() {
+    Engine engine(99);
+    unsigned state = 3;
+    std::uint64_t before = allocationCount();
+    int games = 0;
+    for (int i = 0; i < 200000; ++i) {
+        state = state * 1103515245u + 12345u;
+        engine.step(static_cast<Action>((state >> 16) % static_cast<unsigned>(Action::Count)));
+        engine.tick(1.0f / 60.0f);
+        if (!engine.running()) {
+            engine.reset(state);
+            ++games;
+        }
+    }
+    std::uint64_t allocations = allocationCount() - before;
+    std::printf("%d games, %llu allocations\n", games, static_cast<unsigned long long>(allocations));
+    if (allocations != 0) {
+        std::printf("FAILED: engine allocated during steady-state updates\n");
+        return 1;
+    }
+    return 0;
+}
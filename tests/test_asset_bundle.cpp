@@ -0,0 +1,61 @@
+// Files packed into a bundle come back byte for byte through the mapping;
+// missing entries and damaged bundles are reported, not crashed on.
+#include "tetris/AssetBundle.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static void writeFile(const std::filesystem::path &path, const std::string &data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = "test_asset_bundle_dir";
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    std::string big(100000, '\0');
+    for (std::size_t i = 0; i < big.size(); ++i) big[i] = static_cast<char>(i * 31 + 7);
+    writeFile(dir / "rotate.wav", "RIFF-rotate");
+    writeFile(dir / "clear.wav", big);
+    writeFile(dir / "empty.txt", "");
+
+    const std::string pak = "test_asset_bundle.pak";
+    CHECK(writeAssetBundle(dir.string(), pak) == 3);
+
+    {
+        AssetBundle bundle;
+        CHECK(bundle.open(pak));
+        CHECK(bundle.size() == 3);
+        AssetBundle::View clear = bundle.find("clear.wav");
+        CHECK(clear && clear.size == big.size());
+        CHECK(std::memcmp(clear.data, big.data(), big.size()) == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(clear.data) % 16 == 0);
+        AssetBundle::View rotate = bundle.find("rotate.wav");
+        CHECK(rotate && rotate.size == 11 && std::memcmp(rotate.data, "RIFF-rotate", 11) == 0);
+        CHECK(bundle.find("empty.txt").size == 0);
+        CHECK(!bundle.find("drop.wav"));
+    }
+
+    // a missing file and a truncated bundle fail to open
+    AssetBundle bundle;
+    CHECK(!bundle.open("does_not_exist.pak"));
+    fs::resize_file(pak, 40);
+    CHECK(!bundle.open(pak));
+    CHECK(!bundle.isOpen());
+    writeFile(pak, "not a bundle");
+    CHECK(!bundle.open(pak));
+
+    fs::remove(pak);
+    fs::remove_all(dir);
+    std::printf("asset bundle ok\n");
+    return 0;
+}
@@ -0,0 +1,46 @@
+// DAS/ARR pulses on the fixed logic clock do not depend on the step size.
+#include "tetris/AutoRepeat.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static int pulsesAfter(RepeatTiming timing, std::uint32_t step, std::uint32_t total) {
+    AutoRepeat r(timing);
+    r.press();
+    int pulses = 0;
+    for (std::uint32_t t = 0; t < total; t += step) pulses += r.advance(step);
+    return pulses;
+}
+
+int main() {
+    RepeatTiming timing{100000, 20000};
+
+    // nothing before the delay, then one pulse per interval
+    CHECK(pulsesAfter(timing, 1000, 99000) == 0);
+    CHECK(pulsesAfter(timing, 1000, 100000) == 1);
+    CHECK(pulsesAfter(timing, 1000, 200000) == 6);
+
+    // the same held time gives the same pulse count at any logic rate
+    CHECK(pulsesAfter(timing, 4000, 200000) == 6);
+    CHECK(pulsesAfter(timing, 50000, 200000) == 6);
+
+    // releasing stops and re-pressing restarts the delay
+    AutoRepeat r(timing);
+    r.press();
+    CHECK(r.advance(150000) == 3);
+    r.release();
+    CHECK(!r.held());
+    CHECK(r.advance(150000) == 0);
+    r.press();
+    CHECK(r.advance(90000) == 0);
+    CHECK(r.advance(10000) == 1);
+
+    // zero interval moves all the way once the delay is over
+    CHECK(pulsesAfter(RepeatTiming{100000, 0}, 4000, 120000) >= AutoRepeat::Instant);
+
+    std::printf("auto repeat ok\n");
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Batch features match a cell-by-cell reference, and every SIMD level gives
+// bit-identical features and scores to the scalar kernel.
+#include "tetris/BatchEvaluator.hpp"
+#include "tetris/Bot.hpp"
+#include "tetris/Engine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+// The features computed the slow way, straight from their definitions.
+static std::array<int, FeatureCount> reference(const Board &board, int lines) {
+    auto filled = [&](int x, int y) { return x < 0 || x >= BoardWidth || board.isOccupied(Point{x, y}); };
+    int heights[BoardWidth];
+    std::array<int, FeatureCount> f{};
+    for (int x = 0; x < BoardWidth; ++x) {
+        heights[x] = 0;
+        for (int y = 0; y < BoardHeight && !heights[x]; ++y)
+            if (filled(x, y)) heights[x] = BoardHeight - y;
+        f[AggregateHeight] += heights[x];
+        f[MaxHeight] = heights[x] > f[MaxHeight] ? heights[x] : f[MaxHeight];
+        if (x > 0) f[Bumpiness] += std::abs(heights[x] - heights[x - 1]);
+        for (int y = BoardHeight - heights[x]; y < BoardHeight; ++y) f[Holes] += !filled(x, y);
+        for (int y = 0; y < BoardHeight - heights[x]; ++y) f[WellDepth] += filled(x - 1, y) && filled(x + 1, y);
+    }
+    for (int y = 0; y < BoardHeight; ++y)
+        for (int x = -1; x < BoardWidth; ++x) f[RowTransitions] += filled(x, y) != filled(x + 1, y);
+    f[CompleteLines] = lines;
+    return f;
+}
+
+int main() {
+    // Boards from random play at every stack height, plus a few by hand
+    std::vector<Board> boards;
+    std::vector<int> lines;
+    Engine engine(3);
+    unsigned state = 17;
+    while (boards.size() < 3000) {
+        state = state * 1103515245u + 12345u;
+        engine.step(static_cast<Action>(1 + (state >> 16) % 5));
+        engine.tick(1.0f / 30.0f);
+        if ((state >> 8) % 5 == 0) {
+            boards.push_back(engine.board());
+            lines.push_back(static_cast<int>((state >> 4) % 5));
+        }
+        if (!engine.running()) engine.reset(state);
+    }
+    Board well;
+    for (int y = BoardHeight - 4; y < BoardHeight; ++y)
+        for (int x = 0; x < BoardWidth - 1; ++x) well.setCell(x, y, 0);
+    Board full;
+    for (int y = 0; y < BoardHeight; ++y)
+        for (int x = 0; x < BoardWidth; ++x) full.setCell(x, y, 1);
+    boards.insert(boards.begin(), {Board(), well, full});
+    lines.insert(lines.begin(), {0, 4, 0});
+
+    auto empty = reference(Board(), 0);
+    CHECK(empty[AggregateHeight] == 0 && empty[RowTransitions] == 2 * BoardHeight && empty[WellDepth] == 0);
+    auto deep = reference(well, 4);
+    CHECK(deep[WellDepth] == 4 && deep[Bumpiness] == 4 && deep[MaxHeight] == 4 && deep[CompleteLines] == 4);
+
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2})
+        if (simdLevelSupported(level)) levels.push_back(level);
+    CHECK(BatchEvaluator().level() == bestSimdLevel());
+    CHECK(BatchEvaluator({}, SimdLevel::Scalar).level() == SimdLevel::Scalar);
+
+    EvalWeights weights;
+    weights.w = {-0.51f, -0.2f, -0.36f, -0.18f, -0.05f, -0.11f, 0.76f};
+    auto batch = std::make_unique<BoardBatch>();
+    auto expected = std::make_unique<BatchResult>();
+    auto actual = std::make_unique<BatchResult>();
+    const BotWeights bot;
+    const EvalWeights botLike; // the defaults mirror BotWeights
+    std::size_t next = 0;
+    int batches = 0;
+    while (next < boards.size()) {
+        // Full batches and ragged ones that end mid-register
+        std::size_t take = batches % 3 == 2 ? 37 : BoardBatch::Capacity;
+        batch->clear();
+        for (std::size_t i = next; i < boards.size() && i < next + take; ++i) CHECK(batch->add(boards[i], lines[i]));
+        if (batch->full()) CHECK(!batch->add(Board(), 0));
+
+        BatchEvaluator(weights, SimdLevel::Scalar).evaluate(*batch, *expected);
+        CHECK(expected->count == batch->size());
+        for (int i = 0; i < batch->size(); ++i) {
+            auto ref = reference(boards[next + i], lines[next + i]);
+            for (int f = 0; f < FeatureCount; ++f) CHECK(expected->feature(i, f) == ref[f]);
+        }
+        for (SimdLevel level : levels) {
+            BatchEvaluator evaluator(weights, level);
+            CHECK(evaluator.level() == level);
+            // poison the output so stale values cannot pass
+            for (auto &row : actual->features) std::fill(row.begin(), row.end(), static_cast<std::int16_t>(-21846));
+            std::fill(actual->scores.begin(), actual->scores.end(), -1e30f);
+            actual->count = -1;
+            evaluator.evaluate(*batch, *actual);
+            CHECK(actual->count == batch->size());
+            for (int i = 0; i < batch->size(); ++i) {
+                for (int f = 0; f < FeatureCount; ++f) CHECK(actual->feature(i, f) == expected->feature(i, f));
+                CHECK(std::memcmp(&actual->scores[i], &expected->scores[i], sizeof(float)) == 0);
+            }
+        }
+
+        // With the bot's weights the score is Bot::evaluate up to float rounding
+        BatchEvaluator(botLike).evaluate(*batch, *actual);
+        for (int i = 0; i < batch->size(); ++i) {
+            double value = Bot::evaluate(boards[next + i], lines[next + i], bot);
+            CHECK(std::fabs(actual->score(i) - value) < 1e-3 * (1.0 + std::fabs(value)));
+        }
+        next += static_cast<std::size_t>(batch->size());
+        ++batches;
+    }
+    std::printf("%zu boards in %d batches, levels:", boards.size(), batches);
+    for (SimdLevel level : levels) std::printf(" %s", simdLevelName(level));
+    std::printf("\nbatch evaluator tests passed\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Every compiled board size runs the same rules: line clears, garbage,
+// hashing, column heights, drop distances and full games, reached through the
+// runtime size bridge.
+#include "tetris/Engine.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static_assert(sizeof(BasicBoard<4, 20>::Row) == 1, "sprint rows fit a byte");
+static_assert(sizeof(BasicBoard<10, 20>::Row) == 2, "standard rows fit 16 bits");
+static_assert(sizeof(BasicBoard<64, 20>::Row) == 8, "widest rows use 64 bits");
+static_assert(BasicBoard<64, 20>::FullRow == ~std::uint64_t{0}, "64 wide full row");
+
+template <int W, int H>
+static std::uint64_t hashFromScratch(const BasicBoard<W, H> &board) {
+    std::uint64_t h = 0;
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            if ((board.row(y) >> x) & 1u) h ^= zobristCells<W, H>[y][x];
+    return h;
+}
+
+// Column heights and row fills recounted cell by cell.
+template <int W, int H>
+static bool summariesMatch(const BasicBoard<W, H> &board) {
+    for (int y = 0; y < H; ++y) {
+        int fill = 0;
+        for (int x = 0; x < W; ++x) fill += (board.row(y) >> x) & 1u;
+        if (board.rowFill(y) != fill) return false;
+    }
+    for (int x = 0; x < W; ++x) {
+        int height = 0;
+        for (int y = H - 1; y >= 0; --y)
+            if ((board.row(y) >> x) & 1u) height = H - y;
+        if (board.columnHeight(x) != height) return false;
+    }
+    return true;
+}
+
+// Drop distances of every placement of every piece from the top row, each
+// checked against moving down one row at a time.
+template <int W, int H>
+static void checkDrops(const BasicBoard<W, H> &board) {
+    for (int t = 0; t < PieceCount; ++t)
+        for (int r = 0; r < RotationCount; ++r) {
+            const ShapeInfo &shape = Tetromino::shape(static_cast<TetrominoType>(t), r);
+            for (int x = -shape.minX; x + shape.maxX < W; ++x)
+                for (int y = -1 - shape.minY; y + shape.maxY < H; ++y) {
+                    Point pos{x, y};
+                    if (!board.isValidPosition(shape, pos)) continue;
+                    int slow = 0;
+                    while (board.isValidPosition(shape, Point{x, y + slow + 1})) ++slow;
+                    CHECK(board.dropDistance(shape, pos) == slow);
+                }
+        }
+}
+
+template <int W, int H>
+static void checkSize(BoardSize<W, H>) {
+    using BoardT = BasicBoard<W, H>;
+
+    // fill the bottom row and one row higher up, leaving a gap in between
+    BoardT board;
+    for (int x = 0; x < W; ++x) {
+        board.setCell(x, H - 1, 0);
+        board.setCell(x, H - 3, 1);
+    }
+    board.setCell(0, H - 2, 2);
+    CHECK(board.columnHeight(0) == 3 && board.columnHeight(1) == 3 && board.rowFill(H - 2) == 1);
+    typename BoardT::Lines full = board.getFullLines();
+    CHECK(full.size() == 2 && full[0] == H - 3 && full[1] == H - 1);
+    CHECK(board.getFullLines(H - 3, H - 2).size() == 1 && board.getFullLines(-5, H + 5).size() == 2);
+    board.removeLines(full);
+    CHECK(board.row(H - 1) == 1 && board.at(0, H - 1).color == 2);
+    for (int y = 0; y < H - 1; ++y) CHECK(board.row(y) == 0);
+    CHECK(board.hash() == hashFromScratch(board));
+    CHECK(summariesMatch(board) && board.columnHeight(0) == 1 && board.columnHeight(1) == 0);
+    board.setCell(0, H - 1, -1);
+    CHECK(summariesMatch(board) && board.columnHeight(0) == 0);
+
+    // an overhang: pieces above it rest on it, pieces tucked below fall past
+    board.setCell(1, H - 4, 0);
+    board.setCell(1, H - 1, 0);
+    CHECK(summariesMatch(board));
+    checkDrops(board);
+
+    // shapes cannot leave the board on any side
+    const ShapeInfo &i = Tetromino::shape(TetrominoType::I, 0);
+    CHECK(board.isValidPosition(i, Point{W - 4, 0}));
+    CHECK(!board.isValidPosition(i, Point{W - 3, 0}));
+    CHECK(!board.isValidPosition(i, Point{-1, 0}));
+    CHECK(!board.isValidPosition(i, Point{0, H - 1}));
+
+    // garbage rises under the stack with one gap; pushing cells out fails
+    const typename BoardT::Row below = board.row(H - 1);
+    CHECK(board.addGarbage(2, W - 1, GarbageColor));
+    CHECK(board.row(H - 3) == below && board.row(H - 1) == (BoardT::FullRow >> 1) && board.row(H - 2) == board.row(H - 1));
+    CHECK(board.at(0, H - 1).color == GarbageColor && board.at(W - 1, H - 1).color == -1);
+    CHECK(board.hash() == hashFromScratch(board) && summariesMatch(board));
+    CHECK(board.getFullLines().empty());
+    CHECK(!board.addGarbage(H - 3, 0, GarbageColor));
+    CHECK(board.row(0) == below && board.row(H - 1) == static_cast<typename BoardT::Row>(BoardT::FullRow & ~typename BoardT::Row{1}));
+    CHECK(board.hash() == hashFromScratch(board) && summariesMatch(board));
+
+    // random games keep the incremental hash exact
+    std::mt19937 rng(W * 100 + H);
+    BasicEngine<W, H> engine(static_cast<std::uint32_t>(W * H));
+    int games = 0;
+    int pieces = 0;
+    for (int step = 0; step < 20000 && games < 3; ++step) {
+        engine.step(static_cast<Action>(1 + rng() % 4));
+        if (rng() % 8 == 0) engine.step(Action::HardDrop);
+        engine.tick(0.05f);
+        CHECK(engine.board().hash() == hashFromScratch(engine.board()));
+        CHECK(summariesMatch(engine.board()));
+        if (step % 500 == 0) checkDrops(engine.board());
+        if (!engine.running()) {
+            CHECK(engine.piecesPlaced() > 0);
+            pieces += engine.piecesPlaced();
+            engine.reset(static_cast<std::uint32_t>(step));
+            ++games;
+        }
+    }
+    CHECK(games == 3);
+    std::printf("%dx%d: %d games, %d pieces\n", W, H, games, pieces);
+}
+
+int main() {
+    int sizes = 0;
+#define CHECK_SIZE(W, H) CHECK(withBoardSize(W, H, [](auto size) { checkSize(size); })); ++sizes;
+    TETRIS_BOARD_SIZES(CHECK_SIZE)
+#undef CHECK_SIZE
+    CHECK(sizes >= 6);
+    CHECK(!withBoardSize(7, 13, [](auto) {}));
+    std::printf("board sizes ok\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Thread pool and autoplay bot: every task runs, and the bot survives and clears lines.
+#include "tetris/Bot.hpp"
+#include "tetris/Engine.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+int main() {
+    ThreadPool pool(4);
+
+    // Tasks that spawn more tasks exercise the per-worker deques and stealing
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 64; ++i)
+        pool.submit([&pool, &ran] {
+            for (int j = 0; j < 16; ++j) pool.submit([&ran] { ran.fetch_add(1); });
+            ran.fetch_add(1);
+        });
+    auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (ran.load() < 64 * 17 && std::chrono::steady_clock::now() < giveUp) std::this_thread::yield();
+    CHECK(ran.load() == 64 * 17);
+
+    // A full two-ply search per piece keeps the board alive
+    Bot bot(pool);
+    Engine engine(2024);
+    auto gen = std::make_unique<MoveGenerator>();
+    auto scratch = std::make_unique<PlacementList>();
+    for (int piece = 0; piece < 300 && engine.running(); ++piece) {
+        bot.start(engine.board(), engine.active(), engine.next());
+        Placement target;
+        CHECK(bot.think(std::chrono::steady_clock::now() + std::chrono::seconds(5), target));
+        CHECK(bot.done());
+        ActionPath path;
+        gen->generate(engine.board(), engine.active(), *scratch);
+        CHECK(gen->pathTo(target, path));
+        for (int i = 0; i < path.count; ++i) engine.step(path.actions[i]);
+        while (engine.animating()) engine.tick(Engine::LineClearDuration);
+    }
+    std::printf("bot: %d pieces, %d lines, score %d\n", engine.piecesPlaced(), engine.lines(), engine.score());
+    CHECK(engine.running());
+    CHECK(engine.lines() > 50);
+
+    // An expired deadline still yields the quick one-ply answer
+    bot.start(engine.board(), engine.active(), engine.next());
+    Placement quick;
+    CHECK(bot.think(std::chrono::steady_clock::now(), quick));
+
+    // While two-ply results come in, best() keeps the one-ply choice, and
+    // switches to the two-ply choice only once the search is complete.
+    // Checked over the positions of a game; how far the search is when the
+    // polls land depends on scheduling.
+    {
+        ThreadPool single(1);
+        Bot slow(single), full(pool);
+        auto same = [](const Placement &a, const Placement &b) {
+            return a.type == b.type && a.rotation == b.rotation && a.position == b.position;
+        };
+        Engine game(77);
+        for (int piece = 0; piece < 40 && game.running(); ++piece) {
+            // hold the only worker so the search cannot start before the first poll
+            std::atomic<bool> hold{true}, held{false};
+            single.submit([&] {
+                held = true;
+                while (hold.load()) std::this_thread::yield();
+            });
+            while (!held.load()) std::this_thread::yield();
+            slow.start(game.board(), game.active(), game.next());
+
+            gen->generate(game.board(), game.active(), *scratch);
+            int quickIndex = -1;
+            double quickScore = 0.0;
+            for (int i = 0; i < scratch->size(); ++i) {
+                Board child = game.board();
+                const Placement &p = (*scratch)[i];
+                child.place(Tetromino::shape(p.type, p.rotation).blocks, p.position, 0);
+                auto lines = child.getFullLines();
+                child.removeLines(lines);
+                double score = Bot::evaluate(child, static_cast<int>(lines.size()), BotWeights{});
+                if (quickIndex < 0 || score > quickScore) {
+                    quickIndex = i;
+                    quickScore = score;
+                }
+            }
+            const Placement expected = (*scratch)[quickIndex];
+            Placement seen;
+            CHECK(slow.best(seen) && same(seen, expected));
+            hold = false;
+            // the last result may land between best() and done()
+            bool switched = false;
+            Placement deep{};
+            while (!slow.done()) {
+                CHECK(slow.best(seen));
+                if (same(seen, expected)) continue;
+                CHECK(!switched || same(seen, deep));
+                switched = true;
+                deep = seen;
+            }
+            Placement searched;
+            CHECK(slow.think(std::chrono::steady_clock::now() + std::chrono::seconds(5), searched));
+            CHECK(!switched || same(deep, searched));
+            full.start(game.board(), game.active(), game.next());
+            CHECK(full.think(std::chrono::steady_clock::now() + std::chrono::seconds(5), seen) && same(seen, searched));
+
+            ActionPath path;
+            CHECK(gen->pathTo(searched, path));
+            for (int i = 0; i < path.count; ++i) game.step(path.actions[i]);
+            while (game.animating()) game.tick(Engine::LineClearDuration);
+        }
+    }
+
+    std::printf("bot tests passed\n");
+    return 0;
+}
@@ -1,2 +0,0 @@
-#include <iostream>
-int main(){ std::cout<<"dummy test"<<std::endl; return 0; }
@@ -0,0 +1,64 @@
+// Headless checks for the rules engine: determinism and basic scoring.
+#include "tetris/Engine.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static void playScripted(Engine &engine, int steps) {
+    // Cheap pseudo-random script so both runs see identical inputs
+    unsigned state = 7;
+    for (int i = 0; i < steps && engine.running(); ++i) {
+        state = state * 1103515245u + 12345u;
+        engine.step(static_cast<Action>((state >> 16) % static_cast<unsigned>(Action::Count)));
+        engine.tick(1.0f / 60.0f);
+    }
+}
+
+static bool sameState(const Engine &a, const Engine &b) {
+    if (a.score() != b.score() || a.lines() != b.lines() || a.level() != b.level()) return false;
+    if (a.piecesPlaced() != b.piecesPlaced() || a.running() != b.running() || a.next() != b.next()) return false;
+    for (int y = 0; y < BoardHeight; ++y) {
+        if (a.board().row(y) != b.board().row(y)) return false;
+        for (int x = 0; x < BoardWidth; ++x)
+            if (a.board().at(x, y).color != b.board().at(x, y).color) return false;
+    }
+    return true;
+}
+
+int main() {
+    // Same seed and inputs give the same game
+    Engine a(42), b(42);
+    playScripted(a, 20000);
+    playScripted(b, 20000);
+    CHECK(a.piecesPlaced() > 0);
+    CHECK(sameState(a, b));
+
+    // reset() starts over from scratch
+    a.reset(42);
+    Engine fresh(42);
+    CHECK(sameState(a, fresh));
+
+    // A hard drop locks the piece and spawns the next one
+    Engine e(1);
+    TetrominoType next = e.next();
+    Events ev = e.step(Action::HardDrop);
+    CHECK(ev & events::HardDropped);
+    CHECK(ev & events::Locked);
+    CHECK(e.piecesPlaced() == 1);
+    CHECK(e.active().type == next);
+
+    // Gravity moves the piece after one drop interval
+    Point before = e.active().position;
+    e.tick(e.dropInterval());
+    CHECK(e.active().position.y == before.y + 1);
+
+    CHECK(Engine::scoreForLines(4, 0) == 800);
+    CHECK(Engine::scoreForLines(2, 3) == 1200);
+    CHECK(Engine::dropIntervalForLevel(100) == 0.05f);
+
+    std::printf("engine tests passed\n");
+    return 0;
+}
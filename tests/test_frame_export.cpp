@@ -0,0 +1,138 @@
+// Replay export helpers: Y4M frame conversion of known colors and sizes,
+// and the encoder pipeline writing frames in order with bounded memory.
+#include "tetris/FrameExport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+namespace {
+
+std::vector<std::uint8_t> solid(unsigned width, unsigned height, std::uint8_t r, std::uint8_t g, std::uint8_t b) {
+    std::vector<std::uint8_t> rgba(std::size_t(width) * height * 4);
+    for (std::size_t i = 0; i < rgba.size(); i += 4) {
+        rgba[i] = r;
+        rgba[i + 1] = g;
+        rgba[i + 2] = b;
+        rgba[i + 3] = 255;
+    }
+    return rgba;
+}
+
+// Y, U and V of every pixel of a solid frame.
+bool solidYuv(const std::vector<std::uint8_t> &out, unsigned width, unsigned height, int y, int u, int v) {
+    const std::size_t luma = std::size_t(width) * height, chroma = std::size_t((width + 1) / 2) * ((height + 1) / 2);
+    if (out.size() != 6 + luma + 2 * chroma || std::memcmp(out.data(), "FRAME\n", 6) != 0) return false;
+    for (std::size_t i = 0; i < luma; ++i) if (out[6 + i] != y) return false;
+    for (std::size_t i = 0; i < chroma; ++i) if (out[6 + luma + i] != u || out[6 + luma + chroma + i] != v) return false;
+    return true;
+}
+
+} // namespace
+
+int main() {
+    // BT.601 studio range: black 16, white 235, neutral chroma 128
+    {
+        std::vector<std::uint8_t> out;
+        convertToYuv(solid(4, 2, 0, 0, 0).data(), 4, 2, out);
+        CHECK(solidYuv(out, 4, 2, 16, 128, 128));
+        convertToYuv(solid(4, 2, 255, 255, 255).data(), 4, 2, out);
+        CHECK(solidYuv(out, 4, 2, 235, 128, 128));
+        convertToYuv(solid(2, 2, 255, 0, 0).data(), 2, 2, out);
+        CHECK(solidYuv(out, 2, 2, 82, 90, 240));
+        convertToYuv(solid(2, 2, 0, 0, 255).data(), 2, 2, out);
+        CHECK(solidYuv(out, 2, 2, 41, 240, 110));
+        // odd sizes round the chroma planes up
+        convertToYuv(solid(5, 3, 0, 255, 0).data(), 5, 3, out);
+        CHECK(solidYuv(out, 5, 3, 144, 54, 34));
+    }
+
+    // Chroma averages 2x2 blocks, repeating the last column of odd widths
+    {
+        const unsigned width = 3, height = 2;
+        std::vector<std::uint8_t> rgba = solid(width, height, 0, 0, 0);
+        for (unsigned y = 0; y < height; ++y) {
+            rgba[(y * width + 0) * 4 + 2] = 255; // blue in column 0
+            rgba[(y * width + 2) * 4 + 0] = 255; // red in column 2
+        }
+        std::vector<std::uint8_t> out;
+        convertToYuv(rgba.data(), width, height, out);
+        CHECK(out.size() == 6 + 6 + 2 * 2);
+        const std::uint8_t *luma = out.data() + 6, *u = luma + 6, *v = u + 2;
+        CHECK(luma[0] == 41 && luma[1] == 16 && luma[2] == 82 && luma[3] == 41 && luma[5] == 82);
+        // half blue, half black; then red counted twice
+        CHECK(u[0] == 184 && v[0] == 119);
+        CHECK(u[1] == 90 && v[1] == 240);
+    }
+
+    // Frames finish encoding out of order but are written in order, with at
+    // most maxInFlight at a time and their buffers reused
+    {
+        ThreadPool pool(4);
+        const std::size_t maxInFlight = 5;
+        const int count = 200;
+        std::vector<std::uint64_t> written;
+        std::set<const ExportFrame*> buffers;
+        std::atomic<int> encoding{0}, peak{0};
+        {
+            FramePipeline pipeline(pool, maxInFlight,
+                [&](ExportFrame &frame) {
+                    int now = ++encoding;
+                    for (int p = peak.load(); now > p && !peak.compare_exchange_weak(p, now);) {}
+                    // later frames of each group of three finish first
+                    std::this_thread::sleep_for(std::chrono::microseconds(300 * (2 - frame.index % 3)));
+                    frame.encoded.assign(1, static_cast<std::uint8_t>(frame.rgba[0] + 1));
+                    --encoding;
+                    return frame.index != 57;
+                },
+                [&](ExportFrame &frame) {
+                    CHECK(frame.encoded.size() == 1 && frame.encoded[0] == static_cast<std::uint8_t>(frame.index + 1));
+                    written.push_back(frame.index);
+                    return frame.index != 90;
+                });
+            for (int i = 0; i < count; ++i) {
+                std::unique_ptr<ExportFrame> frame = pipeline.next();
+                CHECK(frame->index == static_cast<std::uint64_t>(i) && frame->ok);
+                buffers.insert(frame.get());
+                frame->rgba.assign(1, static_cast<std::uint8_t>(i));
+                frame->ok = i != 120; // a failed readback is not encoded or written
+                pipeline.submit(std::move(frame));
+                CHECK(pipeline.inFlight() <= maxInFlight);
+            }
+            pipeline.finish();
+            CHECK(pipeline.inFlight() == 0 && pipeline.frames() == static_cast<std::uint64_t>(count));
+            CHECK(pipeline.failed() && pipeline.firstFailure() == 57);
+        }
+        CHECK(written.size() == static_cast<std::size_t>(count - 2));
+        for (std::size_t i = 1; i < written.size(); ++i) CHECK(written[i] > written[i - 1]);
+        for (std::uint64_t skipped : {57, 120}) CHECK(std::find(written.begin(), written.end(), skipped) == written.end());
+        CHECK(peak.load() > 1 && peak.load() <= static_cast<int>(maxInFlight));
+        CHECK(buffers.size() <= maxInFlight + 1);
+    }
+
+    // Dropping a pipeline waits for frames still encoding
+    {
+        ThreadPool pool(2);
+        std::atomic<int> encoded{0};
+        {
+            FramePipeline pipeline(pool, 8, [&](ExportFrame&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                ++encoded;
+                return true;
+            }, [](ExportFrame&) { return true; });
+            for (int i = 0; i < 4; ++i) pipeline.submit(pipeline.next());
+        }
+        CHECK(encoded.load() == 4);
+    }
+    std::printf("frame export tests passed\n");
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Move generator: placement counts on known boards and replayable input paths.
+#include "tetris/MoveGen.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static int countPlacements(MoveGenerator &gen, const Board &board, TetrominoType type) {
+    PlacementList list;
+    gen.generate(board, Tetromino{type, 0, SpawnPosition}, list);
+    return list.size();
+}
+
+// Replay a path through the same rules the engine uses and check where it locks.
+static bool pathLandsOn(const Board &board, TetrominoType type, const ActionPath &path, const Placement &target) {
+    Tetromino piece{type, 0, SpawnPosition};
+    for (int i = 0; i < path.count; ++i) {
+        Point pos = piece.position;
+        int rot = piece.rotation;
+        switch (path.actions[i]) {
+        case Action::Left: pos.x -= 1; break;
+        case Action::Right: pos.x += 1; break;
+        case Action::SoftDrop: pos.y += 1; break;
+        case Action::Rotate: rot = (rot + 1) & 3; break;
+        case Action::HardDrop:
+            while (board.isValidPosition(Tetromino::shape(type, rot), pos + Point{0,1})) pos.y += 1;
+            break;
+        default: break;
+        }
+        if (!board.isValidPosition(Tetromino::shape(type, rot), pos)) return false;
+        piece.position = pos;
+        piece.rotation = rot;
+    }
+    return piece.rotation == target.rotation && piece.position == target.position;
+}
+
+int main() {
+    auto gen = std::make_unique<MoveGenerator>();
+    Board empty;
+
+    // Distinct lock positions on an empty 10-wide board
+    CHECK(countPlacements(*gen, empty, TetrominoType::O) == 9);
+    CHECK(countPlacements(*gen, empty, TetrominoType::I) == 17);
+    CHECK(countPlacements(*gen, empty, TetrominoType::S) == 17);
+    CHECK(countPlacements(*gen, empty, TetrominoType::Z) == 17);
+    CHECK(countPlacements(*gen, empty, TetrominoType::T) == 34);
+    CHECK(countPlacements(*gen, empty, TetrominoType::J) == 34);
+    CHECK(countPlacements(*gen, empty, TetrominoType::L) == 34);
+
+    // An overhang at x=0..2 on row 17 leaves a slot underneath that only a
+    // tuck (drop, then shift left) can reach.
+    Board overhang;
+    for (int x = 0; x < 3; ++x) overhang.setCell(x, 17, 0);
+    PlacementList list;
+    gen->generate(overhang, Tetromino{TetrominoType::O, 0, SpawnPosition}, list);
+    bool tucked = false;
+    for (const Placement &p : list) {
+        const ShapeInfo &s = Tetromino::shape(p.type, p.rotation);
+        if (p.position.x + s.minX == 0 && p.position.y + s.maxY == BoardHeight - 1) tucked = true;
+        ActionPath path;
+        CHECK(gen->pathTo(p, path));
+        CHECK(pathLandsOn(overhang, p.type, path, p));
+    }
+    CHECK(tucked);
+
+    // perft: depth 1 equals the placement count
+    const TetrominoType queue[] = { TetrominoType::O, TetrominoType::O };
+    CHECK(perft(empty, queue, 2, 1) == 9);
+    // a second O can always land on top of the first
+    CHECK(perft(empty, queue, 2, 2) == 81);
+
+    std::printf("movegen tests passed\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Piece streams are reproducible by (seed, stream), independent across
+// streams and splits, and follow the rules of their randomizer.
+#include "tetris/Engine.hpp"
+#include "tetris/PieceGenerator.hpp"
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static bool sameSequence(PieceGenerator a, PieceGenerator b, int n) {
+    for (int i = 0; i < n; ++i)
+        if (a.next() != b.next()) return false;
+    return true;
+}
+
+int main() {
+    // Every aligned group of seven in bag mode holds each piece once
+    PieceGenerator bag(42);
+    for (int group = 0; group < 1000; ++group) {
+        int seen = 0;
+        for (int i = 0; i < 7; ++i) seen |= 1 << static_cast<int>(bag.next());
+        CHECK(seen == 0x7F);
+    }
+
+    // Same seed and stream give the same pieces; stream 999999 of a batch
+    // needs nothing from the streams before it
+    for (Randomizer mode : {Randomizer::Bag7, Randomizer::Uniform, Randomizer::History}) {
+        CHECK(sameSequence(PieceGenerator(7, 999999, mode), PieceGenerator(7, 999999, mode), 500));
+        CHECK(!sameSequence(PieceGenerator(7, 999999, mode), PieceGenerator(7, 999998, mode), 50));
+        CHECK(!sameSequence(PieceGenerator(7, 0, mode), PieceGenerator(8, 0, mode), 50));
+    }
+
+    // Splits are reproducible and differ from the parent and each other
+    PieceGenerator parent(3, 5);
+    CHECK(sameSequence(parent.split(1), parent.split(1), 200));
+    CHECK(!sameSequence(parent.split(1), parent.split(2), 50));
+    CHECK(!sameSequence(parent.split(0), parent, 50));
+    // and a child's own seed and stream rebuild it
+    PieceGenerator child = parent.split(4), grandchild = child.split(2);
+    CHECK(child.stream() == 4 && child.seed() != parent.seed());
+    CHECK(sameSequence(child, PieceGenerator(child.seed(), child.stream()), 200));
+    CHECK(sameSequence(grandchild, PieceGenerator(grandchild.seed(), grandchild.stream()), 200));
+    CHECK(parent.split(4).seed() != PieceGenerator(3, 6).split(4).seed());
+
+    // Peeking matches what next() later returns and does not advance
+    for (Randomizer mode : {Randomizer::Bag7, Randomizer::Uniform, Randomizer::History}) {
+        PieceGenerator gen(11, 2, mode);
+        for (int round = 0; round < 50; ++round) {
+            std::array<TetrominoType, 12> queue;
+            gen.peek(queue.data(), 12);
+            CHECK(gen.peek(5) == queue[5]);
+            for (int i = 0; i < 12; ++i) CHECK(gen.next() == queue[i]);
+        }
+        CHECK(gen.dealt() == 600);
+    }
+
+    // Uniform: every piece shows up about 1/7 of the time
+    PieceGenerator uniform(1, 0, Randomizer::Uniform);
+    int counts[PieceCount] = {};
+    const int draws = 700000;
+    for (int i = 0; i < draws; ++i) ++counts[static_cast<int>(uniform.next())];
+    for (int c : counts) CHECK(c > 99000 && c < 101000);
+
+    // History: the first piece is never S, Z or O, and repeats within four
+    // pieces are rarer than uniform (1 - (6/7)^4 = 46%)
+    int repeats = 0;
+    for (std::uint64_t stream = 0; stream < 2000; ++stream) {
+        PieceGenerator tgm(9, stream, Randomizer::History);
+        TetrominoType first = tgm.next();
+        CHECK(first != TetrominoType::S && first != TetrominoType::Z && first != TetrominoType::O);
+        std::array<TetrominoType, 4> last{first, first, first, first};
+        for (int i = 1; i < 50; ++i) {
+            TetrominoType t = tgm.next();
+            if (i >= 4 && (t == last[0] || t == last[1] || t == last[2] || t == last[3])) ++repeats;
+            last = {t, last[0], last[1], last[2]};
+        }
+    }
+    CHECK(repeats < 2000 * 46 / 10);
+
+    // Parsing round-trips the names
+    Randomizer parsed;
+    CHECK(parseRandomizer("history", parsed) && parsed == Randomizer::History);
+    CHECK(!parseRandomizer("tgm", parsed));
+
+    // The engine deals from its generator: upcoming() is the preview queue
+    Engine engine(PieceGenerator(5, 77, Randomizer::History));
+    std::array<TetrominoType, 6> preview;
+    for (int i = 0; i < 6; ++i) preview[i] = engine.upcoming(i);
+    CHECK(preview[0] == engine.next());
+    for (int i = 0; i < 6 && engine.running(); ++i) {
+        engine.step(Action::HardDrop);
+        CHECK(engine.active().type == preview[i]);
+    }
+    // reset(seed) keeps the randomizer mode
+    engine.reset(5);
+    CHECK(engine.pieces().mode() == Randomizer::History);
+    std::printf("generator state %zu bytes, engine snapshot %zu bytes\n", sizeof(PieceGenerator), sizeof(Engine::Snapshot));
+
+    std::printf("piece generator tests passed\n");
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Zones recorded on several threads are collected intact while writers run
+// and exported as trace JSON.
+#include "tetris/Profiler.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static const char *const Names[] = {"alpha", "beta", "gamma"};
+
+int main() {
+    // nothing is recorded while disabled
+    {
+        profiler::Scope scope("disabled");
+    }
+    std::vector<profiler::Zone> zones;
+    profiler::collect(0, zones);
+    CHECK(zones.empty());
+
+    profiler::setEnabled(true);
+    profiler::setThreadName("main");
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; ++t) {
+        writers.emplace_back([t, &stop] {
+            // begin and end encode the thread so torn slots would be visible
+            for (std::uint64_t i = 1; i <= 2 * profiler::RingCapacity || !stop.load(std::memory_order_relaxed); ++i)
+                profiler::record(Names[t], i * 10 + t, i * 10 + t + 5);
+        });
+    }
+    for (int round = 0; round < 50; ++round) {
+        zones.clear();
+        profiler::collect(0, zones);
+        for (const profiler::Zone &z : zones) {
+            int t = static_cast<int>(z.begin % 10);
+            CHECK(t < 3 && z.name == Names[t]);
+            CHECK(z.end == z.begin + 5);
+        }
+    }
+    stop = true;
+    for (auto &w : writers) w.join();
+
+    // each writer keeps at most the ring capacity
+    zones.clear();
+    profiler::collect(0, zones);
+    CHECK(zones.size() == 3 * profiler::RingCapacity);
+
+    {
+        profiler::Scope scope("scoped");
+    }
+    profiler::ZoneTotal totals[8];
+    int n = profiler::summarize(0, totals, 8);
+    CHECK(n == 4);
+    for (int i = 0; i < n; ++i) {
+        if (std::strcmp(totals[i].name, "scoped") == 0) CHECK(totals[i].count == 1);
+        else CHECK(totals[i].count == profiler::RingCapacity && totals[i].nanos == 5 * profiler::RingCapacity);
+    }
+
+    const char *path = "test_profiler_trace.json";
+    CHECK(profiler::writeChromeTrace(path));
+    std::FILE *f = std::fopen(path, "rb");
+    CHECK(f);
+    char head[128] = {};
+    CHECK(std::fread(head, 1, sizeof(head) - 1, f) > 0);
+    std::fclose(f);
+    std::remove(path);
+    CHECK(std::strncmp(head, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 38) == 0);
+    CHECK(std::strstr(head, "thread_name") != nullptr);
+
+    std::printf("profiler ok\n");
+    return 0;
+}
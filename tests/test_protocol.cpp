@@ -0,0 +1,93 @@
+// Server messages round-trip through encode/decode, arrive in pieces and
+// reject malformed input.
+#include "tetris/Protocol.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace tetris;
+using namespace tetris::protocol;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+int main() {
+    std::uint8_t buf[MaxMessageSize];
+    Message msg;
+
+    Start start{0x0123456789ABCDEFull, 999999, Randomizer::History};
+    std::size_t n = encode(start, buf);
+    CHECK(decode(buf, n, msg) == static_cast<int>(n));
+    CHECK(msg.type == MsgType::Start && msg.start.seed == start.seed && msg.start.stream == 999999);
+    CHECK(msg.start.randomizer == Randomizer::History);
+
+    Input input{Action::Rotate, 65535};
+    n = encode(input, buf);
+    CHECK(decode(buf, n, msg) == static_cast<int>(n));
+    CHECK(msg.type == MsgType::Input && msg.input.action == Action::Rotate && msg.input.seq == 65535);
+
+    // A state describes the engine, with and without board rows
+    Engine engine(PieceGenerator(3, 1));
+    for (int i = 0; i < 6; ++i) {
+        engine.step(Action::Left);
+        engine.step(Action::HardDrop);
+    }
+    engine.step(Action::Rotate);
+    for (bool rows : {false, true}) {
+        State state;
+        describe(engine, rows, state);
+        state.tick = 123456;
+        state.events = events::Rotated;
+        state.ack = 42;
+        n = encode(state, buf);
+        CHECK(decode(buf, n, msg) == static_cast<int>(n));
+        const State &s = msg.state;
+        CHECK(msg.type == MsgType::State && s.tick == 123456 && s.events == events::Rotated && s.ack == 42);
+        CHECK(s.score == static_cast<std::uint32_t>(engine.score()) && s.level == engine.level());
+        CHECK(s.active.type == engine.active().type && s.active.rotation == engine.active().rotation);
+        CHECK(s.active.position == engine.active().position && s.next == engine.next());
+        CHECK(s.hasRows == rows);
+        if (rows)
+            for (int y = 0; y < BoardHeight; ++y) CHECK(s.rows[y] == engine.board().row(y));
+    }
+
+    GameOver over{98765, 321, 4000};
+    n = encode(over, buf);
+    CHECK(decode(buf, n, msg) == static_cast<int>(n));
+    CHECK(msg.type == MsgType::GameOver && msg.gameOver.score == 98765 && msg.gameOver.lines == 321 && msg.gameOver.pieces == 4000);
+
+    // A stream of messages split at every byte boundary decodes the same
+    std::vector<std::uint8_t> stream;
+    for (int i = 0; i < 10; ++i) {
+        n = encode(Input{Action::Left, static_cast<std::uint16_t>(i)}, buf);
+        stream.insert(stream.end(), buf, buf + n);
+    }
+    for (std::size_t cut = 0; cut < stream.size(); ++cut) {
+        std::size_t pos = 0;
+        int decoded = 0;
+        std::size_t available = cut;
+        for (int pass = 0; pass < 2; ++pass) {
+            int used;
+            while ((used = decode(stream.data() + pos, available - pos, msg)) > 0) {
+                CHECK(msg.input.seq == decoded);
+                ++decoded;
+                pos += static_cast<std::size_t>(used);
+            }
+            CHECK(used == 0);
+            available = stream.size();
+        }
+        CHECK(decoded == 10);
+    }
+
+    // Malformed messages are rejected
+    n = encode(Input{Action::Left, 1}, buf);
+    buf[2] = 0; // Action::None
+    CHECK(decode(buf, n, msg) < 0);
+    buf[1] = 200; // unknown type
+    CHECK(decode(buf, n, msg) < 0);
+    n = encode(start, buf);
+    buf[0] = 3; // payload shorter than a Start
+    CHECK(decode(buf, 5, msg) < 0);
+
+    std::printf("protocol tests passed\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+// A recorded session replays to the same final state; tampering is detected.
+#include "tetris/Replay.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+int main() {
+    // Record a session with varying frame times, a restart and game overs
+    std::uint32_t seed = 77;
+    Engine engine(seed);
+    ReplayWriter writer(seed);
+    unsigned state = 5;
+    for (int frame = 0; frame < 50000; ++frame) {
+        state = state * 1103515245u + 12345u;
+        if ((state >> 20) % 3 == 0) {
+            Action a = static_cast<Action>(1 + (state >> 8) % 5);
+            engine.step(a);
+            writer.action(a);
+        }
+        std::uint32_t micros = (state >> 12) % 7 == 0 ? 33333 : 16667;
+        engine.tick(replay::tickSeconds(micros));
+        writer.tick(micros);
+        if (!engine.running()) {
+            seed = state;
+            engine.reset(seed);
+            writer.reset(seed);
+        }
+    }
+    writer.finish(engine);
+    std::vector<std::uint8_t> bytes = writer.bytes();
+
+    ReplayResult r = playReplay(bytes.data(), bytes.size());
+    CHECK(r.valid);
+    CHECK(r.matches);
+    CHECK(r.ticks == 50000);
+    CHECK(r.score == engine.score() && r.pieces == engine.piecesPlaced());
+    std::printf("%zu bytes for %llu ticks and %llu actions\n", bytes.size(),
+                static_cast<unsigned long long>(r.ticks), static_cast<unsigned long long>(r.actions));
+
+    // A wrong recorded board hash is reported
+    std::vector<std::uint8_t> tampered = bytes;
+    tampered.back() ^= 1;
+    r = playReplay(tampered.data(), tampered.size());
+    CHECK(r.valid && !r.matches && r.score == r.expectedScore);
+
+    // A different seed (one varint byte after version and randomizer) changes the game
+    Engine single(9);
+    ReplayWriter shortWriter(9);
+    for (int i = 0; i < 600; ++i) {
+        single.step(Action::HardDrop);
+        shortWriter.action(Action::HardDrop);
+        single.tick(replay::tickSeconds(16667));
+        shortWriter.tick(16667);
+    }
+    shortWriter.finish(single);
+    tampered = shortWriter.bytes();
+    tampered[6] = 10;
+    r = playReplay(tampered.data(), tampered.size());
+    CHECK(r.valid && !r.matches);
+
+    // Version 1 files (mt19937 pieces) are rejected
+    tampered = bytes;
+    tampered[4] = 1;
+    r = playReplay(tampered.data(), tampered.size());
+    CHECK(!r.valid);
+
+    // A history-randomizer session replays with the same pieces
+    Engine tgm(PieceGenerator(21, 4, Randomizer::History));
+    ReplayWriter tgmWriter(21, 4, Randomizer::History);
+    for (int i = 0; i < 300; ++i) {
+        tgm.step(Action::HardDrop);
+        tgmWriter.action(Action::HardDrop);
+    }
+    tgmWriter.finish(tgm);
+    r = playReplay(tgmWriter.bytes().data(), tgmWriter.bytes().size());
+    CHECK(r.valid && r.matches);
+
+    // Truncated files are rejected
+    r = playReplay(bytes.data(), bytes.size() / 2);
+    CHECK(!r.valid);
+
+    std::printf("replay tests passed\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Restoring a snapshot and replaying the same inputs reproduces the game;
+// the ring keeps the newest entries and never reallocates.
+#include "tetris/Engine.hpp"
+#include "tetris/SnapshotRing.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+struct Input { Action action; float dt; };
+
+static bool sameState(const Engine &a, const Engine &b) {
+    return a.board().hash() == b.board().hash() && a.score() == b.score() && a.lines() == b.lines()
+        && a.level() == b.level() && a.piecesPlaced() == b.piecesPlaced() && a.next() == b.next()
+        && a.active().type == b.active().type && a.active().position == b.active().position
+        && a.active().rotation == b.active().rotation && a.running() == b.running() && a.animating() == b.animating();
+}
+
+int main() {
+    // random inputs, including line clear animations and game overs
+    std::vector<Input> inputs;
+    unsigned state = 9;
+    for (int i = 0; i < 30000; ++i) {
+        state = state * 1103515245u + 12345u;
+        inputs.push_back(Input{static_cast<Action>((state >> 16) % 6), (state >> 8) % 3 == 0 ? 0.1f : 0.016f});
+    }
+    auto apply = [](Engine &e, const Input &in) {
+        e.step(in.action);
+        e.tick(in.dt);
+        if (!e.running()) e.reset(e.piecesPlaced() * 7u + 1u);
+    };
+
+    // snapshot every 100 inputs, then jump back to each and re-run from there
+    Engine engine(5);
+    SnapshotRing<Engine::Snapshot> ring(64);
+    std::vector<std::size_t> taken;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        if (i % 100 == 0) {
+            engine.snapshot(ring.push());
+            taken.push_back(i);
+        }
+        apply(engine, inputs[i]);
+    }
+    CHECK(ring.size() == 64);
+    Engine reference = engine;
+    for (int k = 0; k < 64; ++k) {
+        std::size_t from = taken[taken.size() - 1 - k];
+        Engine rewound(0);
+        rewound.restore(ring.pop());
+        for (std::size_t i = from; i < inputs.size(); ++i) apply(rewound, inputs[i]);
+        CHECK(sameState(rewound, reference));
+    }
+    CHECK(ring.empty());
+
+    // a full ring drops the oldest entries
+    SnapshotRing<int> ints(3);
+    for (int i = 1; i <= 5; ++i) ints.push(i);
+    CHECK(ints.size() == 3 && ints.top() == 5);
+    CHECK(ints.pop() == 5 && ints.pop() == 4 && ints.pop() == 3 && ints.empty());
+    ints.push(7);
+    CHECK(ints.top() == 7 && ints.size() == 1);
+
+    // rewinding through thousands of snapshots
+    SnapshotRing<Engine::Snapshot> big(4096);
+    for (int i = 0; i < 4096; ++i) engine.snapshot(big.push());
+    auto start = std::chrono::steady_clock::now();
+    while (!big.empty()) engine.restore(big.pop());
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::printf("snapshot %zu bytes, 4096 kept = %.1f MB, %.3f us per restore\n",
+                sizeof(Engine::Snapshot), big.bytes() / 1048576.0, us / 4096);
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Decoding a state stream gives the live game tick for tick, seeks land on
+// the same state, and the reader never allocates.
+#include "tetris/AllocCounter.hpp"
+#include "tetris/Policy.hpp"
+#include "tetris/Replay.hpp"
+#include "tetris/StateStream.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+static bool sameBoard(const Board &a, const Board &b) {
+    if (a.hash() != b.hash()) return false;
+    for (int y = 0; y < BoardHeight; ++y) {
+        if (a.row(y) != b.row(y)) return false;
+        for (int x = 0; x < BoardWidth; ++x)
+            if (a.at(x, y).color != b.at(x, y).color) return false;
+    }
+    return true;
+}
+
+static bool sameState(const StreamState &s, const Engine &e) {
+    return sameBoard(s.board, e.board()) && s.active.type == e.active().type && s.active.rotation == e.active().rotation
+        && s.active.position == e.active().position && s.next == e.next() && s.score == e.score()
+        && s.lines == e.lines() && s.level == e.level() && s.running == e.running();
+}
+
+int main() {
+    // A greedy bot clears lines; some frames enter a whole path at once so
+    // several pieces lock between two ticks, others mash random keys.
+    const int Ticks = 30000;
+    Engine engine(11);
+    GreedyPolicy policy;
+    StateStreamWriter writer(300);
+    std::vector<Engine::Snapshot> expected;
+    expected.reserve(Ticks);
+    ActionPath path;
+    int pathPos = 0, games = 0, maxLines = 0;
+    unsigned state = 9;
+    for (int t = 0; t < Ticks; ++t) {
+        state = state * 1103515245u + 12345u;
+        if ((state >> 16) % 50 == 0) {
+            engine.step(static_cast<Action>(1 + (state >> 8) % 5));
+            pathPos = path.count;
+        } else if ((state >> 16) % 7 == 0) {
+            for (int burst = 0; burst < 3 && engine.running() && !engine.animating(); ++burst) {
+                policy.plan(engine, path);
+                for (int i = 0; i < path.count; ++i) engine.step(path.actions[i]);
+                engine.step(Action::HardDrop);
+            }
+            pathPos = path.count;
+        } else if (engine.running() && !engine.animating()) {
+            if (pathPos >= path.count) {
+                policy.plan(engine, path);
+                pathPos = 0;
+            }
+            if (pathPos < path.count) engine.step(path.actions[pathPos++]);
+            else engine.step(Action::HardDrop);
+        }
+        engine.tick(1.0f / 60.0f);
+        if (!engine.running() && (state >> 12) % 90 == 0) {
+            maxLines = engine.lines() > maxLines ? engine.lines() : maxLines;
+            engine.reset(state);
+            pathPos = path.count;
+            ++games;
+        }
+        writer.tick(engine);
+        expected.push_back(engine.snapshot());
+    }
+    writer.finish();
+    CHECK(games > 0);
+    CHECK(maxLines > 0 || engine.lines() > 0);
+
+    const std::vector<std::uint8_t> &bytes = writer.bytes();
+    StateStreamReader reader;
+    CHECK(reader.open(bytes.data(), bytes.size()));
+
+    Engine live;
+    auto matches = [&](std::uint32_t tick) {
+        live.restore(expected[tick]);
+        return reader.tick() == tick && sameState(reader.state(), live);
+    };
+
+    // Every tick decodes to the live state, without touching the heap
+    std::uint64_t before = allocationCount();
+    for (int t = 0; t < Ticks; ++t) {
+        CHECK(reader.next());
+        CHECK(matches(static_cast<std::uint32_t>(t)));
+    }
+    CHECK(!reader.next());
+    CHECK(reader.error() == nullptr);
+
+    // Seeks forwards, backwards and onto keyframes
+    unsigned s = 1;
+    for (int i = 0; i < 200; ++i) {
+        s = s * 1103515245u + 12345u;
+        auto tick = static_cast<std::uint32_t>((s >> 8) % Ticks);
+        if (i % 10 == 0) tick = tick / 300 * 300;
+        CHECK(reader.seek(tick));
+        CHECK(matches(tick));
+    }
+    CHECK(!reader.seek(Ticks));
+    CHECK(allocationCount() == before);
+
+    // A live stream has no index yet; seeking scans from the start
+    StateStreamWriter partial(300);
+    for (int t = 0; t < 1000; ++t) {
+        live.restore(expected[t]);
+        partial.tick(live);
+    }
+    CHECK(reader.open(partial.bytes().data(), partial.bytes().size()));
+    CHECK(reader.seek(777) && matches(777));
+    CHECK(reader.seek(12) && matches(12));
+
+    // Broken input is reported, not trusted
+    std::vector<std::uint8_t> broken(bytes.begin(), bytes.begin() + 200);
+    CHECK(reader.open(broken.data(), broken.size()));
+    while (reader.next()) {}
+    CHECK(reader.error() != nullptr);
+    broken = bytes;
+    broken[4] = 99;
+    CHECK(!reader.open(broken.data(), broken.size()));
+
+    // Replays export the same stream they simulate
+    Engine recorded(5);
+    ReplayWriter replayWriter(5);
+    StateStreamWriter direct;
+    for (int t = 0; t < 5000; ++t) {
+        if (t % 3 == 0) {
+            Action a = static_cast<Action>(1 + t / 3 % 5);
+            recorded.step(a);
+            replayWriter.action(a);
+        }
+        recorded.tick(replay::tickSeconds(16667));
+        replayWriter.tick(16667);
+        direct.tick(recorded);
+    }
+    replayWriter.finish(recorded);
+    direct.finish();
+    StateStreamWriter exported;
+    ReplayResult r = playReplay(replayWriter.bytes().data(), replayWriter.bytes().size(), &exported);
+    CHECK(r.matches);
+    CHECK(exported.bytes() == direct.bytes());
+
+    std::size_t fullGrid = static_cast<std::size_t>(Ticks) * sizeof(Cell) * BoardWidth * BoardHeight;
+    std::printf("%u ticks, %zu keyframes: %zu bytes (%.2f%% of %zu bytes of full grids)\n", writer.ticks(),
+                writer.keyframes(), bytes.size(), 100.0 * bytes.size() / fullGrid, fullGrid);
+    CHECK(bytes.size() * 20 < fullGrid);
+    std::printf("state stream tests passed\n");
+    return 0;
+}
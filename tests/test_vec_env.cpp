@@ -0,0 +1,191 @@
+// VecEnv observations match engines stepped one by one, games reset on game
+// over, and the thread count and the C API give identical buffers.
+#include "tetris/Policy.hpp"
+#include "tetris/VecEnv.hpp"
+#include "tetris/tetris_env.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+namespace {
+
+struct Buffers {
+    std::vector<std::uint8_t> boards, dones;
+    std::vector<std::int32_t> pieces;
+    std::vector<float> rewards;
+
+    explicit Buffers(int envs)
+        : boards(envs * VecEnv::BoardSize), dones(envs), pieces(envs * VecEnv::PieceFields), rewards(envs) {}
+    VecEnvBuffers view() { return VecEnvBuffers{boards.data(), pieces.data(), rewards.data(), dones.data()}; }
+    bool operator==(const Buffers &o) const {
+        return boards == o.boards && dones == o.dones && pieces == o.pieces && rewards == o.rewards;
+    }
+};
+
+// Actions biased towards hard drops so games end often.
+void randomActions(std::vector<std::uint8_t> &actions, unsigned &state) {
+    for (auto &a : actions) {
+        state = state * 1103515245u + 12345u;
+        unsigned r = (state >> 16) % 10;
+        a = static_cast<std::uint8_t>(r < 5 ? 1 + r : r < 8 ? 5 : r == 8 ? 0 : 200); // 200 is invalid: None
+    }
+}
+
+// The observation of one engine, written the slow way.
+void expectObservation(const Engine &engine, const Buffers &buf, int env) {
+    const std::uint8_t *cells = buf.boards.data() + env * VecEnv::BoardSize;
+    const std::uint8_t *piece = cells + BoardWidth * BoardHeight;
+    const Tetromino &active = engine.active();
+    bool showPiece = engine.running() && !engine.animating();
+    for (int y = 0; y < BoardHeight; ++y) {
+        for (int x = 0; x < BoardWidth; ++x) {
+            CHECK(cells[y * BoardWidth + x] == (engine.board().isOccupied(Point{x, y}) ? 1 : 0));
+            bool inPiece = false;
+            for (const Point &b : Tetromino::getShape(active.type, active.rotation))
+                inPiece |= active.position.x + b.x == x && active.position.y + b.y == y;
+            CHECK(piece[y * BoardWidth + x] == (showPiece && inPiece ? 1 : 0));
+        }
+    }
+    const std::int32_t *f = buf.pieces.data() + env * VecEnv::PieceFields;
+    CHECK(f[0] == static_cast<int>(active.type) && f[1] == active.rotation);
+    CHECK(f[2] == active.position.x && f[3] == active.position.y && f[4] == static_cast<int>(engine.next()));
+}
+
+} // namespace
+
+int main() {
+    const std::uint64_t seed = 4242;
+    const float frame = 1.0f / 60.0f;
+
+    // Against engines stepped by hand, with the documented piece streams
+    {
+        const int envs = 13;
+        VecEnv env(envs, seed, 1, frame);
+        Buffers buf(envs);
+        env.setBuffers(buf.view());
+        env.reset();
+        std::vector<Engine> mirror;
+        std::vector<std::uint32_t> games(envs, 2);
+        for (int i = 0; i < envs; ++i) {
+            mirror.emplace_back(PieceGenerator(seed, (1ull << 32) | static_cast<unsigned>(i)));
+            CHECK(env.games(i) == 2 && buf.dones[i] == 0 && buf.rewards[i] == 0.0f);
+            expectObservation(mirror[i], buf, i);
+        }
+        std::vector<std::uint8_t> actions(envs);
+        unsigned state = 7;
+        int ended = 0;
+        for (int t = 0; t < 20000; ++t) {
+            randomActions(actions, state);
+            int n = env.step(actions.data());
+            int dones = 0;
+            for (int i = 0; i < envs; ++i) {
+                Engine &engine = mirror[i];
+                int before = engine.score();
+                engine.step(actions[i] < static_cast<int>(Action::Count) ? static_cast<Action>(actions[i]) : Action::None);
+                engine.tick(frame);
+                CHECK(buf.rewards[i] == static_cast<float>(engine.score() - before));
+                CHECK(buf.dones[i] == (engine.running() ? 0 : 1));
+                if (!engine.running()) {
+                    engine.reset(PieceGenerator(seed, (static_cast<std::uint64_t>(games[i]++) << 32) | static_cast<unsigned>(i)));
+                    ++dones;
+                }
+                CHECK(env.games(i) == games[i]);
+                CHECK(env.engine(i).board().hash() == engine.board().hash());
+                if (t % 97 == 0) expectObservation(engine, buf, i);
+            }
+            CHECK(n == dones);
+            ended += n;
+        }
+        CHECK(ended > 20);
+        std::printf("%d envs, 20000 steps: %d games ended\n", envs, ended);
+    }
+
+    // Rewards add up to the score of a game that clears lines
+    {
+        VecEnv env(1, seed, 1, frame);
+        std::vector<float> rewards(1);
+        env.setBuffers(VecEnvBuffers{nullptr, nullptr, rewards.data(), nullptr});
+        GreedyPolicy policy;
+        ActionPath path;
+        int planned = -1, cursor = 0;
+        double total = 0.0;
+        for (int t = 0; t < 2500; ++t) {
+            const Engine &engine = env.engine(0);
+            std::uint8_t action = 0;
+            if (!engine.animating()) {
+                if (planned != engine.piecesPlaced()) {
+                    policy.plan(engine, path);
+                    planned = engine.piecesPlaced();
+                    cursor = 0;
+                }
+                if (cursor < path.count) action = static_cast<std::uint8_t>(path.actions[cursor++]);
+            }
+            CHECK(env.step(&action) == 0);
+            total += rewards[0];
+        }
+        CHECK(env.engine(0).lines() > 10 && total == env.engine(0).score());
+    }
+
+    // Any thread count gives the same buffers, with chunks of uneven size
+    {
+        const int envs = 301;
+        VecEnv single(envs, seed, 1, frame), threaded(envs, seed, 4, frame);
+        CHECK(single.threads() == 1 && threaded.threads() == 4);
+        Buffers a(envs), b(envs);
+        single.setBuffers(a.view());
+        threaded.setBuffers(b.view());
+        single.reset();
+        threaded.reset();
+        CHECK(a == b);
+        std::vector<std::uint8_t> actions(envs);
+        unsigned state = 99;
+        for (int t = 0; t < 3000; ++t) {
+            randomActions(actions, state);
+            CHECK(single.step(actions.data()) == threaded.step(actions.data()));
+            CHECK(a == b);
+        }
+        // Only the requested observations are written
+        VecEnv partial(envs, seed, 4, frame);
+        std::vector<float> rewards(envs, -1.0f);
+        partial.setBuffers(VecEnvBuffers{nullptr, nullptr, rewards.data(), nullptr});
+        partial.reset();
+        CHECK(partial.step(actions.data()) == 0 && rewards[0] == 0.0f);
+    }
+
+    // The C API is a thin wrapper: same buffers as VecEnv
+    {
+        tetris_env_shape shape;
+        tetris_env_get_shape(&shape);
+        CHECK(shape.planes == VecEnv::Planes && shape.height == BoardHeight && shape.width == BoardWidth);
+        CHECK(shape.piece_fields == VecEnv::PieceFields && shape.actions == static_cast<int>(Action::Count));
+        CHECK(tetris_env_create(0, seed, 1, frame) == nullptr);
+        CHECK(tetris_env_create(4, seed, -1, frame) == nullptr);
+        CHECK(tetris_env_create(4, seed, 1, 0.0f) == nullptr);
+        CHECK(tetris_env_step(nullptr, nullptr) == -1);
+
+        const int envs = 150;
+        tetris_env *c = tetris_env_create(envs, seed, 2, frame);
+        CHECK(c != nullptr && tetris_env_num_envs(c) == envs && tetris_env_num_threads(c) == 2);
+        VecEnv cpp(envs, seed, 1, frame);
+        Buffers a(envs), b(envs);
+        tetris_env_set_buffers(c, a.boards.data(), a.pieces.data(), a.rewards.data(), a.dones.data());
+        cpp.setBuffers(b.view());
+        tetris_env_reset(c);
+        cpp.reset();
+        std::vector<std::uint8_t> actions(envs);
+        unsigned state = 5;
+        for (int t = 0; t < 1000; ++t) {
+            randomActions(actions, state);
+            CHECK(tetris_env_step(c, actions.data()) == cpp.step(actions.data()));
+            CHECK(a == b);
+        }
+        tetris_env_destroy(c);
+    }
+    std::printf("vec env tests passed\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Versus building blocks and matches: the SPSC queue and triple buffer
+// across threads, garbage in the engine, deterministic bot matches on one
+// thread, and every player keeping the logic rate on its own thread.
+#include "tetris/Versus.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("FAILED: %s (line %d)\n", #cond, __LINE__); std::exit(1); } } while (0)
+
+namespace {
+
+struct Stamp {
+    std::uint64_t a, b, c, d;
+};
+
+struct MatchResult {
+    std::vector<int> places, sent, scores;
+    int garbageCells = 0; // summed over boards sampled during the match
+    std::uint64_t ticks = 0;
+};
+
+// Player 0 is the bot, the others never press a key and pile pieces up in
+// the middle. Stepped in player order on this thread until one is left.
+MatchResult playMatch(int players, std::uint64_t seed) {
+    Versus match(players, seed);
+    match.setBot(0, true);
+    MatchResult result;
+    while (match.alive() > 1 && result.ticks < 240 * 60 * 20) {
+        for (int p = 0; p < players; ++p) match.step(p);
+        if (++result.ticks % 24) continue;
+        for (int p = 0; p < players; ++p) {
+            const Board &board = match.state(p).engine.board;
+            for (int y = 0; y < BoardHeight; ++y)
+                for (int x = 0; x < BoardWidth; ++x)
+                    result.garbageCells += board.at(x, y).color == GarbageColor;
+        }
+    }
+    for (int p = 0; p < players; ++p) match.step(p); // the winner sees it
+    for (int p = 0; p < players; ++p) {
+        const VersusPlayerState &s = match.state(p);
+        result.places.push_back(s.place);
+        result.sent.push_back(s.sentGarbage);
+        result.scores.push_back(s.engine.score);
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    // The queue hands over every value once and in order, across a
+    // capacity much smaller than the stream
+    {
+        SpscQueue<std::uint32_t, 16> queue;
+        const std::uint32_t count = 200000;
+        std::thread producer([&] {
+            for (std::uint32_t i = 0; i < count;)
+                if (queue.push(i)) ++i;
+                else std::this_thread::yield();
+        });
+        std::uint32_t expected = 0, value;
+        while (expected < count) {
+            if (queue.pop(value)) CHECK(value == expected++);
+            else std::this_thread::yield();
+        }
+        producer.join();
+        CHECK(!queue.pop(value) && queue.size() == 0);
+        for (std::uint32_t i = 0; i < queue.capacity(); ++i) CHECK(queue.push(i));
+        CHECK(!queue.push(99) && queue.size() == queue.capacity());
+    }
+
+    // The reader never sees a torn value and never goes back in time
+    {
+        TripleBuffer<Stamp> buffer;
+        CHECK(!buffer.update());
+        const std::uint64_t count = 200000;
+        std::thread writer([&] {
+            for (std::uint64_t i = 1; i <= count; ++i) {
+                Stamp &s = buffer.back();
+                s = Stamp{i, i, i, i};
+                buffer.publish();
+            }
+        });
+        std::uint64_t last = 0;
+        int updates = 0;
+        while (last < count) {
+            if (!buffer.update()) {
+                std::this_thread::yield();
+                continue;
+            }
+            const Stamp &s = buffer.front();
+            CHECK(s.a == s.b && s.b == s.c && s.c == s.d && s.a > last);
+            last = s.a;
+            ++updates;
+        }
+        writer.join();
+        CHECK(!buffer.update() && buffer.front().a == count && updates > 0);
+    }
+
+    // Garbage lifts the falling piece above the new rows, and tops out
+    // the game once it no longer fits
+    {
+        Engine engine(PieceGenerator(7, 0));
+        Tetromino before = engine.active();
+        CHECK(engine.addGarbage(4, 3) == events::None);
+        CHECK(engine.board().columnHeight(0) == 4 && engine.board().columnHeight(3) == 0);
+        CHECK(engine.active().position == before.position);
+        CHECK(engine.addGarbage(BoardHeight - 3, 3) == events::GameOver && !engine.running());
+        CHECK(engine.addGarbage(1, 0) == events::None);
+        CHECK(Engine::garbageForLines(1) == 0 && Engine::garbageForLines(4) == 4);
+
+        Engine lifted(PieceGenerator(7, 0));
+        while (lifted.dropDistance() > 2) lifted.step(Action::SoftDrop);
+        Point pos = lifted.active().position;
+        CHECK(lifted.addGarbage(3, 0) == events::None && lifted.running());
+        CHECK(lifted.active().position.y == pos.y - 1 && lifted.dropDistance() == 0);
+    }
+
+    // Matches on one thread: garbage flows, places are handed out once
+    // each, and the same seed plays the same match
+    for (int players : {2, 3, 8}) {
+        MatchResult a = playMatch(players, 11);
+        std::vector<bool> seen(players + 1, false);
+        int sent = 0;
+        for (int p = 0; p < players; ++p) {
+            CHECK(a.places[p] >= 1 && a.places[p] <= players && !seen[a.places[p]]);
+            seen[a.places[p]] = true;
+            sent += a.sent[p];
+        }
+        CHECK(sent > 0 && a.garbageCells > 0);
+        MatchResult b = playMatch(players, 11);
+        CHECK(a.places == b.places && a.sent == b.sent && a.scores == b.scores && a.ticks == b.ticks && a.garbageCells == b.garbageCells);
+        std::printf("%d players: %.1f s, %d garbage rows sent\n", players, a.ticks / double(Versus::LogicHz), sent);
+    }
+
+    // Threads: every player keeps the logic rate, human inputs arrive
+    {
+        Versus match(Versus::MaxPlayers, 5);
+        for (int p = 1; p < match.players(); ++p) match.setBot(p, true);
+        CHECK(!match.isBot(0) && match.isBot(1));
+        auto begin = std::chrono::steady_clock::now();
+        match.start();
+        CHECK(match.started());
+        for (int i = 0; i < 20; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            CHECK(match.input(0, Action::Left));
+            for (int p = 0; p < match.players(); ++p) match.state(p);
+        }
+        match.stop();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        CHECK(!match.started());
+        for (int p = 0; p < match.players(); ++p) {
+            const VersusPlayerState &s = match.state(p);
+            // players that are out stop counting
+            if (s.place) continue;
+            CHECK(s.ticks >= seconds * Versus::LogicHz * 0.5 && s.ticks <= seconds * Versus::LogicHz + 2);
+        }
+        // the human player pressed left until the wall
+        const Tetromino &human = match.state(0).engine.active;
+        CHECK(match.state(0).place || human.position.x + Tetromino::shape(human.type, human.rotation).minX == 0);
+    }
+    std::printf("versus tests passed\n");
+    return 0;
+}